@@ -0,0 +1,41 @@
+# Script mode helper (cmake -P) that converts a compiled SPIR-V binary into a C++ header
+# containing the code as a constexpr array of 32-bit words. 
+#
+# Expected variables:
+#   SPV_FILE    - Path to the compiled SPIR-V binary
+#   OUT_HEADER  - Path of the header to generate
+#   SYMBOL      - Name of the generated array
+#
+# The header is only rewritten when its contents change, so sources including it are not
+# needlessly recompiled after a shader rebuild that produced identical SPIR-V. 
+
+if(NOT SPV_FILE OR NOT OUT_HEADER OR NOT SYMBOL)
+  message(FATAL_ERROR "EmbedSpirv.cmake requires SPV_FILE, OUT_HEADER, and SYMBOL to be defined")
+endif()
+
+file(READ "${SPV_FILE}" SPV_HEX HEX)
+string(LENGTH "${SPV_HEX}" SPV_HEX_LENGTH)
+math(EXPR SPV_WORD_REMAINDER "${SPV_HEX_LENGTH} % 8")
+if(SPV_HEX_LENGTH EQUAL 0 OR NOT SPV_WORD_REMAINDER EQUAL 0)
+  message(FATAL_ERROR "'${SPV_FILE}' is not a valid SPIR-V binary (size is not a non-zero multiple of 4 bytes)")
+endif()
+
+# SPIR-V words are stored little-endian, so reverse the byte order of each group of 4 bytes.
+string(REGEX REPLACE "([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])" "0x\\4\\3\\2\\1," SPV_WORDS "${SPV_HEX}")
+# Wrap every 8 words. CMake regular expressions do not support {n} repetition, so build the pattern by hand.
+set(SPV_LINE_PATTERN "")
+foreach(i RANGE 1 8)
+  set(SPV_LINE_PATTERN "${SPV_LINE_PATTERN}0x[0-9a-f]+,")
+endforeach()
+string(REGEX REPLACE "(${SPV_LINE_PATTERN})" "\\1\n    " SPV_WORDS "${SPV_WORDS}")
+
+get_filename_component(SPV_NAME "${SPV_FILE}" NAME)
+set(HEADER_CONTENT "// Generated by cmake/EmbedSpirv.cmake from ${SPV_NAME}. Do not edit.\n#pragma once\n#include <cstdint>\n\nnamespace embedded_shaders{\n\nconstexpr uint32_t ${SYMBOL}[] = {\n    ${SPV_WORDS}\n};\n\n} // end namespace embedded_shaders\n")
+
+if(EXISTS "${OUT_HEADER}")
+  file(READ "${OUT_HEADER}" EXISTING_CONTENT)
+  if(EXISTING_CONTENT STREQUAL HEADER_CONTENT)
+    return()
+  endif()
+endif()
+file(WRITE "${OUT_HEADER}" "${HEADER_CONTENT}")
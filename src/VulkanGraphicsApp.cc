@@ -1,20 +1,26 @@
 #include "utils/common.h"
+#include "utils/CpuProfiler.h"
 #include "vkutils/vkutils.h"
 #include "VulkanGraphicsApp.h"
 #include "data/VertexInput.h"
 #include <glm/glm.hpp>
+#include <algorithm>
 #include <iostream>
 #include <cassert>
 #include <chrono>
 #include <thread>
 
-    
+const uint32_t VulkanGraphicsApp::sBindlessSetIndex;
+
 void VulkanGraphicsApp::init(){
+    CPU_PROFILE_ZONE("VulkanGraphicsApp::init");
+    applyShaderReflection();
     initUniformBuffer();
     initRenderPipeline();
     initFramebuffers();
     initCommands();
     initSync();
+    initTimelineSync();
 }
 
 const VkExtent2D& VulkanGraphicsApp::getFramebufferSize() const{
@@ -63,6 +69,144 @@ void VulkanGraphicsApp::setFragmentShader(const std::string& aShaderName, const
     }
 }
 
+vkutils::ShaderModuleCache& VulkanGraphicsApp::getShaderCache(){
+    if(mShaderCache.getDevice() == VK_NULL_HANDLE){
+        mShaderCache.setDevice(mDeviceBundle.logicalDevice.handle());
+    }
+    return(mShaderCache);
+}
+
+vkutils::DescriptorSetCache& VulkanGraphicsApp::getDescriptorSetCache(){
+    mDescriptorSetCache.setDevice(mDeviceBundle.logicalDevice.handle());
+    return(mDescriptorSetCache);
+}
+
+VkDescriptorSet VulkanGraphicsApp::allocateFrameDescriptorSet(VkDescriptorSetLayout aLayout, const std::vector<VkDescriptorSetLayoutBinding>& aBindings){
+    vkutils::DescriptorAllocator& allocator = mFrameDescriptorAllocators[prepareFrameSlot()];
+    allocator.setDevice(mDeviceBundle.logicalDevice.handle());
+    allocator.fitLayout(aBindings);
+    return(allocator.allocate(aLayout));
+}
+
+vkutils::BindlessDescriptorTable& VulkanGraphicsApp::getBindlessTable(){
+    if(!isBindlessEnabled()){
+        throw std::runtime_error("VulkanGraphicsApp::getBindlessTable() Error: Bindless descriptors are not enabled on this device!");
+    }
+    if(!mBindlessTable.isValid()){
+        const static uint32_t sMaxBuffers = 1024U;
+        const static uint32_t sMaxImages = 4096U;
+        VkPhysicalDeviceDescriptorIndexingPropertiesEXT limits = mDeviceBundle.physicalDevice.queryDescriptorIndexingProperties();
+        uint32_t bufferLimit = std::min(limits.maxDescriptorSetUpdateAfterBindStorageBuffers, limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers);
+        // Images are bound as combined image samplers, which count against both the sampled image and sampler limits
+        uint32_t imageLimit = std::min(limits.maxDescriptorSetUpdateAfterBindSampledImages, limits.maxPerStageDescriptorUpdateAfterBindSampledImages);
+        imageLimit = std::min(imageLimit, std::min(limits.maxDescriptorSetUpdateAfterBindSamplers, limits.maxPerStageDescriptorUpdateAfterBindSamplers));
+        mBindlessTable.create(mDeviceBundle.logicalDevice.handle(), std::min(sMaxBuffers, bufferLimit), std::min(sMaxImages, imageLimit));
+
+        if(mRenderPipeline.isValid())
+            resetRenderSetup();
+    }
+    return(mBindlessTable);
+}
+
+vkutils::AsyncComputeScheduler& VulkanGraphicsApp::getAsyncCompute(){
+    if(!mAsyncCompute.isValid()){
+        QueueAllocator& queues = mDeviceBundle.logicalDevice.getQueueAllocator();
+        if(!queues.getFamilyIndex(QUEUE_ROLE_COMPUTE)){
+            throw std::runtime_error("VulkanGraphicsApp::getAsyncCompute() Error: The device was created without a compute queue!");
+        }
+        mAsyncCompute.create(
+            mDeviceBundle.logicalDevice.handle(), *queues.getFamilyIndex(QUEUE_ROLE_COMPUTE),
+            queues.acquire(QUEUE_ROLE_COMPUTE), mFramePacing.framesInFlight
+        );
+    }
+    return(mAsyncCompute);
+}
+
+bool VulkanGraphicsApp::isRedrawNeeded() const{
+    if(!mRenderOnDemand || mRedrawRequested || !mAnimations.empty()) return(true);
+
+    auto findFlags = sWindowFlags.find(mWindow);
+    if(findFlags != sWindowFlags.end() && (findFlags->second.eventReceived || findFlags->second.resized)) return(true);
+
+    if(mUniformBuffer.getBoundDataCount() > 0 && mUniformBuffer.getDeviceSyncState() != DEVICE_IN_SYNC) return(true);
+    for(const std::shared_ptr<const DeviceSyncedBuffer>& buffer : mWatchedBuffers){
+        if(buffer->getDeviceSyncState() != DEVICE_IN_SYNC) return(true);
+    }
+    return(false);
+}
+
+void VulkanGraphicsApp::watchBuffer(std::shared_ptr<const DeviceSyncedBuffer> aBuffer){
+    if(aBuffer == nullptr) return;
+    unwatchBuffer(aBuffer.get());
+    mWatchedBuffers.push_back(aBuffer);
+}
+
+void VulkanGraphicsApp::unwatchBuffer(const DeviceSyncedBuffer* aBuffer){
+    auto matchBuffer = [aBuffer](const std::shared_ptr<const DeviceSyncedBuffer>& aWatched) -> bool {return(aWatched.get() == aBuffer);};
+    mWatchedBuffers.erase(std::remove_if(mWatchedBuffers.begin(), mWatchedBuffers.end(), matchBuffer), mWatchedBuffers.end());
+}
+
+void VulkanGraphicsApp::waitForEvents(double aTimeoutSeconds){
+    if(isHeadless()) return; // No window, so no events
+    double throttleDelay = getThrottleDelay();
+    if(throttleDelay > 0.0){
+        glfwWaitEventsTimeout(std::min(throttleDelay, aTimeoutSeconds));
+    }else if(throttleDelay < 0.0 || (mRenderOnDemand && !isRedrawNeeded())){
+        glfwWaitEventsTimeout(aTimeoutSeconds);
+    }else{
+        glfwPollEvents();
+    }
+}
+
+bool VulkanGraphicsApp::skipThrottledFrame(){
+    double throttleDelay = getThrottleDelay();
+    if(throttleDelay == 0.0) return(false);
+    // Run loops and render() may both ask, and loops poll many times while a frame is held back
+    if(!mHeldFrameCounted){
+        if(throttleDelay < 0.0){
+            ++mSkippedFrames.iconified;
+        }else{
+            ++mSkippedFrames.unfocused;
+        }
+        mHeldFrameCounted = true;
+    }
+    return(true);
+}
+
+double VulkanGraphicsApp::getThrottleDelay() const{
+    if(isHeadless()) return(0.0);
+    auto findFlags = sWindowFlags.find(mWindow);
+    if(findFlags == sWindowFlags.end()) return(0.0);
+    const WindowFlags& flags = findFlags->second;
+
+    if(mThrottlePolicy.pauseWhenIconified){
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(mWindow, &width, &height);
+        if(flags.iconified || width == 0 || height == 0) return(-1.0);
+    }
+    if(!flags.focus && mThrottlePolicy.unfocusedFps > 0.0){
+        const double sTolerance = 1e-3; // Don't skip a frame over sub-millisecond wake up jitter
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - mLastFrameStart).count();
+        double remaining = 1.0 / mThrottlePolicy.unfocusedFps - elapsed;
+        return(remaining > sTolerance ? remaining : 0.0);
+    }
+    return(0.0);
+}
+
+void VulkanGraphicsApp::setPushConstants(const void* aData, uint32_t aSize){
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(aData);
+    if(mPushConstantData.size() == aSize && std::equal(bytes, bytes + aSize, mPushConstantData.begin())) return;
+    mPushConstantData.assign(bytes, bytes + aSize);
+    mStaleCommandBuffers.assign(mCommandBuffers.size(), true);
+    requestRedraw();
+}
+
+void VulkanGraphicsApp::setSceneRecordCallback(RecordFunction aRecord){
+    mSceneRecord = aRecord;
+    mStaleCommandBuffers.assign(mCommandBuffers.size(), true);
+    requestRedraw();
+}
+
 void VulkanGraphicsApp::addUniform(uint32_t aBindingPoint, UniformDataInterfacePtr aUniformData, VkShaderStageFlags aStages){
     if(aUniformData == nullptr){
         std::cerr << "Ignoring attempt to add nullptr as uniform data!" << std::endl;
@@ -75,76 +219,318 @@ void VulkanGraphicsApp::addUniform(uint32_t aBindingPoint, UniformDataInterfaceP
         resetRenderSetup();
 }
 
+void VulkanGraphicsApp::setSpecializationConstants(VkShaderStageFlagBits aStage, const vkutils::SpecializationConstants& aConstants){
+    vkutils::SpecializationConstants* target = nullptr;
+    if(aStage == VK_SHADER_STAGE_VERTEX_BIT){
+        target = &mVertexSpecialization;
+    }else if(aStage == VK_SHADER_STAGE_FRAGMENT_BIT){
+        target = &mFragmentSpecialization;
+    }else{
+        throw std::runtime_error("VulkanGraphicsApp::setSpecializationConstants() Error: Only vertex and fragment stages are supported!");
+    }
+
+    if(*target == aConstants) return;
+    *target = aConstants;
+
+    if(mRenderPipeline.isValid())
+        resetRenderSetup();
+}
+
+size_t VulkanGraphicsApp::getPipelineVariantKey() const{
+    size_t seed = std::hash<std::string>()(mVertexKey);
+    auto combine = [&seed](size_t aValue){ seed ^= aValue + 0x9e3779b9 + (seed << 6) + (seed >> 2); };
+    combine(std::hash<std::string>()(mFragmentKey));
+    combine(mVertexSpecialization.hash());
+    combine(mFragmentSpecialization.hash());
+    return(seed);
+}
+
 void VulkanGraphicsApp::resetRenderSetup(){
+    CPU_PROFILE_ZONE("VulkanGraphicsApp::resetRenderSetup");
     vkDeviceWaitIdle(mDeviceBundle.logicalDevice.handle());
+    markFramesCompleted(mSubmittedFrameValue);
 
     cleanupSwapchainDependents();
-    VulkanSetupBaseApp::cleanupSwapchain();
+    VulkanSetupBaseApp::recreateSwapchain();
 
-    VulkanSetupBaseApp::initSwapchain();
+    applyShaderReflection();
     initUniformBuffer();
     initRenderPipeline();
     initFramebuffers();
     initCommands();
     initSync();
 
+    // Readback buffers are sized for the old images, so rebuild them if the images changed
+    if(mFrameReadback.isValid()){
+        const VkExtent2D& extent = mFrameReadback.getExtent();
+        if(extent.width != mSwapchainBundle.extent.width || extent.height != mSwapchainBundle.extent.height
+            || mFrameReadback.getFormat() != mSwapchainBundle.surface_format.format){
+            initFrameReadback(mFrameReadback.getSlotCount());
+        }
+    }
+
+    // Compute passes are kept by destroy(), so only the frame slots need recreating
+    if(mAsyncCompute.isValid() && mAsyncCompute.getFrameSlotCount() != mFramePacing.framesInFlight){
+        mAsyncCompute.create(mDeviceBundle.logicalDevice.handle(), mAsyncCompute.getQueueFamily(), mAsyncCompute.getQueue(), mFramePacing.framesInFlight);
+    }
+
     sWindowFlags[mWindow].resized = false;
+    mOffscreenImageIndex = 0;
+    requestRedraw();
 }
 
-void VulkanGraphicsApp::render(){
-    uint32_t targetImageIndex = 0;
-    size_t syncObjectIndex = mFrameNumber % IN_FLIGHT_FRAME_LIMIT;
+void VulkanGraphicsApp::applyShaderReflection(){
+    const vkutils::ShaderReflection* vertReflection = nullptr;
+    std::vector<const vkutils::ShaderReflection*> stages;
+    for(const std::string& key : {mVertexKey, mFragmentKey}){
+        auto findModule = mShaderModules.find(key);
+        if(findModule == mShaderModules.end()) continue;
+        const vkutils::ShaderReflection* reflection = mShaderCache.getReflection(findModule->second);
+        if(reflection == nullptr) continue;
+        stages.push_back(reflection);
+        if(reflection->stage == VK_SHADER_STAGE_VERTEX_BIT) vertReflection = reflection;
+    }
 
-    vkWaitForFences(mDeviceBundle.logicalDevice.handle(), 1, &mInFlightFences[syncObjectIndex], VK_TRUE, std::numeric_limits<uint64_t>::max());
+    mPushConstantRanges = vkutils::merge_push_constant_ranges(stages);
+    mPushConstantIntervals = vkutils::split_push_constant_ranges(mPushConstantRanges);
+    if(stages.empty()) return; // Shaders weren't loaded through the cache, so there is nothing to go on
 
-    VkResult result = vkAcquireNextImageKHR(mDeviceBundle.logicalDevice.handle(),
-        mSwapchainBundle.swapchain, std::numeric_limits<uint64_t>::max(),
-        mImageAvailableSemaphores[syncObjectIndex], VK_NULL_HANDLE, &targetImageIndex
-    );
-    if(result == VK_ERROR_OUT_OF_DATE_KHR || sWindowFlags[mWindow].resized){
-        resetRenderSetup();
-        render();
+    // Only expose each uniform to the stages that use it, and verify its size against the shader block
+    for(uint32_t bindPoint : mUniformBuffer.getBoundPoints()){
+        VkShaderStageFlags usedStages = vkutils::descriptor_stage_flags(stages, 0, bindPoint);
+        if(usedStages == 0){
+            std::cerr << "Warning: Uniform bound at binding " << bindPoint << " is not used by any shader stage" << std::endl;
+            continue;
+        }
+        mUniformBuffer.setBindingStageFlags(bindPoint, usedStages);
+
+        size_t dataSize = mUniformBuffer.getBoundDataSize(bindPoint);
+        for(const vkutils::ShaderReflection* stage : stages){
+            const vkutils::ReflectedDescriptor* descriptor = stage->findDescriptor(0, bindPoint);
+            if(descriptor == nullptr) continue;
+            if(descriptor->type != VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER){
+                throw std::runtime_error("Error: Shader expects binding " + std::to_string(bindPoint) + " to be something other than a uniform buffer!");
+            }else if(dataSize < descriptor->blockSize){
+                throw std::runtime_error(
+                    "Error: Uniform data bound at binding " + std::to_string(bindPoint) + " is " + std::to_string(dataSize) + 
+                    " bytes, but shader block '" + descriptor->name + "' is " + std::to_string(descriptor->blockSize) + " bytes!"
+                );
+            }else if(dataSize > descriptor->blockSize){
+                std::cerr << "Warning: Uniform data bound at binding " << bindPoint << " is " << dataSize << " bytes, but shader block '"
+                          << descriptor->name << "' is only " << descriptor->blockSize << " bytes" << std::endl;
+            }
+        }
+    }
+
+    if(vertReflection == nullptr) return;
+    if(!mVertexInputsHaveBeenSet){
+        mVertexInputsHaveBeenSet = vkutils::derive_vertex_input(*vertReflection, 0, mBindingDescription, mAttributeDescriptions);
         return;
-    }else if(result == VK_SUBOPTIMAL_KHR){
-        std::cerr << "Warning! Swapchain suboptimal" << std::endl;
-    }else if(result != VK_SUCCESS){
-        throw std::runtime_error("Failed to get next image in swapchain!");
+    }
+    for(const vkutils::ReflectedVertexInput& input : vertReflection->vertexInputs){
+        auto matchLocation = [&input](const VkVertexInputAttributeDescription& attrib) -> bool {return(attrib.location == input.location);};
+        auto findAttrib = std::find_if(mAttributeDescriptions.begin(), mAttributeDescriptions.end(), matchLocation);
+        if(findAttrib == mAttributeDescriptions.end()){
+            std::cerr << "Warning: Vertex shader input '" << input.name << "' at location " << input.location << " has no matching vertex attribute" << std::endl;
+        }else if(findAttrib->format != input.format){
+            std::cerr << "Warning: Vertex attribute at location " << input.location << " has a different format than shader input '" << input.name << "'" << std::endl;
+        }
+    }
+}
+
+void VulkanGraphicsApp::rerecordCommands(){
+    vkDeviceWaitIdle(mDeviceBundle.logicalDevice.handle());
+    vkFreeCommandBuffers(mDeviceBundle.logicalDevice.handle(), mCommandPool, mCommandBuffers.size(), mCommandBuffers.data());
+    initCommands();
+    requestRedraw();
+}
+
+size_t VulkanGraphicsApp::prepareFrameSlot(){
+    // Slots follow the frame value rather than a count of render() calls, so a call that submits nothing can't
+    // make the slot drift away from the frame the waits below are for
+    const uint64_t frameValue = mSubmittedFrameValue + 1;
+    const uint32_t framesInFlight = mFramePacing.framesInFlight;
+    const size_t slot = frameValue % framesInFlight;
+    if(mFrameSlotValues[slot] == frameValue) return(slot);
+
+    // Frame resources of this sync slot are free once the frame that last used them has finished
+    {
+        CPU_PROFILE_ZONE("wait_for_frame_slot");
+        if(isTimelineSyncEnabled()){
+            if(frameValue > framesInFlight){
+                waitForFrameValue(frameValue - framesInFlight);
+            }
+        }else{
+            waitForFrameValue(mInFlightFenceValues[slot]);
+        }
+    }
+    // Work that used this slot's transient descriptor sets has finished, so its pools can be recycled
+    mFrameDescriptorAllocators[slot].reset();
+    mFrameSlotValues[slot] = frameValue;
+    return(slot);
+}
+
+bool VulkanGraphicsApp::render(){
+    if(skipThrottledFrame()) return(false);
+    CPU_PROFILE_ZONE("VulkanGraphicsApp::render");
+    mLastFrameStart = std::chrono::steady_clock::now();
+    mHeldFrameCounted = false;
+
+    // Iconifying may report a resize to zero and back. Only rebuild if the size really changed.
+    if(sWindowFlags[mWindow].resized){
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(mWindow, &width, &height);
+        if(static_cast<uint32_t>(width) == mSwapchainBundle.extent.width && static_cast<uint32_t>(height) == mSwapchainBundle.extent.height){
+            sWindowFlags[mWindow].resized = false;
+        }
+    }
+
+    uint32_t targetImageIndex = 0;
+    const uint64_t frameValue = mSubmittedFrameValue + 1;
+    mFrameLatency.frameStarted(frameValue);
+    const size_t syncObjectIndex = prepareFrameSlot();
+    mDeferredFrameWork.collect(getCompletedFrameValue());
+
+    if(isHeadless()){
+        // Offscreen images are used round robin. The wait above guarantees the next one is no longer in use. 
+        targetImageIndex = mOffscreenImageIndex;
+        mOffscreenImageIndex = (mOffscreenImageIndex + 1) % mSwapchainBundle.image_count;
+    }else{
+        CPU_PROFILE_ZONE("acquire_image");
+        VkResult result = vkAcquireNextImageKHR(mDeviceBundle.logicalDevice.handle(),
+            mSwapchainBundle.swapchain, std::numeric_limits<uint64_t>::max(),
+            mImageAvailableSemaphores[syncObjectIndex], VK_NULL_HANDLE, &targetImageIndex
+        );
+        if(result == VK_ERROR_OUT_OF_DATE_KHR || sWindowFlags[mWindow].resized){
+            resetRenderSetup();
+            mFrameLatency.discardPending(); // The retry measures the frame again
+            return(render());
+        }else if(result == VK_SUBOPTIMAL_KHR){
+            std::cerr << "Warning! Swapchain suboptimal" << std::endl;
+        }else if(result != VK_SUCCESS){
+            throw std::runtime_error("Failed to get next image in swapchain!");
+        }
+    }
+
+    if(mStaleCommandBuffers[targetImageIndex]){
+        // Push constants changed since this image's buffer was recorded. Only this buffer is re-recorded, once
+        // the frame that last submitted it has finished, which it normally has by the time its image comes around.
+        CPU_PROFILE_ZONE("rerecord_command_buffer");
+        waitForFrameValue(mCommandBufferFrameValues[targetImageIndex]);
+        vkResetCommandBuffer(mCommandBuffers[targetImageIndex], 0);
+        recordCommandBuffer(targetImageIndex);
+        mStaleCommandBuffers[targetImageIndex] = false;
+    }
+
+    // Compute for this frame runs while the previous frame may still be rasterizing
+    VkSemaphore waitSemaphores[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    VkPipelineStageFlags waitStages[2] = {0, 0};
+    uint32_t waitCount = 0;
+    if(!isHeadless()){
+        waitSemaphores[waitCount] = mImageAvailableSemaphores[syncObjectIndex];
+        waitStages[waitCount] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        ++waitCount;
+    }
+    if(mAsyncCompute.isValid()){
+        waitSemaphores[waitCount] = mAsyncCompute.submit(syncObjectIndex);
+        waitStages[waitCount] = mAsyncCompute.getWaitStages();
+        if(waitSemaphores[waitCount] != VK_NULL_HANDLE) ++waitCount;
+    }
+
+    // Headless frames aren't presented, so nothing would wait on the render finished semaphore
+    VkSemaphore signalSemaphores[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    // Values are ignored for the binary semaphores
+    const uint64_t waitValues[2] = {0, 0};
+    uint64_t signalValues[2] = {0, 0};
+    uint32_t signalCount = 0;
+    if(!isHeadless()){
+        signalSemaphores[signalCount++] = mRenderFinishSemaphores[syncObjectIndex];
+    }
+    if(isTimelineSyncEnabled()){
+        signalValues[signalCount] = frameValue;
+        signalSemaphores[signalCount++] = mFrameTimeline.handle();
+    }
+    VkTimelineSemaphoreSubmitInfo timelineInfo;{
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.pNext = nullptr;
+        timelineInfo.waitSemaphoreValueCount = waitCount;
+        timelineInfo.pWaitSemaphoreValues = waitValues;
+        timelineInfo.signalSemaphoreValueCount = signalCount;
+        timelineInfo.pSignalSemaphoreValues = signalValues;
+    }
+
+    // The readback copy runs after the frame's own commands, in the same submission
+    VkCommandBuffer commandBuffers[2] = {mCommandBuffers[targetImageIndex], VK_NULL_HANDLE};
+    uint32_t commandBufferCount = 1;
+    if(mFrameReadback.isValid()){
+        commandBuffers[1] = mFrameReadback.recordCopy(mSwapchainBundle.images[targetImageIndex], mSwapchainBundle.final_layout, frameValue);
+        if(commandBuffers[1] != VK_NULL_HANDLE) ++commandBufferCount;
     }
 
-    const static VkPipelineStageFlags waitStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     VkSubmitInfo submitInfo = {
-        VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr,
-        1, &mImageAvailableSemaphores[syncObjectIndex], &waitStages,
-        1, &mCommandBuffers[targetImageIndex],
-        1, &mRenderFinishSemaphores[syncObjectIndex]
+        VK_STRUCTURE_TYPE_SUBMIT_INFO, isTimelineSyncEnabled() ? &timelineInfo : nullptr,
+        waitCount, waitSemaphores, waitStages,
+        commandBufferCount, commandBuffers,
+        signalCount, signalSemaphores
     };
 
-    vkResetFences(mDeviceBundle.logicalDevice.handle(), 1, &mInFlightFences[syncObjectIndex]);
-
+    VkFence submitFence = VK_NULL_HANDLE;
+    if(!isTimelineSyncEnabled()){
+        submitFence = mInFlightFences[syncObjectIndex];
+        vkResetFences(mDeviceBundle.logicalDevice.handle(), 1, &submitFence);
+        mInFlightFenceValues[syncObjectIndex] = frameValue;
+    }
     
     mUniformBuffer.updateDevice();
 
-    if(vkQueueSubmit(mDeviceBundle.logicalDevice.getGraphicsQueue(), 1, &submitInfo, mInFlightFences[syncObjectIndex]) != VK_SUCCESS){
-        throw std::runtime_error("Submit to graphics queue failed!");
+    using clock = std::chrono::steady_clock;
+    using milliseconds = std::chrono::duration<double, std::milli>;
+    clock::time_point submitStart = clock::now();
+    {
+        CPU_PROFILE_ZONE("queue_submit");
+        if(vkQueueSubmit(mDeviceBundle.logicalDevice.getGraphicsQueue(), 1, &submitInfo, submitFence) != VK_SUCCESS){
+            // The frame value is handed out again, so the readback slot must not wait for it
+            if(commandBufferCount > 1) mFrameReadback.cancelCopy(commandBuffers[1]);
+            throw std::runtime_error("Submit to graphics queue failed!");
+        }
     }
+    mLastCallTimings.submit = milliseconds(clock::now() - submitStart).count();
+    mLastCallTimings.present = 0.0;
+    mSubmittedFrameValue = frameValue;
+    mCommandBufferFrameValues[targetImageIndex] = frameValue;
+    if(mAsyncCompute.isValid()) mAsyncCompute.consumed(syncObjectIndex);
+    if(mGpuProfiler.isValid()) mGpuProfiler.slotSubmitted(targetImageIndex, frameValue);
+    if(mPipelineStatistics.isValid()) mPipelineStatistics.slotSubmitted(targetImageIndex, frameValue);
 
-    VkPresentInfoKHR presentInfo = {
-        /*sType = */ VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-        /*pNext = */ nullptr,
-        /*waitSemaphoreCount = */ 1,
-        /*pWaitSemaphores = */ &mRenderFinishSemaphores[syncObjectIndex],
-        /*swapchainCount = */ 1,
-        /*pSwapchains = */ &mSwapchainBundle.swapchain,
-        /*pImageIndices = */ &targetImageIndex,
-        /*pResults = */ nullptr
-    };
+    if(!isHeadless()){
+        VkPresentInfoKHR presentInfo = {
+            /*sType = */ VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+            /*pNext = */ nullptr,
+            /*waitSemaphoreCount = */ 1,
+            /*pWaitSemaphores = */ &mRenderFinishSemaphores[syncObjectIndex],
+            /*swapchainCount = */ 1,
+            /*pSwapchains = */ &mSwapchainBundle.swapchain,
+            /*pImageIndices = */ &targetImageIndex,
+            /*pResults = */ nullptr
+        };
+
+        CPU_PROFILE_ZONE("queue_present");
+        clock::time_point presentStart = clock::now();
+        vkQueuePresentKHR(mDeviceBundle.logicalDevice.getPresentationQueue(), &presentInfo);
+        mLastCallTimings.present = milliseconds(clock::now() - presentStart).count();
+    }
 
-    vkQueuePresentKHR(mDeviceBundle.logicalDevice.getPresentationQueue(), &presentInfo);
+    // Poll so latency samples are taken close to when frames actually finish
+    getCompletedFrameValue();
+
+    mRedrawRequested = false;
+    sWindowFlags[mWindow].eventReceived = false;
+    return(true);
 }
 
 void VulkanGraphicsApp::initRenderPipeline(){
     if(!mVertexInputsHaveBeenSet){
-        throw std::runtime_error("Error! Render pipeline cannot be created before vertex input information has been set via 'setVertexInput()'");
+        throw std::runtime_error("Error! Render pipeline cannot be created before vertex input information has been set via 'setVertexInput()' or reflected from the vertex shader");
     }else if(mVertexKey.empty()){
         throw std::runtime_error("Error! No vertex shader has been set! A vertex shader must be set using setVertexShader()!");
     }else if(mFragmentKey.empty()){
@@ -169,12 +555,16 @@ void VulkanGraphicsApp::initRenderPipeline(){
         if(findFrag != mShaderModules.end()){
             fragShader = findFrag->second;
         }else{
-            fragShader = vkutils::load_shader_module(mDeviceBundle.logicalDevice.handle(), STRIFY(SHADER_DIR) "/fallback.frag.spv");
+            fragShader = getShaderCache().acquireEmbedded("fallback.frag");
             mShaderModules["fallback.frag"] = fragShader;
         }
     }else{
         fragShader = findFrag->second;
     }
+
+    // The pipeline construction set holds pointers to these, so they must live as long as the app does. 
+    mVertexSpecializationInfo = mVertexSpecialization.getInfo();
+    mFragmentSpecializationInfo = mFragmentSpecialization.getInfo();
     
     VkPipelineShaderStageCreateInfo vertStageInfo;{
         vertStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -183,7 +573,7 @@ void VulkanGraphicsApp::initRenderPipeline(){
         vertStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
         vertStageInfo.module = vertShader;
         vertStageInfo.pName = "main";
-        vertStageInfo.pSpecializationInfo = nullptr;
+        vertStageInfo.pSpecializationInfo = mVertexSpecialization.empty() ? nullptr : &mVertexSpecializationInfo;
     }
     VkPipelineShaderStageCreateInfo fragStageInfo;{
         fragStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -192,7 +582,7 @@ void VulkanGraphicsApp::initRenderPipeline(){
         fragStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
         fragStageInfo.module = fragShader;
         fragStageInfo.pName = "main";
-        fragStageInfo.pSpecializationInfo = nullptr;
+        fragStageInfo.pSpecializationInfo = mFragmentSpecialization.empty() ? nullptr : &mFragmentSpecializationInfo;
     }
     ctorSet.mProgrammableStages.emplace_back(vertStageInfo);
     ctorSet.mProgrammableStages.emplace_back(fragStageInfo);
@@ -205,10 +595,25 @@ void VulkanGraphicsApp::initRenderPipeline(){
     ctorSet.mPipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     ctorSet.mPipelineLayoutInfo.pNext = 0;
     ctorSet.mPipelineLayoutInfo.flags = 0;
-    ctorSet.mPipelineLayoutInfo.setLayoutCount = mUniformDescriptorSetLayouts.size();
-    ctorSet.mPipelineLayoutInfo.pSetLayouts = mUniformDescriptorSetLayouts.data();
-    ctorSet.mPipelineLayoutInfo.pushConstantRangeCount = 0;
-    ctorSet.mPipelineLayoutInfo.pPushConstantRanges = nullptr;
+    mPipelineSetLayouts = mUniformDescriptorSetLayouts;
+    if(mBindlessTable.isValid()){
+        if(mPipelineSetLayouts.empty()){
+            if(mEmptySetLayout == VK_NULL_HANDLE){
+                VkDescriptorSetLayoutCreateInfo emptyInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, nullptr, 0, 0, nullptr};
+                if(vkCreateDescriptorSetLayout(mDeviceBundle.logicalDevice.handle(), &emptyInfo, nullptr, &mEmptySetLayout) != VK_SUCCESS){
+                    throw std::runtime_error("Failed to create empty descriptor set layout!");
+                }
+            }
+            mPipelineSetLayouts.emplace_back(mEmptySetLayout);
+        }
+        mPipelineSetLayouts.resize(sBindlessSetIndex + 1, mEmptySetLayout);
+        mPipelineSetLayouts[sBindlessSetIndex] = mBindlessTable.getLayout();
+    }
+
+    ctorSet.mPipelineLayoutInfo.setLayoutCount = mPipelineSetLayouts.size();
+    ctorSet.mPipelineLayoutInfo.pSetLayouts = mPipelineSetLayouts.data();
+    ctorSet.mPipelineLayoutInfo.pushConstantRangeCount = mPushConstantRanges.size();
+    ctorSet.mPipelineLayoutInfo.pPushConstantRanges = mPushConstantRanges.empty() ? nullptr : mPushConstantRanges.data();
 
     vkutils::BasicVulkanRenderPipeline::prepareViewport(ctorSet);
     vkutils::BasicVulkanRenderPipeline::prepareRenderPass(ctorSet);
@@ -216,11 +621,12 @@ void VulkanGraphicsApp::initRenderPipeline(){
 }
 
 void VulkanGraphicsApp::initCommands(){
+    CPU_PROFILE_ZONE("VulkanGraphicsApp::initCommands");
     VkCommandPoolCreateInfo poolInfo;{
         poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
         poolInfo.pNext = nullptr;
-        poolInfo.flags = 0;
-        poolInfo.queueFamilyIndex = *mDeviceBundle.physicalDevice.mGraphicsIdx;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT; // Buffers are re-recorded one at a time
+        poolInfo.queueFamilyIndex = *mDeviceBundle.logicalDevice.getQueueAllocator().getFamilyIndex(QUEUE_ROLE_GRAPHICS);
     }
 
     if(mCommandPool == VK_NULL_HANDLE){
@@ -230,6 +636,12 @@ void VulkanGraphicsApp::initCommands(){
     }
 
     mCommandBuffers.resize(mSwapchainFramebuffers.size());
+    if(mGpuProfiler.isValid() && mGpuProfiler.getSlotCount() != mCommandBuffers.size()){
+        mGpuProfiler.create(mDeviceBundle, *mDeviceBundle.logicalDevice.getQueueAllocator().getFamilyIndex(QUEUE_ROLE_GRAPHICS), mCommandBuffers.size());
+    }
+    if(mPipelineStatistics.isValid() && mPipelineStatistics.getSlotCount() != mCommandBuffers.size()){
+        mPipelineStatistics.create(mDeviceBundle, mCommandBuffers.size());
+    }
     VkCommandBufferAllocateInfo allocInfo;{
         allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
         allocInfo.pNext = nullptr;
@@ -240,43 +652,79 @@ void VulkanGraphicsApp::initCommands(){
     if(vkAllocateCommandBuffers(mDeviceBundle.logicalDevice.handle(), &allocInfo, mCommandBuffers.data()) != VK_SUCCESS){
         throw std::runtime_error("Failed to allocate command buffers!");
     }
+    // Only called with the device idle, so none of the buffers are in use
+    mCommandBufferFrameValues.assign(mCommandBuffers.size(), 0);
+    mStaleCommandBuffers.assign(mCommandBuffers.size(), false);
 
-    for(size_t i = 0; i < mCommandBuffers.size(); ++i){
-        VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, nullptr, 0 , nullptr};
-        if(vkBeginCommandBuffer(mCommandBuffers[i], &beginInfo) != VK_SUCCESS){
-            throw std::runtime_error("Failed to begine command recording!");
-        }
+    for(uint32_t i = 0; i < mCommandBuffers.size(); ++i){
+        recordCommandBuffer(i);
+    }
+}
 
-        static const VkClearValue clearColor = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
-        VkRenderPassBeginInfo renderBegin;{
-            renderBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-            renderBegin.pNext = nullptr;
-            renderBegin.renderPass = mRenderPipeline.getRenderpass();
-            renderBegin.framebuffer = mSwapchainFramebuffers[i];
-            renderBegin.renderArea = {{0,0}, mSwapchainBundle.extent};
-            renderBegin.clearValueCount = 1;
-            renderBegin.pClearValues = &clearColor;
-        }
+void VulkanGraphicsApp::recordCommandBuffer(uint32_t aIndex){
+    VkCommandBuffer commandBuffer = mCommandBuffers[aIndex];
+    const bool profiled = mGpuProfiler.isValid();
+    const uint32_t frameScope = profiled ? mGpuProfiler.getScope("frame") : 0;
+    const uint32_t renderPassScope = profiled ? mGpuProfiler.getScope("render_pass") : 0;
+    const bool counted = mPipelineStatistics.isValid();
+    const uint32_t sceneBatch = counted ? mPipelineStatistics.getBatch("scene") : 0;
+    VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, nullptr, 0 , nullptr};
+    if(vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS){
+        throw std::runtime_error("Failed to begine command recording!");
+    }
+    if(profiled){
+        mGpuProfiler.cmdResetSlot(commandBuffer, aIndex);
+        mGpuProfiler.cmdBeginScope(commandBuffer, aIndex, frameScope);
+    }
+    if(counted) mPipelineStatistics.cmdResetSlot(commandBuffer, aIndex);
 
-        vkCmdBeginRenderPass(mCommandBuffers[i], &renderBegin, VK_SUBPASS_CONTENTS_INLINE);
-        vkCmdBindPipeline(mCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, mRenderPipeline.getPipeline());
-        vkCmdBindVertexBuffers(mCommandBuffers[i], 0, 1, &mVertexBuffer, std::array<VkDeviceSize, 1>{0}.data());
-
-        // Bind uniforms to graphics pipeline if they exist
-        if(mUniformBuffer.getBoundDataCount() > 0){
-            const VkDescriptorSet* descriptorSets = mUniformDescriptorSets.data() + i;
-            vkCmdBindDescriptorSets(
-                mCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, mRenderPipeline.getLayout(),
-                0, 1, descriptorSets, 0, nullptr
-            );
-        }
+    static const VkClearValue clearColor = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
+    VkRenderPassBeginInfo renderBegin;{
+        renderBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderBegin.pNext = nullptr;
+        renderBegin.renderPass = mRenderPipeline.getRenderpass();
+        renderBegin.framebuffer = mSwapchainFramebuffers[aIndex];
+        renderBegin.renderArea = {{0,0}, mSwapchainBundle.extent};
+        renderBegin.clearValueCount = 1;
+        renderBegin.pClearValues = &clearColor;
+    }
 
-        vkCmdDraw(mCommandBuffers[i], mVertexCount, 1, 0, 0);
-        vkCmdEndRenderPass(mCommandBuffers[i]);
+    if(profiled) mGpuProfiler.cmdBeginScope(commandBuffer, aIndex, renderPassScope);
+    vkCmdBeginRenderPass(commandBuffer, &renderBegin, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mRenderPipeline.getPipeline());
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &mVertexBuffer, std::array<VkDeviceSize, 1>{0}.data());
 
-        if(vkEndCommandBuffer(mCommandBuffers[i]) != VK_SUCCESS){
-            throw std::runtime_error("Failed to end command buffer " + std::to_string(i));
-        }
+    // Bind uniforms to graphics pipeline if they exist
+    if(mUniformBuffer.getBoundDataCount() > 0){
+        vkCmdBindDescriptorSets(
+            commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mRenderPipeline.getLayout(),
+            0, 1, &mUniformDescriptorSet, 0, nullptr
+        );
+    }
+    if(mBindlessTable.isValid()){
+        VkDescriptorSet bindlessSet = mBindlessTable.getSet();
+        vkCmdBindDescriptorSets(
+            commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mRenderPipeline.getLayout(),
+            sBindlessSetIndex, 1, &bindlessSet, 0, nullptr
+        );
+    }
+    for(const VkPushConstantRange& range : mPushConstantIntervals){
+        if(range.offset + range.size > mPushConstantData.size()) continue;
+        vkCmdPushConstants(commandBuffer, mRenderPipeline.getLayout(), range.stageFlags, range.offset, range.size, mPushConstantData.data() + range.offset);
+    }
+
+    if(counted) mPipelineStatistics.cmdBeginBatch(commandBuffer, aIndex, sceneBatch);
+    vkCmdDraw(commandBuffer, mVertexCount, 1, 0, 0);
+    if(counted) mPipelineStatistics.cmdEndBatch(commandBuffer, aIndex, sceneBatch);
+    if(mSceneRecord) mSceneRecord(commandBuffer, aIndex);
+    vkCmdEndRenderPass(commandBuffer);
+    if(profiled){
+        mGpuProfiler.cmdEndScope(commandBuffer, aIndex, renderPassScope);
+        mGpuProfiler.cmdEndScope(commandBuffer, aIndex, frameScope);
+    }
+
+    if(vkEndCommandBuffer(commandBuffer) != VK_SUCCESS){
+        throw std::runtime_error("Failed to end command buffer " + std::to_string(aIndex));
     }
 }
 
@@ -302,15 +750,21 @@ void VulkanGraphicsApp::initFramebuffers(){
 }
 
 void VulkanGraphicsApp::initSync(){
-    mImageAvailableSemaphores.resize(IN_FLIGHT_FRAME_LIMIT);
-    mRenderFinishSemaphores.resize(IN_FLIGHT_FRAME_LIMIT);
-    mInFlightFences.resize(IN_FLIGHT_FRAME_LIMIT);
+    const uint32_t framesInFlight = std::max(mFramePacing.framesInFlight, 1U);
+    mFramePacing.framesInFlight = framesInFlight;
+    mImageAvailableSemaphores.resize(framesInFlight);
+    mRenderFinishSemaphores.resize(framesInFlight);
+    mInFlightFences.resize(framesInFlight);
+    // Only called with the device idle, so no fence is waiting on an earlier frame
+    mInFlightFenceValues.assign(framesInFlight, 0);
+    mFrameSlotValues.assign(framesInFlight, 0);
+    mFrameDescriptorAllocators.resize(framesInFlight);
 
     VkFenceCreateInfo fenceInfo = {VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, nullptr, VK_FENCE_CREATE_SIGNALED_BIT};
     VkSemaphoreCreateInfo semaphoreCreate = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, nullptr, 0};
 
     bool failure = false;
-    for(size_t i = 0 ; i < IN_FLIGHT_FRAME_LIMIT; ++i){
+    for(size_t i = 0 ; i < framesInFlight; ++i){
         failure |= vkCreateSemaphore(mDeviceBundle.logicalDevice.handle(), &semaphoreCreate, nullptr, &mImageAvailableSemaphores[i]) != VK_SUCCESS;
         failure |= vkCreateSemaphore(mDeviceBundle.logicalDevice.handle(), &semaphoreCreate, nullptr, &mRenderFinishSemaphores[i]) != VK_SUCCESS;
         failure |= vkCreateFence(mDeviceBundle.logicalDevice.handle(), &fenceInfo, nullptr, &mInFlightFences[i]);
@@ -321,10 +775,179 @@ void VulkanGraphicsApp::initSync(){
 
 }
 
-void VulkanGraphicsApp::cleanupSwapchainDependents(){
-    vkDestroyDescriptorPool(mDeviceBundle.logicalDevice, mUniformDescriptorPool, nullptr);
+void VulkanGraphicsApp::initTimelineSync(){
+    if(mFrameTimeline.isValid() || !isTimelineSyncRequested()) return;
+    if(!getEnabledDeviceFeatures().vulkan12().timelineSemaphore){
+        std::cerr << "Warning: Timeline sync was requested, but timeline semaphores are not enabled on this device. Using fences." << std::endl;
+        return;
+    }
+    // Created once and kept across render setup resets, so frame values keep counting up
+    mFrameTimeline.create(mDeviceBundle.logicalDevice.handle(), mSubmittedFrameValue);
+}
+
+uint64_t VulkanGraphicsApp::getCompletedFrameValue(){
+    if(isTimelineSyncEnabled()){
+        markFramesCompleted(mFrameTimeline.getCompletedValue());
+    }else{
+        for(size_t i = 0; i < mInFlightFences.size(); ++i){
+            if(mInFlightFenceValues[i] > mCompletedFrameValue && vkGetFenceStatus(mDeviceBundle.logicalDevice.handle(), mInFlightFences[i]) == VK_SUCCESS){
+                markFramesCompleted(mInFlightFenceValues[i]);
+            }
+        }
+    }
+    return(mCompletedFrameValue);
+}
+
+bool VulkanGraphicsApp::waitForFrameValue(uint64_t aValue, uint64_t aTimeoutNs){
+    if(aValue <= mCompletedFrameValue) return(true);
+    if(aValue > mSubmittedFrameValue){
+        throw std::runtime_error("VulkanGraphicsApp::waitForFrameValue() Error: Frame " + std::to_string(aValue) + " has not been submitted!");
+    }
+
+    if(isTimelineSyncEnabled()){
+        if(!mFrameTimeline.wait(aValue, aTimeoutNs)) return(false);
+        markFramesCompleted(aValue);
+        return(true);
+    }
+
+    // A fence also covers every earlier submission to the queue, so wait on the oldest fence at or past aValue
+    size_t fenceIndex = mInFlightFences.size();
+    for(size_t i = 0; i < mInFlightFences.size(); ++i){
+        if(mInFlightFenceValues[i] >= aValue && (fenceIndex == mInFlightFences.size() || mInFlightFenceValues[i] < mInFlightFenceValues[fenceIndex])){
+            fenceIndex = i;
+        }
+    }
+    if(fenceIndex == mInFlightFences.size()) return(false);
+    VkResult result = vkWaitForFences(mDeviceBundle.logicalDevice.handle(), 1, &mInFlightFences[fenceIndex], VK_TRUE, aTimeoutNs);
+    if(result == VK_TIMEOUT) return(false);
+    if(result != VK_SUCCESS){
+        throw std::runtime_error("Failed to wait for in flight fence!");
+    }
+    markFramesCompleted(mInFlightFenceValues[fenceIndex]);
+    return(true);
+}
+
+void VulkanGraphicsApp::markFramesCompleted(uint64_t aValue){
+    if(aValue <= mCompletedFrameValue) return;
+    mCompletedFrameValue = aValue;
+    mFrameLatency.framesCompleted(aValue);
+    mFrameReadback.collect(aValue);
+    mGpuProfiler.collect(aValue);
+    mPipelineStatistics.collect(aValue);
+}
+
+void VulkanGraphicsApp::deferUntilSubmittedFramesComplete(std::function<void()> aCallback){
+    if(mSubmittedFrameValue <= mCompletedFrameValue){
+        if(aCallback) aCallback();
+        return;
+    }
+    mDeferredFrameWork.enqueue(mSubmittedFrameValue, std::move(aCallback));
+}
+
+void VulkanGraphicsApp::setFramePacing(const FramePacingConfig& aConfig){
+    applyFramePacing(aConfig);
+    mExplicitPresentMode = aConfig.preferredPresentMode;
+}
+
+void VulkanGraphicsApp::setLatencyMode(LatencyModeEnum aMode){
+    FramePacingConfig config = FramePacingConfig::fromLatencyMode(aMode);
+    if(mExplicitPresentMode != VK_PRESENT_MODE_MAX_ENUM_KHR){
+        config.preferredPresentMode = mExplicitPresentMode;
+    }
+    applyFramePacing(config);
+}
+
+void VulkanGraphicsApp::applyFramePacing(const FramePacingConfig& aConfig){
+    if(aConfig.framesInFlight == 0){
+        throw std::runtime_error("VulkanGraphicsApp::setFramePacing() Error: At least one frame must be allowed in flight!");
+    }
+    mFramePacing = aConfig;
+    if(mRenderPipeline.isValid())
+        resetRenderSetup();
+}
+
+bool VulkanGraphicsApp::setPresentMode(VkPresentModeKHR aMode){
+    std::vector<VkPresentModeKHR> modes = getSupportedPresentModes();
+    if(std::find(modes.begin(), modes.end(), aMode) == modes.end()) return(false);
+    if(aMode == getPresentMode() && aMode == mFramePacing.preferredPresentMode) return(true);
+
+    FramePacingConfig config = mFramePacing;
+    config.preferredPresentMode = aMode;
+    setFramePacing(config);
+    return(true);
+}
+
+void VulkanGraphicsApp::setFrameReadbackConsumer(vkutils::FrameReadback::ConsumerFunction aConsumer, uint32_t aSlotCount){
+    if(!(mSwapchainBundle.image_usage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)){
+        throw std::runtime_error("VulkanGraphicsApp::setFrameReadbackConsumer() Error: The swapchain images do not support being copied from!");
+    }
+    mFrameReadback.setConsumer(aConsumer);
+    if(!mFrameReadback.isValid() || mFrameReadback.getSlotCount() != aSlotCount){
+        initFrameReadback(aSlotCount);
+    }
+}
+
+void VulkanGraphicsApp::disableFrameReadback(){
+    if(!mFrameReadback.isValid()) return;
+    // Copies still in flight write into the buffers, so let them finish first
+    vkDeviceWaitIdle(mDeviceBundle.logicalDevice.handle());
+    markFramesCompleted(mSubmittedFrameValue);
+    mFrameReadback.destroy();
+}
+
+void VulkanGraphicsApp::initFrameReadback(uint32_t aSlotCount){
+    if(mFrameReadback.isValid()){
+        vkDeviceWaitIdle(mDeviceBundle.logicalDevice.handle());
+        markFramesCompleted(mSubmittedFrameValue);
+    }
+    const QueueAllocator& queues = mDeviceBundle.logicalDevice.getQueueAllocator();
+    mFrameReadback.create(
+        mDeviceBundle, *queues.getFamilyIndex(QUEUE_ROLE_GRAPHICS), mSwapchainBundle.extent,
+        mSwapchainBundle.surface_format.format, aSlotCount
+    );
+}
+
+bool VulkanGraphicsApp::setGpuProfilingEnabled(bool aEnabled){
+    if(aEnabled == mGpuProfiler.isValid()) return(true);
+    const uint32_t graphicsFamily = *mDeviceBundle.logicalDevice.getQueueAllocator().getFamilyIndex(QUEUE_ROLE_GRAPHICS);
+    if(aEnabled && !vkutils::GpuProfiler::is_supported(mDeviceBundle, graphicsFamily)){
+        std::cerr << "Warning: The graphics queue does not support timestamp queries. GPU profiling is unavailable." << std::endl;
+        return(false);
+    }
+
+    // Pools can only be replaced once no submitted command buffer writes to them
+    vkDeviceWaitIdle(mDeviceBundle.logicalDevice.handle());
+    markFramesCompleted(mSubmittedFrameValue);
+    if(aEnabled){
+        mGpuProfiler.create(mDeviceBundle, graphicsFamily, mCommandBuffers.size());
+    }else{
+        mGpuProfiler.destroy();
+    }
+    rerecordCommands();
+    return(true);
+}
+
+bool VulkanGraphicsApp::setPipelineStatisticsEnabled(bool aEnabled){
+    if(aEnabled == mPipelineStatistics.isValid()) return(true);
+    // Requested by requestDeviceFeatures(), but only enabled if the device has it
+    if(aEnabled && !getEnabledDeviceFeatures().core().pipelineStatisticsQuery){
+        std::cerr << "Warning: The device does not support pipeline statistics queries. Pipeline statistics are unavailable." << std::endl;
+        return(false);
+    }
+
+    vkDeviceWaitIdle(mDeviceBundle.logicalDevice.handle());
+    markFramesCompleted(mSubmittedFrameValue);
+    if(aEnabled){
+        mPipelineStatistics.create(mDeviceBundle, mCommandBuffers.size());
+    }else{
+        mPipelineStatistics.destroy();
+    }
+    rerecordCommands();
+    return(true);
+}
 
-    for(size_t i = 0; i < IN_FLIGHT_FRAME_LIMIT; ++i){
+void VulkanGraphicsApp::cleanupSwapchainDependents(){
+    for(size_t i = 0; i < mInFlightFences.size(); ++i){
         vkDestroySemaphore(mDeviceBundle.logicalDevice.handle(), mImageAvailableSemaphores[i], nullptr);
         vkDestroySemaphore(mDeviceBundle.logicalDevice.handle(), mRenderFinishSemaphores[i], nullptr);
         vkDestroyFence(mDeviceBundle.logicalDevice.handle(), mInFlightFences[i], nullptr);
@@ -341,13 +964,38 @@ void VulkanGraphicsApp::cleanupSwapchainDependents(){
 
 void VulkanGraphicsApp::cleanup(){
     for(std::pair<const std::string, VkShaderModule>& module : mShaderModules){
-        vkDestroyShaderModule(mDeviceBundle.logicalDevice.handle(), module.second, nullptr);
+        if(mShaderCache.contains(module.second)){
+            mShaderCache.release(module.second);
+        }else{
+            vkDestroyShaderModule(mDeviceBundle.logicalDevice.handle(), module.second, nullptr);
+        }
     }
+    mShaderModules.clear();
+    mShaderCache.clear();
 
     cleanupSwapchainDependents();
 
+    // The device is idle by now, so anything deferred may run
+    mDeferredFrameWork.flush();
+    mFrameTimeline.destroy();
+    mFrameReadback.destroy();
+    mGpuProfiler.destroy();
+    mPipelineStatistics.destroy();
+
+    mUniformUpdateTemplate.destroy();
+    mAsyncCompute.destroy();
+    mBindlessTable.destroy();
+    if(mEmptySetLayout != VK_NULL_HANDLE){
+        vkDestroyDescriptorSetLayout(mDeviceBundle.logicalDevice.handle(), mEmptySetLayout, nullptr);
+        mEmptySetLayout = VK_NULL_HANDLE;
+    }
+    mDescriptorSetCache.clear();
+    for(vkutils::DescriptorAllocator& allocator : mFrameDescriptorAllocators){
+        allocator.destroy();
+    }
     mUniformBuffer.freeBuffer();
-    mUniformDescriptorSets.clear();
+    mUniformDescriptorSet = VK_NULL_HANDLE;
+    mWatchedBuffers.clear();
 
     vkDestroyCommandPool(mDeviceBundle.logicalDevice.handle(), mCommandPool, nullptr);
 
@@ -356,6 +1004,12 @@ void VulkanGraphicsApp::cleanup(){
 
 void VulkanGraphicsApp::initUniformBuffer() {
     if(mUniformBuffer.getBoundDataCount() == 0) return;
+
+    // Sets written against a layout that is about to be rebuilt must not be handed out again
+    if(mUniformBuffer.isLayoutOutOfDate() && mUniformBuffer.getDescriptorSetLayout() != VK_NULL_HANDLE){
+        getDescriptorSetCache().forgetLayout(mUniformBuffer.getDescriptorSetLayout());
+        mUniformUpdateTemplate.destroy();
+    }
     
     if(!mUniformBuffer.getCurrentDevice().isValid()){
         mUniformBuffer.updateDevice(mDeviceBundle);
@@ -363,78 +1017,34 @@ void VulkanGraphicsApp::initUniformBuffer() {
         mUniformBuffer.updateDevice();
     }
 
-    mTotalUniformDescriptorSetCount = mSwapchainBundle.images.size();
     mUniformDescriptorSetLayouts.assign(1, mUniformBuffer.getDescriptorSetLayout());
 
-    initUniformDescriptorPool();
     initUniformDescriptorSets();
 }
     
-void VulkanGraphicsApp::initUniformDescriptorPool() {
-    VkDescriptorPoolSize poolSize;
-        poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        poolSize.descriptorCount = mTotalUniformDescriptorSetCount*mUniformBuffer.getBoundDataCount(); // TODO: Check for error
-
-    VkDescriptorPoolCreateInfo createInfo;
-    {
-        createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        createInfo.pNext = nullptr;
-        createInfo.flags = 0;
-        createInfo.maxSets = mTotalUniformDescriptorSetCount;
-        createInfo.poolSizeCount = 1;
-        createInfo.pPoolSizes = &poolSize;
-    }
-
-    if(vkCreateDescriptorPool(mDeviceBundle.logicalDevice, &createInfo, nullptr, &mUniformDescriptorPool) != VK_SUCCESS){
-        throw std::runtime_error("Failed to create uniform descriptor pool");
-    }
-}
-    
 void VulkanGraphicsApp::initUniformDescriptorSets() {
-    assert(mTotalUniformDescriptorSetCount != 0);
+    VkDescriptorSetLayout layout = mUniformBuffer.getDescriptorSetLayout();
+    if(!mUniformUpdateTemplate.isValid() || mUniformUpdateTemplate.getLayout() != layout){
+        mUniformUpdateTemplate.create(mDeviceBundle.logicalDevice.handle(), layout, mUniformBuffer.getLayoutBindings());
+    }
 
-    
-    std::vector<VkDescriptorSetLayout> layouts(mTotalUniformDescriptorSetCount, mUniformBuffer.getDescriptorSetLayout());
+    mUniformPayload.resize(mUniformUpdateTemplate.getPayloadCount());
+    mUniformBuffer.writeDescriptorBufferInfos(&mUniformPayload.data()->buffer, sizeof(vkutils::DescriptorPayload));
 
-    VkDescriptorSetAllocateInfo allocInfo;
-    {
-        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        allocInfo.pNext = nullptr;
-        allocInfo.descriptorPool = mUniformDescriptorPool;
-        allocInfo.descriptorSetCount = mTotalUniformDescriptorSetCount;
-        allocInfo.pSetLayouts = layouts.data();
-    }
-    
-    mUniformDescriptorSets.resize(mTotalUniformDescriptorSetCount, VK_NULL_HANDLE);
-    VkResult allocResult = vkAllocateDescriptorSets(mDeviceBundle.logicalDevice, &allocInfo, mUniformDescriptorSets.data());
-    if(allocResult != VK_SUCCESS){
-        throw std::runtime_error("Failed to allocate uniform descriptor sets");
+    std::vector<uint32_t> bindingPoints = mUniformBuffer.getBoundPoints();
+    mUniformBindings.clear();
+    for(size_t i = 0; i < bindingPoints.size(); ++i){
+        mUniformBindings.emplace_back(vkutils::DescriptorBinding::buffer(bindingPoints[i], VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, mUniformPayload[i].buffer));
     }
 
-    std::vector<VkDescriptorBufferInfo> bufferInfos = mUniformBuffer.getDescriptorBufferInfos();
-    std::vector<uint32_t> bindingPoints = mUniformBuffer.getBoundPoints();
+    // Every swapchain image reads the same uniform buffer, so a single set serves them all. If nothing about
+    // the uniforms changed since the last reset, this is a cache hit and no descriptors are written.
+    mUniformDescriptorSet = getDescriptorSetCache().getOrCreate(mUniformUpdateTemplate, mUniformBindings);
+}
 
-    std::vector<VkWriteDescriptorSet> setWriters;
-    setWriters.reserve(mUniformDescriptorSets.size() * bindingPoints.size());
-
-    for(VkDescriptorSet descriptorSet : mUniformDescriptorSets){
-        for(size_t i = 0; i < bindingPoints.size(); ++i){
-            setWriters.emplace_back(
-                VkWriteDescriptorSet{
-                    /* sType = */ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    /* pNext = */ nullptr, 
-                    /* dstSet = */ descriptorSet,
-                    /* dstBinding = */ bindingPoints[i],
-                    /* dstArrayElement = */ 0,
-                    /* descriptorCount = */ 1,
-                    /* descriptorType = */ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                    /* pImageInfo = */ nullptr,
-                    /* pBufferInfo = */ &bufferInfos[i],
-                    /* pTexelBufferView = */ nullptr
-                }
-            );
-        }
+void VulkanGraphicsApp::writeUniformDescriptors(VkDescriptorSet aSet) {
+    if(!mUniformUpdateTemplate.isValid()){
+        throw std::runtime_error("VulkanGraphicsApp::writeUniformDescriptors() Error: No uniforms have been initialized!");
     }
-    vkUpdateDescriptorSets(mDeviceBundle.logicalDevice, setWriters.size(), setWriters.data(), 0, nullptr);
+    mUniformUpdateTemplate.update(aSet, mUniformPayload.data());
 }
-
@@ -2,9 +2,45 @@
 #define VULKAN_GRAPHICS_APP_H_
 #include "VulkanSetupBaseApp.h"
 #include "vkutils/vkutils.h"
+#include "vkutils/ShaderModuleCache.h"
+#include "vkutils/DescriptorAllocator.h"
+#include "vkutils/BindlessDescriptorTable.h"
+#include "vkutils/AsyncComputeScheduler.h"
+#include "vkutils/TimelineSemaphore.h"
+#include "vkutils/FrameReadback.h"
+#include "vkutils/GpuProfiler.h"
+#include "vkutils/PipelineStatistics.h"
 #include "data/VertexGeometry.h"
 #include "data/UniformBuffer.h"
+#include "data/DeviceSyncedBuffer.h"
+#include "utils/FrameLatencyTracker.h"
 #include <map>
+#include <array>
+#include <set>
+#include <chrono>
+
+/// How rendering slows down while the window is in the background
+struct BackgroundThrottlePolicy
+{
+    /// Submit nothing while the window is iconified or has a zero sized framebuffer
+    bool pauseWhenIconified = true;
+    /// Frame rate cap while the window doesn't have focus. 0 leaves unfocused windows unthrottled.
+    double unfocusedFps = 10.0;
+};
+
+/// Number of frames held back by the background throttle policy. A frame held back over several polls counts once.
+struct SkippedFrameCounts
+{
+    uint64_t iconified = 0;
+    uint64_t unfocused = 0;
+};
+
+/// CPU time spent in the driver calls of the most recent render(), in milliseconds
+struct FrameCallTimings
+{
+    double submit = 0.0; // vkQueueSubmit
+    double present = 0.0; // vkQueuePresentKHR, 0 when headless
+};
 
 class VulkanGraphicsApp : public VulkanSetupBaseApp{
  public:
@@ -16,7 +52,8 @@ class VulkanGraphicsApp : public VulkanSetupBaseApp{
 
  protected:
 
-    void render();
+    /// Record and submit a frame. Returns false if nothing was submitted because the background throttle policy held the frame back.
+    bool render();
 
     void setVertexInput(
        const VkVertexInputBindingDescription& aBindingDescription,
@@ -25,11 +62,18 @@ class VulkanGraphicsApp : public VulkanSetupBaseApp{
 
     void setVertexBuffer(const VkBuffer& aBuffer, size_t aVertexCount);
 
+    /// Set the vertex or fragment shader. The app takes ownership of the module and frees it during cleanup().
     void setVertexShader(const std::string& aShaderName, const VkShaderModule& aShaderModule);
     void setFragmentShader(const std::string& aShaderName, const VkShaderModule& aShaderModule);
 
+    /// Cache used to load shader modules so that identical SPIR-V shares a single module. 
+    /// Modules acquired from it may be handed directly to setVertexShader() and setFragmentShader(). 
+    vkutils::ShaderModuleCache& getShaderCache();
+
     /** Add a new uniform to the graphics pipeline via the uniform handler interface class.
      * If a uniform handler already exists for the given binding point, the existing handler is freed and replaced. 
+     * When the shaders were loaded through getShaderCache(), the stage flags are narrowed to the stages that 
+     * actually use the binding, and the size of the uniform data is checked against the shader's block. 
      * 
      * Arguments:
      *   aBindingPoint: The bind point for the uniform to be bound
@@ -38,6 +82,153 @@ class VulkanGraphicsApp : public VulkanSetupBaseApp{
     */
     void addUniform(uint32_t aBindPoint, UniformDataInterfacePtr aUniformData, VkShaderStageFlags aStageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
 
+    /** Set the specialization constants used for a shader stage when the render pipeline is built.
+     * If the pipeline already exists and the constants differ, it is rebuilt as the new variant. 
+     * 
+     * Arguments:
+     *   aStage: Either VK_SHADER_STAGE_VERTEX_BIT or VK_SHADER_STAGE_FRAGMENT_BIT
+     *   aConstants: Constant values for the stage. An empty set clears specialization for the stage. 
+    */
+    void setSpecializationConstants(VkShaderStageFlagBits aStage, const vkutils::SpecializationConstants& aConstants);
+
+    /// Key identifying the current pipeline variant by its shaders and specialization constants.
+    size_t getPipelineVariantKey() const;
+
+    /// Cache of immutable descriptor sets. Sets requested with identical bindings are shared and never rewritten.
+    vkutils::DescriptorSetCache& getDescriptorSetCache();
+
+    /// Allocate a descriptor set that is only valid for the next frame render() submits. 
+    /// Its pools are recycled when that frame's sync slot comes around again and the slot's last frame has finished. 
+    /// Pass the layout's bindings if it may hold more descriptors of a type than the default pool mix.
+    VkDescriptorSet allocateFrameDescriptorSet(VkDescriptorSetLayout aLayout, const std::vector<VkDescriptorSetLayoutBinding>& aBindings = {});
+
+    /// Write the current uniform bindings into aSet, which must use the uniform descriptor set layout. 
+    /// Uses a descriptor update template, so it is cheap enough to call for freshly allocated sets every frame. 
+    void writeUniformDescriptors(VkDescriptorSet aSet);
+
+    /** Global bindless table of storage buffers and sampled images, bound at descriptor set sBindlessSetIndex.
+     * Created on first use. Requires isBindlessRequested() to be overridden to return true, and throws if the 
+     * device could not enable the descriptor indexing features it needs. 
+    */
+    vkutils::BindlessDescriptorTable& getBindlessTable();
+    static const uint32_t sBindlessSetIndex = 1;
+
+    /** Set the bytes pushed as push constants before drawing, e.g. bindless slot indices.
+     * Pushed for every push constant range reflected from the shaders that aData covers. 
+     * Changing the data marks the command buffers stale. Each one is re-recorded when its image is next
+     * rendered, once the frame that last used it has finished, so no device wide wait is needed. 
+    */
+    void setPushConstants(const void* aData, uint32_t aSize);
+
+    using RecordFunction = std::function<void(VkCommandBuffer aCommandBuffer, uint32_t aImageIndex)>;
+    /** Record extra commands into every frame's render pass, after the scene is drawn with its pipeline, vertex 
+     * buffer, descriptor sets and push constants still bound. aImageIndex is also the command buffer's GPU 
+     * profiler slot, so user-defined scopes can be wrapped around the commands with getGpuProfiler(). 
+     * Command buffers are recorded ahead of time, so aRecord runs again only when they are re-recorded. 
+     * Setting it marks them stale like setPushConstants(). Pass nullptr to remove it. 
+    */
+    void setSceneRecordCallback(RecordFunction aRecord);
+
+    /** Compute passes submitted to the compute queue at the start of every frame. Graphics work waits on 
+     * them at the consumer stages given when each pass was added. Created on first use, using a dedicated 
+     * compute queue family when the device has one. 
+    */
+    vkutils::AsyncComputeScheduler& getAsyncCompute();
+
+    /// Override to return true to synchronize frames through a timeline semaphore instead of per-frame fences, 
+    /// if the device supports timeline semaphores
+    virtual bool isTimelineSyncRequested() const {return(false);}
+    bool isTimelineSyncEnabled() const {return(mFrameTimeline.isValid());}
+
+    /** Frame values count graphics submissions: the n-th frame submitted signals value n on completion. 
+     * They work with either sync mode, but polling and waiting on arbitrary past frames is only cheap with
+     * the timeline semaphore, which the fence mode has to approximate using the in flight fences.
+    */
+    uint64_t getSubmittedFrameValue() const {return(mSubmittedFrameValue);}
+    uint64_t getCompletedFrameValue();
+    /// Block until the frame with value aValue has finished on the GPU. Returns false if aTimeoutNs elapses first.
+    bool waitForFrameValue(uint64_t aValue, uint64_t aTimeoutNs = std::numeric_limits<uint64_t>::max());
+
+    /// Run aCallback once every frame submitted so far has finished, e.g. to destroy resources those frames use. 
+    void deferUntilSubmittedFramesComplete(std::function<void()> aCallback);
+
+    /** Change the number of frames in flight, the swapchain image count and the preferred present mode. 
+     * Takes effect immediately by waiting for the device to go idle and rebuilding the swapchain. 
+    */
+    void setFramePacing(const FramePacingConfig& aConfig);
+    /// Pace frames as aMode suggests. A present mode chosen with setPresentMode() or setFramePacing() is kept. 
+    void setLatencyMode(LatencyModeEnum aMode);
+    /// As setFramePacing(), but aConfig's present mode doesn't replace the one chosen explicitly, e.g. to restore an earlier config. 
+    void applyFramePacing(const FramePacingConfig& aConfig);
+
+    /// Switch to aMode, e.g. FIFO for vsync or IMMEDIATE for uncapped throughput, by recreating the swapchain. 
+    /// Returns false and changes nothing if the surface doesn't support aMode. 
+    bool setPresentMode(VkPresentModeKHR aMode);
+
+    const FrameCallTimings& getLastFrameCallTimings() const {return(mLastCallTimings);}
+
+    /// Time from the start of each frame's render() call until its GPU work was seen complete, in milliseconds
+    const FrameLatencyTracker& getFrameLatency() const {return(mFrameLatency);}
+    FrameLatencyTracker& getFrameLatency() {return(mFrameLatency);}
+
+    /** In on-demand mode, isRedrawNeeded() only reports a redraw when something changed: a uniform or watched 
+     * buffer is out of sync with the device, a window or input event arrived, an animation is registered, 
+     * the render setup was rebuilt, or requestRedraw() was called. Run loops should then wait for events 
+     * with waitForEvents() and skip render() when no redraw is needed. 
+    */
+    void setRenderOnDemand(bool aOnDemand) {mRenderOnDemand = aOnDemand; requestRedraw();}
+    bool isRenderOnDemand() const {return(mRenderOnDemand);}
+    bool isRedrawNeeded() const;
+    void requestRedraw() {mRedrawRequested = true;}
+
+    /// Animations keep on-demand mode redrawing every frame until removed
+    void addAnimation(const std::string& aName) {mAnimations.insert(aName);}
+    void removeAnimation(const std::string& aName) {mAnimations.erase(aName);}
+    bool hasAnimations() const {return(!mAnimations.empty());}
+
+    /// Buffers to check for changes that aren't uploaded yet, e.g. geometry uploaded by the render() override
+    void watchBuffer(std::shared_ptr<const DeviceSyncedBuffer> aBuffer);
+    void unwatchBuffer(const DeviceSyncedBuffer* aBuffer);
+
+    /// Poll for events, or block until one arrives or aTimeoutSeconds pass if on-demand mode has nothing to draw, 
+    /// or the background throttle policy is holding back the next frame
+    void waitForEvents(double aTimeoutSeconds = 0.5);
+
+    void setBackgroundThrottlePolicy(const BackgroundThrottlePolicy& aPolicy) {mThrottlePolicy = aPolicy;}
+    const BackgroundThrottlePolicy& getBackgroundThrottlePolicy() const {return(mThrottlePolicy);}
+    const SkippedFrameCounts& getSkippedFrameCounts() const {return(mSkippedFrames);}
+    /// True, and counted as a skipped frame, if the background throttle policy holds back the frame now. 
+    /// render() already checks this, but run loops may too so they can skip their own per-frame work. 
+    bool skipThrottledFrame();
+
+    /** Copy every rendered frame back to host memory and pass it to aConsumer on a worker thread once the GPU
+     * has finished it. Uses aSlotCount host buffers; frames are dropped rather than stalling render() when all
+     * of them are busy. Throws if the swapchain images can't be used as a copy source. 
+    */
+    void setFrameReadbackConsumer(vkutils::FrameReadback::ConsumerFunction aConsumer, uint32_t aSlotCount = 4);
+    void disableFrameReadback();
+    const vkutils::FrameReadback& getFrameReadback() const {return(mFrameReadback);}
+
+    /** Time the GPU work of every frame with timestamp queries, under the scopes "frame" and "render_pass". 
+     * Results arrive once frames complete, without stalling. Returns false and leaves profiling off if the 
+     * graphics queue doesn't support timestamps. Re-records the command buffers. 
+     * Further scopes can be recorded from setSceneRecordCallback(). 
+    */
+    bool setGpuProfilingEnabled(bool aEnabled);
+    bool isGpuProfilingEnabled() const {return(mGpuProfiler.isValid());}
+    /// One profiler slot per command buffer, i.e. per swapchain image, since command buffers are recorded per image
+    vkutils::GpuProfiler& getGpuProfiler() {return(mGpuProfiler);}
+    const vkutils::GpuProfiler& getGpuProfiler() const {return(mGpuProfiler);}
+
+    /** Count primitives and shader invocations of the scene's draws every frame, under the batch "scene", to
+     * gauge vertex reuse and overdraw. Returns false and leaves collection off if the device was created without
+     * the pipelineStatisticsQuery feature. Re-records the command buffers.
+    */
+    bool setPipelineStatisticsEnabled(bool aEnabled);
+    bool isPipelineStatisticsEnabled() const {return(mPipelineStatistics.isValid());}
+    const vkutils::PipelineStatistics& getPipelineStatistics() const {return(mPipelineStatistics);}
+    vkutils::PipelineStatistics& getPipelineStatistics() {return(mPipelineStatistics);}
+
     size_t mFrameNumber = 0;
 
  private:
@@ -45,42 +236,100 @@ class VulkanGraphicsApp : public VulkanSetupBaseApp{
     void initRenderPipeline();
     void initFramebuffers();
     void initCommands();
+    void recordCommandBuffer(uint32_t aIndex);
     void initSync();
+    void initTimelineSync();
+    void initFrameReadback(uint32_t aSlotCount);
+    void markFramesCompleted(uint64_t aValue);
+    /// Seconds until the background throttle policy allows another frame, or a negative value while paused
+    double getThrottleDelay() const;
+
+    /** Index of the sync slot for the frame about to be submitted. The first call for a frame waits until the
+     * frame that last used the slot has finished and recycles the slot's transient descriptor pools.
+    */
+    size_t prepareFrameSlot();
 
     void resetRenderSetup();
+    void rerecordCommands();
+    void applyShaderReflection();
     void cleanupSwapchainDependents();
 
     void initUniformBuffer();
-    void initUniformDescriptorPool();
     void initUniformDescriptorSets();
 
-    const static int IN_FLIGHT_FRAME_LIMIT = 2;
     std::vector<VkFramebuffer> mSwapchainFramebuffers;
     std::vector<VkSemaphore> mImageAvailableSemaphores;
     std::vector<VkSemaphore> mRenderFinishSemaphores;
     std::vector<VkFence> mInFlightFences;
+    std::vector<uint64_t> mInFlightFenceValues; // Frame value last submitted with each fence
+    std::vector<uint64_t> mFrameSlotValues; // Frame value each sync slot was last prepared for
+
+    vkutils::TimelineSemaphore mFrameTimeline;
+    uint64_t mSubmittedFrameValue = 0;
+    uint64_t mCompletedFrameValue = 0;
+    vkutils::DeferredTimelineQueue mDeferredFrameWork;
+    FrameLatencyTracker mFrameLatency;
+    FrameCallTimings mLastCallTimings;
+    vkutils::GpuProfiler mGpuProfiler;
+    vkutils::PipelineStatistics mPipelineStatistics;
+    vkutils::FrameReadback mFrameReadback;
 
     vkutils::BasicVulkanRenderPipeline mRenderPipeline;
 
     VkCommandPool mCommandPool = VK_NULL_HANDLE;
     std::vector<VkCommandBuffer> mCommandBuffers;
+    std::vector<uint64_t> mCommandBufferFrameValues; // Frame value each command buffer was last submitted with
+    std::vector<bool> mStaleCommandBuffers; // Recorded with push constants or a scene callback that have since changed
+    RecordFunction mSceneRecord;
+    uint32_t mOffscreenImageIndex = 0; // Next offscreen image to render to when headless
 
+    vkutils::ShaderModuleCache mShaderCache;
     std::unordered_map<std::string, VkShaderModule> mShaderModules;
     std::string mVertexKey;
     std::string mFragmentKey;
 
+    vkutils::SpecializationConstants mVertexSpecialization;
+    vkutils::SpecializationConstants mFragmentSpecialization;
+    VkSpecializationInfo mVertexSpecializationInfo = {};
+    VkSpecializationInfo mFragmentSpecializationInfo = {};
+
     bool mVertexInputsHaveBeenSet = false;
     VkVertexInputBindingDescription mBindingDescription = {};
     std::vector<VkVertexInputAttributeDescription> mAttributeDescriptions;
+    std::vector<VkPushConstantRange> mPushConstantRanges;
+    std::vector<VkPushConstantRange> mPushConstantIntervals; // Ranges split so that overlapping stages are pushed together
+    std::vector<uint8_t> mPushConstantData;
     VkBuffer mVertexBuffer = VK_NULL_HANDLE;
     size_t mVertexCount = 0U;
 
 
     UniformBuffer mUniformBuffer;
-    VkDeviceSize mTotalUniformDescriptorSetCount = 0;
-    VkDescriptorPool mUniformDescriptorPool = VK_NULL_HANDLE;
     std::vector<VkDescriptorSetLayout> mUniformDescriptorSetLayouts;
-    std::vector<VkDescriptorSet> mUniformDescriptorSets;
+    VkDescriptorSet mUniformDescriptorSet = VK_NULL_HANDLE;
+    vkutils::DescriptorUpdateTemplate mUniformUpdateTemplate;
+    std::vector<vkutils::DescriptorPayload> mUniformPayload;
+    std::vector<vkutils::DescriptorBinding> mUniformBindings;
+
+    vkutils::DescriptorSetCache mDescriptorSetCache;
+    std::vector<vkutils::DescriptorAllocator> mFrameDescriptorAllocators;
+
+    vkutils::AsyncComputeScheduler mAsyncCompute;
+
+    bool mRenderOnDemand = false;
+    bool mRedrawRequested = true;
+    std::set<std::string> mAnimations;
+    std::vector<std::shared_ptr<const DeviceSyncedBuffer>> mWatchedBuffers;
+
+    VkPresentModeKHR mExplicitPresentMode = VK_PRESENT_MODE_MAX_ENUM_KHR; // Last present mode asked for by the app itself
+
+    BackgroundThrottlePolicy mThrottlePolicy;
+    SkippedFrameCounts mSkippedFrames;
+    bool mHeldFrameCounted = false; // The frame currently held back by the throttle policy has been counted
+    std::chrono::steady_clock::time_point mLastFrameStart;
+
+    vkutils::BindlessDescriptorTable mBindlessTable;
+    VkDescriptorSetLayout mEmptySetLayout = VK_NULL_HANDLE; // Fills set 0 when bindless is used without uniforms
+    std::vector<VkDescriptorSetLayout> mPipelineSetLayouts;
 };
 
 #endif
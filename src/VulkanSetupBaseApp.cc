@@ -1,5 +1,7 @@
 #include "VulkanSetupBaseApp.h"
 #include "utils/common.h"
+#include "utils/CpuProfiler.h"
+#include "utils/TransferCounters.h"
 #include <iostream>
 #include <algorithm>
 #include <cassert>
@@ -8,20 +10,58 @@
 
 static void error_callback(int error, const char* description){std::cerr << "glfw error: " << description << std::endl;} 
 static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods){
+	VulkanSetupBaseApp::sWindowFlags[window].eventReceived = true;
 	if(key == GLFW_KEY_ESCAPE && action == GLFW_PRESS){
 		glfwSetWindowShouldClose(window, true);
+	}else if(key == GLFW_KEY_P && action == GLFW_PRESS){
+		VulkanSetupBaseApp::sWindowFlags[window].cyclePresentMode = true;
+	}else if(key == GLFW_KEY_T && action == GLFW_PRESS){
+		VulkanSetupBaseApp::sWindowFlags[window].captureCpuTrace = true;
 	}
 }
 
 static VkPhysicalDevice select_physical_device(const std::vector<VkPhysicalDevice>& aDevices);
+static void request_bindless_features(vkutils::DeviceFeatureSet& aFeatures);
 
 std::unordered_map<GLFWwindow*, VulkanSetupBaseApp::WindowFlags> VulkanSetupBaseApp::sWindowFlags;
 
+FramePacingConfig FramePacingConfig::fromLatencyMode(LatencyModeEnum aMode){
+    FramePacingConfig config;
+    switch(aMode){
+        case LATENCY_MODE_LOW:
+            config.framesInFlight = 1;
+            config.extraSwapchainImages = 0;
+            config.preferredPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+            break;
+        case LATENCY_MODE_THROUGHPUT:
+            config.framesInFlight = 3;
+            config.extraSwapchainImages = 2;
+            break;
+        case LATENCY_MODE_BALANCED:
+        default:
+            break;
+    }
+    return(config);
+}
+
 void VulkanSetupBaseApp::init(){
-    initGlfw();
+    CPU_PROFILE_ZONE("VulkanSetupBaseApp::init");
+    if(!mHeadless){
+        initGlfw();
+    }
     initVulkan();
 }
 
+void VulkanSetupBaseApp::setHeadless(bool aHeadless, const VkExtent2D& aExtent){
+    if(mVkInstance != VK_NULL_HANDLE){
+        throw std::runtime_error("VulkanSetupBaseApp::setHeadless() Error: Must be called before init()!");
+    }
+    mHeadless = aHeadless;
+    if(mHeadless){
+        mViewportExtent = aExtent;
+    }
+}
+
 const VkApplicationInfo& VulkanSetupBaseApp::getAppInfo() const{
     const static VkApplicationInfo sAppInfo = {
         /* appInfo.sType = */ VK_STRUCTURE_TYPE_APPLICATION_INFO,
@@ -30,7 +70,7 @@ const VkApplicationInfo& VulkanSetupBaseApp::getAppInfo() const{
         /* appInfo.applicationVersion = */ VK_MAKE_VERSION(0, 0, 0),
         /* appInfo.pEngineName = */ "Tutorial",
         /* appInfo.engineVersion = */ VK_MAKE_VERSION(0,0,0),
-        /* appInfo.apiVersion = */ VK_API_VERSION_1_1
+        /* appInfo.apiVersion = */ VK_API_VERSION_1_3
     };
     return(sAppInfo);
 }
@@ -72,6 +112,21 @@ const std::vector<std::string>& VulkanSetupBaseApp::getRequestedDeviceExtensions
     };
     return(sRequested);
 }
+const QueueSelectionPolicy& VulkanSetupBaseApp::getQueueSelectionPolicy() const {
+    const static QueueSelectionPolicy sPolicy;
+    return(sPolicy);
+}
+void VulkanSetupBaseApp::requireDeviceFeatures(vkutils::DeviceFeatureSet& aFeatures) const {
+    // None
+}
+void VulkanSetupBaseApp::requestDeviceFeatures(vkutils::DeviceFeatureSet& aFeatures) const {
+    aFeatures.core().samplerAnisotropy = VK_TRUE;
+    aFeatures.core().multiDrawIndirect = VK_TRUE;
+    aFeatures.core().drawIndirectFirstInstance = VK_TRUE;
+    aFeatures.core().pipelineStatisticsQuery = VK_TRUE;
+    aFeatures.vulkan11().storageBuffer16BitAccess = VK_TRUE;
+    aFeatures.vulkan12().timelineSemaphore = VK_TRUE;
+}
 const std::unordered_map<std::string, bool>& VulkanSetupBaseApp::getValidationLayersState() const {
     return(_mValidationLayers);
 }
@@ -106,31 +161,55 @@ void VulkanSetupBaseApp::initGlfw(){
 
     GLFWframebuffersizefun resizeCallback = [](GLFWwindow* aWindow, int, int) {
         VulkanSetupBaseApp::sWindowFlags[aWindow].resized = true;
+        VulkanSetupBaseApp::sWindowFlags[aWindow].eventReceived = true;
     };
     glfwSetFramebufferSizeCallback(mWindow, resizeCallback);
 
     GLFWwindowiconifyfun iconifyCallback = [](GLFWwindow* aWindow, int aIconified){
         VulkanSetupBaseApp::sWindowFlags[aWindow].iconified = (aIconified == GLFW_TRUE) ? true : false;
+        VulkanSetupBaseApp::sWindowFlags[aWindow].eventReceived = true;
     };
     glfwSetWindowIconifyCallback(mWindow, iconifyCallback);
 
     GLFWwindowfocusfun focusCallback = [](GLFWwindow* aWindow, int aFocus){
         VulkanSetupBaseApp::sWindowFlags[aWindow].focus = (aFocus == GLFW_TRUE) ? true : false;
+        VulkanSetupBaseApp::sWindowFlags[aWindow].eventReceived = true;
     };
     glfwSetWindowFocusCallback(mWindow, focusCallback);
+
+    // Remaining events only matter for knowing when something may have changed
+    GLFWwindowrefreshfun refreshCallback = [](GLFWwindow* aWindow){
+        VulkanSetupBaseApp::sWindowFlags[aWindow].eventReceived = true;
+    };
+    glfwSetWindowRefreshCallback(mWindow, refreshCallback);
+    GLFWcursorposfun cursorCallback = [](GLFWwindow* aWindow, double, double){
+        VulkanSetupBaseApp::sWindowFlags[aWindow].eventReceived = true;
+    };
+    glfwSetCursorPosCallback(mWindow, cursorCallback);
+    GLFWmousebuttonfun mouseButtonCallback = [](GLFWwindow* aWindow, int, int, int){
+        VulkanSetupBaseApp::sWindowFlags[aWindow].eventReceived = true;
+    };
+    glfwSetMouseButtonCallback(mWindow, mouseButtonCallback);
+    GLFWscrollfun scrollCallback = [](GLFWwindow* aWindow, double, double){
+        VulkanSetupBaseApp::sWindowFlags[aWindow].eventReceived = true;
+    };
+    glfwSetScrollCallback(mWindow, scrollCallback);
 }
 
 std::vector<std::string> VulkanSetupBaseApp::gatherExtensionInfo(){
     // Create list of extension names that will be returned
     std::vector<std::string> extensionList;
 
-    // Get the list of extensions required by GLFW
+    // Get the list of extensions required by GLFW. Headless apps don't need any. 
     uint32_t glfw_ext_count = 0;
-    const char** glfw_req_exts = glfwGetRequiredInstanceExtensions(&glfw_ext_count);
+    const char** glfw_req_exts = mHeadless ? nullptr : glfwGetRequiredInstanceExtensions(&glfw_ext_count);
 
-    printf("GLFW requires the following extensions:\n");
-    for(uint32_t i = 0; i < glfw_ext_count; ++i){
-        printf("  - %s\n", glfw_req_exts[i]);
+    if(!mHeadless){
+        // Through std::cout rather than printf so apps that redirect std::cout catch it too
+        std::cout << "GLFW requires the following extensions:" << std::endl;
+        for(uint32_t i = 0; i < glfw_ext_count; ++i){
+            std::cout << "  - " << glfw_req_exts[i] << std::endl;
+        }
     }
 
     // Get the required and requested extensions for this application
@@ -209,6 +288,7 @@ void VulkanSetupBaseApp::createVkInstance(){
 }
 
 void VulkanSetupBaseApp::initVkDevices(){
+    CPU_PROFILE_ZONE("VulkanSetupBaseApp::initVkDevices");
     // Enumerate the list of visible Vulkan supporting physical devices
     uint32_t deviceCount = 0;
     vkEnumeratePhysicalDevices(mVkInstance, &deviceCount, nullptr);
@@ -231,35 +311,100 @@ void VulkanSetupBaseApp::initVkDevices(){
 
     // Wrap physical device with utility class. 
     mDeviceBundle.physicalDevice = VulkanPhysicalDevice(selectedDevice);;
-    assert(mDeviceBundle.physicalDevice.coreFeaturesIdx && mDeviceBundle.physicalDevice.getPresentableQueueIndex(mVkSurface));
+    assert(mDeviceBundle.physicalDevice.coreFeaturesIdx && (mHeadless || mDeviceBundle.physicalDevice.getPresentableQueueIndex(mVkSurface)));
 
-    const std::vector<std::string>& requiredExts = getRequiredDeviceExtensions();
+    std::vector<std::string> requiredExts = getRequiredDeviceExtensions();
+    if(mHeadless){
+        // Nothing is presented, so devices without swapchain support will do
+        requiredExts.erase(std::remove(requiredExts.begin(), requiredExts.end(), std::string(VK_KHR_SWAPCHAIN_EXTENSION_NAME)), requiredExts.end());
+    }
     const std::vector<std::string>& requestedExts = getRequestedDeviceExtensions();
 
     std::vector<std::string> deviceExtensions;
 
     vkutils::find_extension_matches(mDeviceBundle.physicalDevice.mAvailableExtensions, requiredExts, requestedExts, deviceExtensions);
 
-    mDeviceBundle.logicalDevice = mDeviceBundle.physicalDevice.createPresentableCoreDevice(mVkSurface, vkutils::strings_to_cstrs(deviceExtensions));
+    // Negotiate device features. Required features must all be present, requested features are enabled if available.
+    const uint32_t instanceApiVersion = getAppInfo().apiVersion;
+    vkutils::DeviceFeatureSet available = vkutils::DeviceFeatureSet::query(mDeviceBundle.physicalDevice, instanceApiVersion);
+    vkutils::DeviceFeatureSet required(instanceApiVersion);
+    vkutils::DeviceFeatureSet requested(instanceApiVersion);
+    requireDeviceFeatures(required);
+    requestDeviceFeatures(requested);
+    if(isBindlessRequested()){
+        request_bindless_features(requested);
+    }
+
+    size_t missing = 0;
+    vkutils::DeviceFeatureSet::intersect(required, available, &missing);
+    if(missing > 0){
+        throw std::runtime_error("The selected physical device is missing " + std::to_string(missing) + " required device features!");
+    }
+    size_t dropped = 0;
+    mEnabledDeviceFeatures = vkutils::DeviceFeatureSet::intersect(requested, available, &dropped);
+    if(dropped > 0){
+        std::cerr << "Warning: " << dropped << " requested device features are unavailable and will not be enabled" << std::endl;
+    }
+    mEnabledDeviceFeatures.merge(required);
+
+    mBindlessEnabled = false;
+    if(isBindlessRequested()){
+        vkutils::DeviceFeatureSet bindless(instanceApiVersion);
+        request_bindless_features(bindless);
+        vkutils::DeviceFeatureSet::intersect(bindless, mEnabledDeviceFeatures, &missing);
+        mBindlessEnabled = (missing == 0);
+        if(!mBindlessEnabled){
+            std::cerr << "Warning: Bindless was requested, but the device lacks the required descriptor indexing features" << std::endl;
+        }
+    }
+
+    for(const std::string& ext : mEnabledDeviceFeatures.getRequiredExtensions()){
+        if(std::find(deviceExtensions.begin(), deviceExtensions.end(), ext) == deviceExtensions.end()){
+            deviceExtensions.emplace_back(ext);
+        }
+    }
+
+    if(mHeadless){
+        mDeviceBundle.logicalDevice = mDeviceBundle.physicalDevice.createDevice(
+            VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT, vkutils::strings_to_cstrs(deviceExtensions),
+            VK_NULL_HANDLE, mEnabledDeviceFeatures.getChain(), getQueueSelectionPolicy(), mEnabledDeviceFeatures.getEnabledFeatures()
+        );
+    }else{
+        mDeviceBundle.logicalDevice = mDeviceBundle.physicalDevice.createPresentableCoreDevice(
+            mVkSurface, vkutils::strings_to_cstrs(deviceExtensions), mEnabledDeviceFeatures.getChain(), getQueueSelectionPolicy(),
+            mEnabledDeviceFeatures.getEnabledFeatures()
+        );
+    }
 }
 
 void VulkanSetupBaseApp::initPresentationSurface(){
+    if(mHeadless) return;
     if(glfwCreateWindowSurface(mVkInstance, mWindow, nullptr, &mVkSurface) != VK_SUCCESS){
         throw std::runtime_error("Unable to create presentable surface on GLFW window!");
     }
 }
 
 void VulkanSetupBaseApp::initSwapchain(){
+    CPU_PROFILE_ZONE("VulkanSetupBaseApp::initSwapchain");
+    if(mHeadless){
+        initOffscreenTargets();
+        return;
+    }
+
     SwapChainSupportInfo chainInfo = mDeviceBundle.physicalDevice.getSwapChainSupportInfo(mVkSurface);
     if(chainInfo.formats.empty() || chainInfo.presentation_modes.empty()){
         throw std::runtime_error("The selected physical device does not support presentation!");
     }
 
     mSwapchainBundle.surface_format = selectSurfaceFormat(chainInfo.formats);
-    if(mDeviceBundle.physicalDevice.mProperites.vendorID == NVIDIA_VENDOR_ID){
+    const std::vector<VkPresentModeKHR>& modes = chainInfo.presentation_modes;
+    if(std::find(modes.begin(), modes.end(), mFramePacing.preferredPresentMode) != modes.end()){
+        // An explicitly chosen mode also overrides the Nvidia workaround below
+        mSwapchainBundle.presentation_mode = mFramePacing.preferredPresentMode;
+    }else if(mDeviceBundle.physicalDevice.mProperites.vendorID == NVIDIA_VENDOR_ID && std::find(modes.begin(), modes.end(), VK_PRESENT_MODE_IMMEDIATE_KHR) != modes.end()){
         // Nvidia has a nasty bug on systems using Nvidia prime sync that causes FIFO present modes 
-        // to freeze the application and the display in general. For now just fallback to immediate mode.
-        fprintf(stderr, "Warning: Nvidia device detected. Forcing use of immediate present mode.\n");
+        // to freeze the application and the display in general. Fallback to immediate mode unless asked otherwise.
+        fprintf(stderr, "Warning: Nvidia device detected. Defaulting to immediate present mode.\n");
         mSwapchainBundle.presentation_mode = VK_PRESENT_MODE_IMMEDIATE_KHR;
     }else{
         mSwapchainBundle.presentation_mode = selectPresentationMode(chainInfo.presentation_modes);
@@ -268,19 +413,26 @@ void VulkanSetupBaseApp::initSwapchain(){
     mSwapchainBundle.extent = mViewportExtent;
 
     if(chainInfo.capabilities.maxImageCount == 0){
-        mSwapchainBundle.requested_image_count = chainInfo.capabilities.minImageCount + 1;
+        mSwapchainBundle.requested_image_count = chainInfo.capabilities.minImageCount + mFramePacing.extraSwapchainImages;
     }else{
-        mSwapchainBundle.requested_image_count = std::min(chainInfo.capabilities.minImageCount + 1, chainInfo.capabilities.maxImageCount);
+        mSwapchainBundle.requested_image_count = std::min(chainInfo.capabilities.minImageCount + mFramePacing.extraSwapchainImages, chainInfo.capabilities.maxImageCount);
     }
 
     std::vector<uint32_t> queueFamilyIndices;
-    if(mDeviceBundle.physicalDevice.coreFeaturesIdx || mDeviceBundle.physicalDevice.mGraphicsIdx == *mDeviceBundle.physicalDevice.getPresentableQueueIndex(mVkSurface)){
+    const QueueAllocator& queues = mDeviceBundle.logicalDevice.getQueueAllocator();
+    if(*queues.getFamilyIndex(QUEUE_ROLE_GRAPHICS) == *queues.getPresentFamilyIndex()){
         // Leave it empty
     }else{
-        queueFamilyIndices.emplace_back(*mDeviceBundle.physicalDevice.mGraphicsIdx);
-        queueFamilyIndices.emplace_back(*mDeviceBundle.physicalDevice.getPresentableQueueIndex(mVkSurface));
+        queueFamilyIndices.emplace_back(*queues.getFamilyIndex(QUEUE_ROLE_GRAPHICS));
+        queueFamilyIndices.emplace_back(*queues.getPresentFamilyIndex());
     }
     
+    // Allow copying images out for frame readback where the surface permits it
+    mSwapchainBundle.image_usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    if(chainInfo.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT){
+        mSwapchainBundle.image_usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+
     VkSwapchainCreateInfoKHR createInfo;
     {
         createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -292,7 +444,7 @@ void VulkanSetupBaseApp::initSwapchain(){
         createInfo.imageColorSpace = mSwapchainBundle.surface_format.colorSpace;
         createInfo.imageExtent = mSwapchainBundle.extent;
         createInfo.imageArrayLayers = 1;
-        createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        createInfo.imageUsage = mSwapchainBundle.image_usage;
         createInfo.imageSharingMode = queueFamilyIndices.empty() ? VK_SHARING_MODE_EXCLUSIVE : VK_SHARING_MODE_CONCURRENT;
         createInfo.queueFamilyIndexCount = queueFamilyIndices.size();
         createInfo.pQueueFamilyIndices = queueFamilyIndices.data();
@@ -300,10 +452,17 @@ void VulkanSetupBaseApp::initSwapchain(){
         createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
         createInfo.presentMode = mSwapchainBundle.presentation_mode;
         createInfo.clipped = VK_TRUE;
-        createInfo.oldSwapchain = VK_NULL_HANDLE;
+        createInfo.oldSwapchain = mSwapchainBundle.swapchain;
     }
 
-    if(vkCreateSwapchainKHR(mDeviceBundle.logicalDevice.handle(), &createInfo, nullptr, &mSwapchainBundle.swapchain) != VK_SUCCESS){
+    // The old swapchain is retired by the create call whether or not it succeeds
+    VkSwapchainKHR oldSwapchain = mSwapchainBundle.swapchain;
+    VkResult result = vkCreateSwapchainKHR(mDeviceBundle.logicalDevice.handle(), &createInfo, nullptr, &mSwapchainBundle.swapchain);
+    if(oldSwapchain != VK_NULL_HANDLE){
+        vkDestroySwapchainKHR(mDeviceBundle.logicalDevice.handle(), oldSwapchain, nullptr);
+    }
+    if(result != VK_SUCCESS){
+        mSwapchainBundle.swapchain = VK_NULL_HANDLE;
         throw std::runtime_error("Unable to create swapchain!");
     }
 
@@ -314,6 +473,122 @@ void VulkanSetupBaseApp::initSwapchain(){
     initSwapchainViews();
 }
 
+void VulkanSetupBaseApp::recreateSwapchain(){
+    if(mHeadless){
+        cleanupOffscreenTargets();
+        initOffscreenTargets();
+        return;
+    }
+    for(const VkImageView& view : mSwapchainBundle.views){
+        vkDestroyImageView(mDeviceBundle.logicalDevice.handle(), view, nullptr);
+    }
+    mSwapchainBundle.views.clear();
+    initSwapchain();
+}
+
+std::vector<VkPresentModeKHR> VulkanSetupBaseApp::getSupportedPresentModes() const{
+    if(mHeadless) return(std::vector<VkPresentModeKHR>());
+    return(mDeviceBundle.physicalDevice.getSwapChainSupportInfo(mVkSurface).presentation_modes);
+}
+
+void VulkanSetupBaseApp::initOffscreenTargets(){
+    // Images are never presented, so any color attachment format works. B8G8R8A8_UNORM matches common surfaces. 
+    mSwapchainBundle.swapchain = VK_NULL_HANDLE;
+    mSwapchainBundle.surface_format = {VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR};
+    mSwapchainBundle.presentation_mode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+    mSwapchainBundle.final_layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    mSwapchainBundle.extent = mViewportExtent;
+
+    // Images are used round robin, so one per frame in flight guarantees an image is free when its turn comes
+    mSwapchainBundle.requested_image_count = std::max(mFramePacing.framesInFlight, 1U) + mFramePacing.extraSwapchainImages;
+    mSwapchainBundle.image_count = mSwapchainBundle.requested_image_count;
+    mSwapchainBundle.images.assign(mSwapchainBundle.image_count, VK_NULL_HANDLE);
+    mOffscreenMemory.assign(mSwapchainBundle.image_count, VK_NULL_HANDLE);
+    mSwapchainBundle.image_usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+    VkDevice device = mDeviceBundle.logicalDevice.handle();
+    VkPhysicalDeviceMemoryProperties memoryProps;
+    vkGetPhysicalDeviceMemoryProperties(mDeviceBundle.physicalDevice.handle(), &memoryProps);
+
+    for(uint32_t i = 0; i < mSwapchainBundle.image_count; ++i){
+        VkImageCreateInfo imageInfo;
+        {
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.pNext = nullptr;
+            imageInfo.flags = 0;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.format = mSwapchainBundle.surface_format.format;
+            imageInfo.extent = {mSwapchainBundle.extent.width, mSwapchainBundle.extent.height, 1};
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.usage = mSwapchainBundle.image_usage;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.queueFamilyIndexCount = 0;
+            imageInfo.pQueueFamilyIndices = nullptr;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        }
+        if(vkCreateImage(device, &imageInfo, nullptr, &mSwapchainBundle.images[i]) != VK_SUCCESS){
+            throw std::runtime_error("Failed to create offscreen image " + std::to_string(i));
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(device, mSwapchainBundle.images[i], &memRequirements);
+
+        // Prefer device local memory, but take any compatible type. CPU implementations may not distinguish. 
+        uint32_t memTypeIndex = VK_MAX_MEMORY_TYPES;
+        for(uint32_t j = 0; j < memoryProps.memoryTypeCount; ++j){
+            if(!(memRequirements.memoryTypeBits & (1 << j))) continue;
+            if(memTypeIndex == VK_MAX_MEMORY_TYPES || memoryProps.memoryTypes[j].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT){
+                memTypeIndex = j;
+                if(memoryProps.memoryTypes[j].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) break;
+            }
+        }
+        if(memTypeIndex == VK_MAX_MEMORY_TYPES){
+            throw std::runtime_error("No compatible memory type could be found for offscreen images!");
+        }
+
+        VkMemoryAllocateInfo allocInfo = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, nullptr, memRequirements.size, memTypeIndex};
+        if(vkAllocateMemory(device, &allocInfo, nullptr, &mOffscreenMemory[i]) != VK_SUCCESS){
+            throw std::runtime_error("Failed to allocate memory for offscreen image " + std::to_string(i));
+        }
+        count_device_allocation(memRequirements.size);
+        vkBindImageMemory(device, mSwapchainBundle.images[i], mOffscreenMemory[i], 0);
+    }
+
+    initSwapchainViews();
+}
+
+void VulkanSetupBaseApp::cleanupOffscreenTargets(){
+    VkDevice device = mDeviceBundle.logicalDevice.handle();
+    for(const VkImageView& view : mSwapchainBundle.views){
+        vkDestroyImageView(device, view, nullptr);
+    }
+    mSwapchainBundle.views.clear();
+    for(const VkImage& image : mSwapchainBundle.images){
+        vkDestroyImage(device, image, nullptr);
+    }
+    mSwapchainBundle.images.clear();
+    for(const VkDeviceMemory& memory : mOffscreenMemory){
+        vkFreeMemory(device, memory, nullptr);
+    }
+    mOffscreenMemory.clear();
+    mSwapchainBundle.image_count = 0;
+}
+
+const char* VulkanSetupBaseApp::getPresentModeName(VkPresentModeKHR aMode){
+    switch(aMode){
+        case VK_PRESENT_MODE_IMMEDIATE_KHR: return("IMMEDIATE");
+        case VK_PRESENT_MODE_MAILBOX_KHR: return("MAILBOX");
+        case VK_PRESENT_MODE_FIFO_KHR: return("FIFO");
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return("FIFO_RELAXED");
+        case VK_PRESENT_MODE_SHARED_DEMAND_REFRESH_KHR: return("SHARED_DEMAND_REFRESH");
+        case VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR: return("SHARED_CONTINUOUS_REFRESH");
+        default: return("UNKNOWN");
+    }
+}
+
 void VulkanSetupBaseApp::initSwapchainViews(){
     mSwapchainBundle.views.resize(mSwapchainBundle.image_count);
     for(size_t i = 0; i < mSwapchainBundle.image_count; ++i){
@@ -383,18 +658,28 @@ const VkExtent2D VulkanSetupBaseApp::selectSwapChainExtent(const VkSurfaceCapabi
 
 void VulkanSetupBaseApp::cleanup(){
     cleanupSwapchain();
-    vkDestroySurfaceKHR(mVkInstance, mVkSurface, nullptr);
+    if(mVkSurface != VK_NULL_HANDLE){
+        vkDestroySurfaceKHR(mVkInstance, mVkSurface, nullptr);
+    }
     vkDestroyDevice(mDeviceBundle.logicalDevice.handle(), nullptr);
     vkDestroyInstance(mVkInstance, nullptr);
-    glfwDestroyWindow(mWindow);
-    glfwTerminate();
+    if(!mHeadless){
+        glfwDestroyWindow(mWindow);
+        glfwTerminate();
+    }
 }
 
 void VulkanSetupBaseApp::cleanupSwapchain(){
+    if(mHeadless){
+        cleanupOffscreenTargets();
+        return;
+    }
     for(const VkImageView& view : mSwapchainBundle.views){
         vkDestroyImageView(mDeviceBundle.logicalDevice.handle(), view, nullptr);
     }
+    mSwapchainBundle.views.clear();
     vkDestroySwapchainKHR(mDeviceBundle.logicalDevice.handle(), mSwapchainBundle.swapchain, nullptr);
+    mSwapchainBundle.swapchain = VK_NULL_HANDLE;
 }
 
 static bool confirm_queue_fam(VkPhysicalDevice aDevice, uint32_t aBitmask){
@@ -465,3 +750,14 @@ static VkPhysicalDevice select_physical_device(const std::vector<VkPhysicalDevic
     }
     
 }
+
+static void request_bindless_features(vkutils::DeviceFeatureSet& aFeatures){
+    // Only the descriptor indexing features the bindless table relies on
+    VkPhysicalDeviceVulkan12Features& features = aFeatures.vulkan12();
+    features.runtimeDescriptorArray = VK_TRUE;
+    features.descriptorBindingPartiallyBound = VK_TRUE;
+    features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+    features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    features.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+    features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+}
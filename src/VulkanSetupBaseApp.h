@@ -8,6 +8,26 @@
 #include <vector>
 #include <unordered_map>
 #include "vkutils/vkutils.h"
+#include "vkutils/DeviceFeatureSet.h"
+
+/// Named trade-offs between input-to-display latency and throughput
+enum LatencyModeEnum{
+    LATENCY_MODE_LOW,         // 1 frame in flight, minimum swapchain images, mailbox present mode when available
+    LATENCY_MODE_BALANCED,    // 2 frames in flight, one swapchain image beyond the minimum
+    LATENCY_MODE_THROUGHPUT   // 3 frames in flight, two swapchain images beyond the minimum
+};
+
+/// Depth of the CPU-to-display frame queue
+struct FramePacingConfig
+{
+    uint32_t framesInFlight = 2;
+    /// Swapchain images requested beyond the surface's minImageCount, clamped to its maxImageCount
+    uint32_t extraSwapchainImages = 1;
+    /// Present mode to use when the surface supports it. VK_PRESENT_MODE_MAX_ENUM_KHR defers to selectPresentationMode().
+    VkPresentModeKHR preferredPresentMode = VK_PRESENT_MODE_MAX_ENUM_KHR;
+
+    static FramePacingConfig fromLatencyMode(LatencyModeEnum aMode);
+};
 
 class VulkanSetupBaseApp{
  public:
@@ -15,13 +35,25 @@ class VulkanSetupBaseApp{
     void init();
     void cleanup();
 
+    /** Run without GLFW, a window or a surface, rendering into a ring of offscreen images that stands in for the 
+     * swapchain at aExtent. Must be called before init(). Works with CPU implementations such as lavapipe. 
+    */
+    void setHeadless(bool aHeadless, const VkExtent2D& aExtent = {854, 480});
+    bool isHeadless() const {return(mHeadless);}
+
     struct WindowFlags
     {
         bool resized = false;
         bool iconified = false;
         bool focus = true;
+        bool cyclePresentMode = false; // Set when P is pressed, cleared by whoever handles it
+        bool captureCpuTrace = false; // Set when T is pressed, cleared by whoever handles it
+        bool eventReceived = false; // Set by any input or window event, cleared once a frame is rendered
     };
 
+    /// Printable name of a present mode, e.g. "FIFO" or "MAILBOX"
+    static const char* getPresentModeName(VkPresentModeKHR aMode);
+
     static std::unordered_map<GLFWwindow*, WindowFlags> sWindowFlags;
 
  protected:
@@ -34,6 +66,12 @@ class VulkanSetupBaseApp{
     void initVkDevices();
     void initSwapchain();
     void initSwapchainViews();
+    /// Recreate the swapchain with the current settings, handing the old one to the driver as oldSwapchain. 
+    /// The device must be idle and anything referencing the old swapchain images destroyed beforehand. 
+    void recreateSwapchain();
+    /// Create and destroy the offscreen images used in place of a swapchain when headless
+    void initOffscreenTargets();
+    void cleanupOffscreenTargets();
 
     void cleanupSwapchain();
 
@@ -50,25 +88,54 @@ class VulkanSetupBaseApp{
     virtual const std::vector<std::string>& getRequestedInstanceExtensions() const;
     virtual const std::vector<std::string>& getRequiredDeviceExtensions() const;
     virtual const std::vector<std::string>& getRequestedDeviceExtensions() const;
+    /// Queue families and number of queues to create for graphics, compute and transfer work
+    virtual const QueueSelectionPolicy& getQueueSelectionPolicy() const;
+    /** Device features, set through the core and Vulkan 1.1-1.3 structs of aFeatures. Device creation fails if a 
+     * required feature is missing, while requested features are only enabled if the device supports them. 
+     * The set actually enabled is available afterwards from getEnabledDeviceFeatures().
+    */
+    virtual void requireDeviceFeatures(vkutils::DeviceFeatureSet& aFeatures) const;
+    virtual void requestDeviceFeatures(vkutils::DeviceFeatureSet& aFeatures) const;
+    /// Override to return true to enable descriptor indexing for a bindless descriptor table, if the device supports it
+    virtual bool isBindlessRequested() const {return(false);}
     // Functions used to determine swap chain configuration
     virtual const VkSurfaceFormatKHR selectSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& aFormats) const;
     virtual const VkPresentModeKHR selectPresentationMode(const std::vector<VkPresentModeKHR>& aModes) const;
     virtual const VkExtent2D selectSwapChainExtent(const VkSurfaceCapabilitiesKHR& aCapabilities) const;
 
+    const FramePacingConfig& getFramePacing() const {return(mFramePacing);}
+
+    /// Present modes supported by the device for the window surface
+    std::vector<VkPresentModeKHR> getSupportedPresentModes() const;
+    /// Present mode of the current swapchain
+    VkPresentModeKHR getPresentMode() const {return(mSwapchainBundle.presentation_mode);}
+
     const std::unordered_map<std::string, bool>& getValidationLayersState() const;
     const std::unordered_map<std::string, bool>& getExtensionState() const; 
 
+    const vkutils::DeviceFeatureSet& getEnabledDeviceFeatures() const {return(mEnabledDeviceFeatures);}
+
+    /// True if bindless was requested and the device was created with the descriptor indexing features it needs
+    bool isBindlessEnabled() const {return(mBindlessEnabled);}
+
     GLFWwindow* mWindow = nullptr;
 
     VkExtent2D mViewportExtent = {854, 480};
 
-    VkInstance mVkInstance;
+    VkInstance mVkInstance = VK_NULL_HANDLE;
     VulkanDeviceBundle mDeviceBundle;
-    VkSurfaceKHR mVkSurface;
+    VkSurfaceKHR mVkSurface = VK_NULL_HANDLE;
     VkQueue mGraphicsQueue;
     VkQueue mPresentationQueue;
 
     vkutils::VulkanSwapchainBundle mSwapchainBundle;
+    FramePacingConfig mFramePacing;
+
+    bool mHeadless = false;
+    std::vector<VkDeviceMemory> mOffscreenMemory; // Backs the swapchain bundle's images when headless
+
+    vkutils::DeviceFeatureSet mEnabledDeviceFeatures;
+    bool mBindlessEnabled = false;
 
  private:
 
@@ -1,6 +1,9 @@
 #include "UniformBuffer.h"
+#include "utils/CpuProfiler.h"
+#include "utils/TransferCounters.h"
 #include <iostream>
 #include <cstring>
+#include <string>
 
 UniformBuffer::UniformBuffer(const VulkanDeviceBundle& aDeviceBundle){
     if(aDeviceBundle.isValid()){
@@ -32,6 +35,30 @@ void UniformBuffer::bindUniformData(uint32_t aBindPoint, UniformDataInterfacePtr
     mLayoutOutOfDate = true;
 }
 
+size_t UniformBuffer::getBoundDataSize(uint32_t aBindPoint) const {
+    auto findBound = mBoundUniformData.find(aBindPoint);
+    if(findBound == mBoundUniformData.end()) return(0U);
+    return(findBound->second.mDataInterface->getDataSize());
+}
+
+void UniformBuffer::setBindingStageFlags(uint32_t aBindPoint, VkShaderStageFlags aStageFlags){
+    auto findBound = mBoundUniformData.find(aBindPoint);
+    if(findBound == mBoundUniformData.end()){
+        throw std::runtime_error("UniformBuffer::setBindingStageFlags() Error: No uniform data is bound at binding " + std::to_string(aBindPoint));
+    }
+    if(findBound->second.mLayoutBinding.stageFlags == aStageFlags) return;
+
+    findBound->second.mLayoutBinding.stageFlags = aStageFlags;
+    if(mDeviceSyncState == DEVICE_IN_SYNC) mDeviceSyncState = DEVICE_OUT_OF_SYNC;
+    mLayoutOutOfDate = true;
+}
+
+VkShaderStageFlags UniformBuffer::getBindingStageFlags(uint32_t aBindPoint) const {
+    auto findBound = mBoundUniformData.find(aBindPoint);
+    if(findBound == mBoundUniformData.end()) return(0);
+    return(findBound->second.mLayoutBinding.stageFlags);
+}
+
 bool UniformBuffer::isBoundDataDirty() const {
     bool result = false;
     for(const std::pair<const uint32_t, BoundUniformData>& boundData : mBoundUniformData){
@@ -54,6 +81,7 @@ DeviceSyncStateEnum UniformBuffer::getDeviceSyncState() const {
 }
 
 void UniformBuffer::updateDevice(const VulkanDeviceBundle& aDeviceBundle){
+    CPU_PROFILE_ZONE("UniformBuffer::updateDevice");
     if(aDeviceBundle.isValid() && aDeviceBundle != mCurrentDevice){
         _cleanup();
         mCurrentDevice = VulkanDeviceHandlePair(aDeviceBundle); 
@@ -89,19 +117,33 @@ size_t UniformBuffer::getBoundDataOffset(uint32_t aBindPoint) const{
 }
 
 std::vector<VkDescriptorBufferInfo> UniformBuffer::getDescriptorBufferInfos() const {
-    std::vector<VkDescriptorBufferInfo> bufferInfos;
-    bufferInfos.reserve(mBoundUniformData.size());
+    std::vector<VkDescriptorBufferInfo> bufferInfos(mBoundUniformData.size());
+    writeDescriptorBufferInfos(bufferInfos.data());
+    return(bufferInfos);
+}
 
+size_t UniformBuffer::writeDescriptorBufferInfos(VkDescriptorBufferInfo* aInfosOut, size_t aStride) const {
+    uint8_t* outPtr = reinterpret_cast<uint8_t*>(aInfosOut);
     size_t offset = 0;
-    for(const std::pair<uint32_t, BoundUniformData>& boundData : mBoundUniformData){
-        bufferInfos.emplace_back(VkDescriptorBufferInfo{
+    for(const std::pair<const uint32_t, BoundUniformData>& boundData : mBoundUniformData){
+        *reinterpret_cast<VkDescriptorBufferInfo*>(outPtr) = VkDescriptorBufferInfo{
             /* buffer = */ mUniformBuffer,
             /* offset = */ offset,
             /* range = */ boundData.second.mDataInterface->getDataSize()
-        });
+        };
+        outPtr += aStride;
         offset += boundData.second.mDataInterface->getPaddedDataSize(mBufferAlignmentSize);
     }
-    return(bufferInfos);
+    return(mBoundUniformData.size());
+}
+
+std::vector<VkDescriptorSetLayoutBinding> UniformBuffer::getLayoutBindings() const {
+    std::vector<VkDescriptorSetLayoutBinding> bindings;
+    bindings.reserve(mBoundUniformData.size());
+    for(const std::pair<const uint32_t, BoundUniformData>& boundData : mBoundUniformData){
+        bindings.emplace_back(boundData.second.mLayoutBinding);
+    }
+    return(bindings);
 }
 
 std::vector<uint32_t> UniformBuffer::getBoundPoints() const {
@@ -114,11 +156,7 @@ std::vector<uint32_t> UniformBuffer::getBoundPoints() const {
 }
 
 void UniformBuffer::createDescriptorSetLayout(){
-    std::vector<VkDescriptorSetLayoutBinding> bindings;
-    bindings.reserve(mBoundUniformData.size());
-    for(const std::pair<uint32_t, BoundUniformData>& boundData : mBoundUniformData){
-        bindings.emplace_back(boundData.second.mLayoutBinding);
-    }
+    std::vector<VkDescriptorSetLayoutBinding> bindings = getLayoutBindings();
 
     VkDescriptorSetLayoutCreateInfo createInfo;
     {
@@ -129,6 +167,11 @@ void UniformBuffer::createDescriptorSetLayout(){
         createInfo.pBindings = bindings.data();
     }
 
+    if(mDescriptorSetLayout != VK_NULL_HANDLE){
+        vkDestroyDescriptorSetLayout(mCurrentDevice.device, mDescriptorSetLayout, nullptr);
+        mDescriptorSetLayout = VK_NULL_HANDLE;
+    }
+
     if(vkCreateDescriptorSetLayout(mCurrentDevice.device, &createInfo, nullptr, &mDescriptorSetLayout) != VK_SUCCESS){
         throw std::runtime_error("Failed to create descriptor set layout for uniform buffer!");
     }
@@ -208,6 +251,7 @@ void UniformBuffer::uploadToDevice(VulkanDeviceHandlePair aDevicePair){
         if(vkAllocateMemory(aDevicePair.device, &allocInfo, nullptr, &mUniformBufferMemory) != VK_SUCCESS){
             throw std::runtime_error("Failed to allocate memory for uniform buffer!");
         }
+        count_device_allocation(memRequirements.size);
 
         vkBindBufferMemory(aDevicePair.device, mUniformBuffer, mUniformBufferMemory, 0);
     }
@@ -224,6 +268,7 @@ void UniformBuffer::uploadToDevice(VulkanDeviceHandlePair aDevicePair){
             size_t cpySize = boundData.second.mDataInterface->getDataSize();
 
             memcpy(start, data, cpySize);
+            count_device_upload(cpySize);
 
             offset += boundData.second.mDataInterface->getPaddedDataSize(mBufferAlignmentSize);
             boundData.second.mDataInterface->flagAsClean();
@@ -80,6 +80,12 @@ class UniformBuffer : public DeviceSyncedBuffer
 
     virtual void bindUniformData(uint32_t aBindPoint, UniformDataInterfacePtr aUniformData, VkShaderStageFlags aStageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
     virtual size_t getBoundDataCount() const {return(mBoundUniformData.size());}
+    /** Size in bytes of the data bound at aBindPoint, or zero if nothing is bound there.*/
+    virtual size_t getBoundDataSize(uint32_t aBindPoint) const;
+
+    /** Change the shader stages the uniform at aBindPoint is visible to. The descriptor set layout is rebuilt on the next update.*/
+    virtual void setBindingStageFlags(uint32_t aBindPoint, VkShaderStageFlags aStageFlags);
+    virtual VkShaderStageFlags getBindingStageFlags(uint32_t aBindPoint) const;
 
     /** Returns true if any bound uniform data is dirtied.*/
     virtual bool isBoundDataDirty() const;
@@ -93,7 +99,14 @@ class UniformBuffer : public DeviceSyncedBuffer
     virtual size_t getBoundDataOffset(uint32_t aBindPoint) const;
 
     virtual VkDescriptorSetLayout getDescriptorSetLayout() const {return(mDescriptorSetLayout);}
+    /** True if the descriptor set layout will be rebuilt by the next updateDevice() call.*/
+    virtual bool isLayoutOutOfDate() const {return(mLayoutOutOfDate);}
     virtual std::vector<VkDescriptorBufferInfo> getDescriptorBufferInfos() const;
+    /** Write one descriptor buffer info per bound uniform, in bind point order, to aInfosOut without allocating.
+     * aStride is the distance in bytes between consecutive infos. Returns the number of infos written. 
+    */
+    virtual size_t writeDescriptorBufferInfos(VkDescriptorBufferInfo* aInfosOut, size_t aStride = sizeof(VkDescriptorBufferInfo)) const;
+    virtual std::vector<VkDescriptorSetLayoutBinding> getLayoutBindings() const;
     virtual std::vector<uint32_t> getBoundPoints() const; 
 
     virtual const VkBuffer& getBuffer() const override {return(mUniformBuffer);}
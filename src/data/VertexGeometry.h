@@ -3,6 +3,8 @@
 
 #include "utils/common.h"
 #include "DeviceSyncedBuffer.h"
+#include "utils/CpuProfiler.h"
+#include "utils/TransferCounters.h"
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
 #include <iostream>
@@ -54,7 +56,7 @@ class VertexAttributeBuffer : public DeviceSyncedBuffer
     }
 
     virtual size_t vertexCount() const {return(mCpuVertexData.size());}
-    virtual std::vector<VertexType>& getVertices() {return(mCpuVertexData); mDeviceSyncState = DEVICE_OUT_OF_SYNC;}
+    virtual std::vector<VertexType>& getVertices() {mDeviceSyncState = DEVICE_OUT_OF_SYNC; return(mCpuVertexData);}
     virtual const std::vector<VertexType>& getVertices() const {return(getVerticesConst());}
     virtual const std::vector<VertexType>& getVerticesConst() const {return(mCpuVertexData);}
 
@@ -84,6 +86,7 @@ class VertexAttributeBuffer : public DeviceSyncedBuffer
 
 template<typename VertexType> 
 void VertexAttributeBuffer<VertexType>::updateDevice(const VulkanDeviceBundle& aDeviceBundle){
+    CPU_PROFILE_ZONE("VertexAttributeBuffer::updateDevice");
     if(aDeviceBundle.isValid() && aDeviceBundle != mCurrentDevice){
         _cleanup();
         mCurrentDevice = VulkanDeviceHandlePair(aDeviceBundle); 
@@ -158,6 +161,7 @@ void VertexAttributeBuffer<VertexType>::uploadToDevice(VulkanDeviceHandlePair aD
         if(vkAllocateMemory(aDevicePair.device, &allocInfo, nullptr, &mVertexBufferMemory) != VK_SUCCESS){
             throw std::runtime_error("Failed to allocate memory for vertex attribute buffer!");
         }
+        count_device_allocation(memRequirements.size);
 
         vkBindBufferMemory(aDevicePair.device, mVertexBuffer, mVertexBufferMemory, 0);
         mCurrentBufferSize = requiredSize;
@@ -168,6 +172,7 @@ void VertexAttributeBuffer<VertexType>::uploadToDevice(VulkanDeviceHandlePair aD
     if(mapResult != VK_SUCCESS || mappedPtr == nullptr) throw std::runtime_error("Failed to map memory during vertex attribute buffer upload!");
     {
         memcpy(mappedPtr, mCpuVertexData.data(), mCurrentBufferSize);
+        count_device_upload(mCurrentBufferSize);
 
         VkMappedMemoryRange mappedMemRange;
         {
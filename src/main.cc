@@ -1,8 +1,19 @@
 #include "VulkanGraphicsApp.h"
+#include "vkutils/FrameCaptureSink.h"
 #include "data/VertexGeometry.h"
 #include "data/UniformBuffer.h"
 #include "data/VertexInput.h"
 #include "utils/FpsTimer.h"
+#include "utils/FrameLimiter.h"
+#include "utils/BenchmarkReport.h"
+#include "utils/CpuProfiler.h"
+#include "utils/TransferCounters.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <memory> // Include shared_ptr
 #include <glm/gtc/matrix_transform.hpp>
@@ -32,32 +43,177 @@ using UniformAnimationDataPtr = std::shared_ptr<UniformAnimationData>;
 
 static glm::mat4 getOrthographicProjection(const VkExtent2D& frameDim);
 
+struct BenchmarkOptions {
+    uint32_t warmupFrames = 60;
+    uint32_t measuredFrames = 600;
+    bool uncapped = false; // Ignore the frame rate limit and prefer a present mode without vsync
+    std::string outputPath = "-"; // JSON report destination, "-" for stdout
+};
+
 class Application : public VulkanGraphicsApp
 {
  public:
     void init();
     void run();
+    /// Render aFramesPerMode frames in each latency mode, switching modes without restarting, and report 
+    /// throughput against frame completion latency, CPU start to GPU done, for each. 
+    void runLatencyBenchmark(uint32_t aFramesPerMode);
+    /// Render aFrameCount frames without a window, e.g. on machines without a display or GPU
+    void runHeadless(uint32_t aFrameCount);
+    /// Render warmup frames, then measure a fixed number of frames and write a JSON report of their costs
+    void runBenchmark(const BenchmarkOptions& aOptions);
     void cleanup();
 
+    /// Cap the frame rate of run(). 0 renders as fast as possible.
+    void setFrameRateLimit(double aTargetFps) {mFrameLimiter.setTargetFps(aTargetFps);}
+    /// Freeze the animation and only render when input arrives or the window changes
+    void setStaticScene(bool aStatic);
+    /// Read every frame back to the CPU and report how many arrived, as a stand in for video capture
+    void enableFrameReadback();
+    /// Stream every frame to a Y4M or PPM file, or to stdout for piping into an encoder
+    void enableFrameCapture(const vkutils::FrameCaptureConfig& aConfig);
+    /// Write the frame times of run() or runHeadless() to aPath when they finish, as JSON if aPath ends in .json and CSV otherwise
+    void setFrameTimesPath(const std::string& aPath) {mFrameTimesPath = aPath;}
+    /// Time each frame on the GPU with timestamp queries and report the results after running
+    void enableGpuProfiling() {setGpuProfilingEnabled(true);}
+    /// Count primitives and shader invocations of every frame and report them alongside the frame rate
+    void enablePipelineStatistics() {setPipelineStatisticsEnabled(true);}
+    /** Record CPU profiler zones and write them to aPath as a Chrome trace when T is pressed and once done running.
+     * With aSpikeThresholdMs above 0, traces are also written next to aPath for the first few frames slower than it.
+    */
+    void enableCpuTrace(const std::string& aPath, double aSpikeThresholdMs);
+    void exportCpuTrace() const;
+
  protected:
     void initGeometry();
     void initShaders();
     void initUniforms(); 
 
-    void render();
+    /// Update uniforms and geometry for the next frame
+    void updateScene();
+    bool render();
+
+    /// Switch to the next supported present mode among FIFO, FIFO_RELAXED, MAILBOX and IMMEDIATE
+    void cyclePresentMode();
+    void exportFrameTimes(const FpsTimer& aTimer) const;
+    /// Print a summary of each GPU profiler scope, if profiling is enabled
+    void reportGpuTimes() const;
+    /// Print the pipeline statistics of the latest completed frame, if they are being collected
+    void reportPipelineStatistics() const;
 
     glm::vec2 getMousePos();
 
     std::shared_ptr<SimpleVertexBuffer> mGeometry = nullptr;
     UniformTransformDataPtr mTransformUniforms = nullptr;
     UniformAnimationDataPtr mAnimationUniforms = nullptr;
+
+    FrameLimiter mFrameLimiter;
+    std::atomic<uint64_t> mReadbackChecksum{0};
+    vkutils::FrameCaptureSink mCaptureSink;
+    std::string mFrameTimesPath;
+    std::string mCpuTracePath;
 };
 
 
 int main(int argc, char** argv){
+    uint32_t benchmarkFrames = 0;
+    double fpsLimit = 0.0;
+    bool onDemand = false;
+    uint32_t headlessFrames = 0;
+    bool readback = false;
+    bool benchmark = false;
+    std::string frameTimesPath;
+    bool gpuProfile = false;
+    bool pipelineStats = false;
+    std::string cpuTracePath;
+    double cpuTraceSpikeMs = 0.0;
+    BenchmarkOptions benchmarkOptions;
+    std::string capturePath;
+    vkutils::FrameCaptureConfig captureConfig;
+    for(int i = 1; i < argc; ++i){
+        if(std::strcmp(argv[i], "--latency-benchmark") == 0){
+            benchmarkFrames = 600;
+            if(i + 1 < argc && std::atoi(argv[i + 1]) > 0) benchmarkFrames = static_cast<uint32_t>(std::atoi(argv[++i]));
+        }else if(std::strcmp(argv[i], "--fps-limit") == 0 && i + 1 < argc){
+            fpsLimit = std::atof(argv[++i]);
+        }else if(std::strcmp(argv[i], "--on-demand") == 0){
+            onDemand = true;
+        }else if(std::strcmp(argv[i], "--headless") == 0){
+            headlessFrames = 600;
+            if(i + 1 < argc && std::atoi(argv[i + 1]) > 0) headlessFrames = static_cast<uint32_t>(std::atoi(argv[++i]));
+        }else if(std::strcmp(argv[i], "--readback") == 0){
+            readback = true;
+        }else if(std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc){
+            capturePath = argv[++i];
+        }else if(std::strcmp(argv[i], "--capture-block") == 0){
+            captureConfig.overflow = vkutils::CAPTURE_OVERFLOW_BLOCK;
+        }else if(std::strcmp(argv[i], "--benchmark") == 0){
+            benchmark = true;
+            if(i + 1 < argc && std::atoi(argv[i + 1]) > 0) benchmarkOptions.measuredFrames = static_cast<uint32_t>(std::atoi(argv[++i]));
+        }else if(std::strcmp(argv[i], "--warmup") == 0 && i + 1 < argc){
+            benchmarkOptions.warmupFrames = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 0));
+        }else if(std::strcmp(argv[i], "--uncapped") == 0){
+            benchmarkOptions.uncapped = true;
+        }else if(std::strcmp(argv[i], "--benchmark-output") == 0 && i + 1 < argc){
+            benchmarkOptions.outputPath = argv[++i];
+        }else if(std::strcmp(argv[i], "--frame-times") == 0 && i + 1 < argc){
+            frameTimesPath = argv[++i];
+        }else if(std::strcmp(argv[i], "--gpu-profile") == 0){
+            gpuProfile = true;
+        }else if(std::strcmp(argv[i], "--pipeline-stats") == 0){
+            pipelineStats = true;
+        }else if(std::strcmp(argv[i], "--cpu-trace") == 0 && i + 1 < argc){
+            cpuTracePath = argv[++i];
+        }else if(std::strcmp(argv[i], "--cpu-trace-spike") == 0 && i + 1 < argc){
+            cpuTraceSpikeMs = std::atof(argv[++i]);
+            if(cpuTracePath.empty()) cpuTracePath = "cpu_trace.json";
+        }
+    }
+
+    if(capturePath == "-" || (benchmark && benchmarkOptions.outputPath == "-")){
+        // Keep reports out of the video stream or benchmark JSON. Redirected before init(), which already prints, so
+        // nothing written through std::cout can reach fd 1 ahead of the stream. Reports never write to stdout directly.
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
+
+    CPU_PROFILE_THREAD_NAME("Main");
     Application app;
+    if(!cpuTracePath.empty()){
+        // Enabled before init() so startup is traced too
+        app.enableCpuTrace(cpuTracePath, cpuTraceSpikeMs);
+    }
+    app.setFrameRateLimit(fpsLimit);
+    app.setFrameTimesPath(frameTimesPath);
+    if(headlessFrames > 0){
+        app.setHeadless(true);
+    }
     app.init();
-    app.run();
+    app.setStaticScene(onDemand);
+    if(gpuProfile){
+        app.enableGpuProfiling();
+    }
+    if(pipelineStats){
+        app.enablePipelineStatistics();
+    }
+    if(!capturePath.empty()){
+        captureConfig.path = capturePath;
+        const std::string y4m = ".y4m";
+        bool isY4m = capturePath == "-" || (capturePath.size() >= y4m.size() && capturePath.compare(capturePath.size() - y4m.size(), y4m.size(), y4m) == 0);
+        captureConfig.format = isY4m ? vkutils::CAPTURE_FORMAT_Y4M : vkutils::CAPTURE_FORMAT_PPM;
+        app.enableFrameCapture(captureConfig);
+    }else if(readback){
+        app.enableFrameReadback();
+    }
+    if(benchmark){
+        app.runBenchmark(benchmarkOptions);
+    }else if(headlessFrames > 0){
+        app.runHeadless(headlessFrames);
+    }else if(benchmarkFrames > 0){
+        app.runLatencyBenchmark(benchmarkFrames);
+    }else{
+        app.run();
+    }
+    app.exportCpuTrace();
     app.cleanup();
 
     return(0);
@@ -103,28 +259,258 @@ void Application::run(){
     // Run until the application is closed
     while(!glfwWindowShouldClose(mWindow)){
         // Poll for window events, keyboard and mouse button presses, ect...
-        glfwPollEvents();
+        // Sleeps instead while minimized, unfocused, or rendering on demand with nothing to draw
+        waitForEvents();
+        if(sWindowFlags[mWindow].cyclePresentMode){
+            sWindowFlags[mWindow].cyclePresentMode = false;
+            cyclePresentMode();
+            localRenderTimer.reset();
+        }
+        if(sWindowFlags[mWindow].captureCpuTrace){
+            sWindowFlags[mWindow].captureCpuTrace = false;
+            exportCpuTrace();
+        }
+
+        updateScene();
+        if(!isRedrawNeeded() || skipThrottledFrame()) continue;
+
+        // Hold the frame back if running ahead of the frame rate limit
+        mFrameLimiter.wait();
 
         // Render the frame 
         globalRenderTimer.frameStart();
         localRenderTimer.frameStart();
-        render();
+        std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+        if(!VulkanGraphicsApp::render()) continue;
         globalRenderTimer.frameFinish();
         localRenderTimer.frameFinish();
+        CpuProfiler::get().frameFinished(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
 
         // Print out framerate statistics if enough data has been collected 
         if(localRenderTimer.isBufferFull()){
             localRenderTimer.reportAndReset();
+            reportPipelineStatistics();
         }
         ++mFrameNumber;
     }
 
     std::cout << "Average Performance: " << globalRenderTimer.getReportString() << std::endl;
+    std::cout << "Frame completion latency (ms): " << getFrameLatency().summarize().toString() << std::endl;
+    if(mFrameLimiter.isEnabled()){
+        std::cout << "Frame pacing error (ms): " << mFrameLimiter.getPacingErrorSummary().toString() << std::endl;
+    }
+    std::cout << "Skipped frames: " << getSkippedFrameCounts().iconified << " iconified, " 
+              << getSkippedFrameCounts().unfocused << " unfocused" << std::endl;
+    std::cout << "Shader cache: " << getShaderCache().getReportString() << std::endl;
+    reportGpuTimes();
+    reportPipelineStatistics();
+    exportFrameTimes(globalRenderTimer);
     
     // Make sure the GPU is done rendering before moving on. 
     vkDeviceWaitIdle(mDeviceBundle.logicalDevice.handle());
 }
 
+void Application::runHeadless(uint32_t aFrameCount){
+    FpsTimer renderTimer(0);
+    for(uint32_t i = 0; i < aFrameCount; ++i){
+        renderTimer.frameStart();
+        if(!render()) continue;
+        renderTimer.frameFinish();
+        ++mFrameNumber;
+    }
+    waitForFrameValue(getSubmittedFrameValue());
+
+    std::cout << "Headless: " << aFrameCount << " frames at " << getFramebufferSize().width << "x" << getFramebufferSize().height 
+              << ", " << renderTimer.getReportString() << std::endl;
+    std::cout << "Frame completion latency (ms): " << getFrameLatency().summarize().toString() << std::endl;
+    reportGpuTimes();
+    reportPipelineStatistics();
+    exportFrameTimes(renderTimer);
+    vkDeviceWaitIdle(mDeviceBundle.logicalDevice.handle());
+}
+
+void Application::reportGpuTimes() const{
+    for(const std::string& scope : getGpuProfiler().getScopeNames()){
+        std::cout << "GPU " << scope << " (ms): " << getGpuProfiler().summarize(scope).toString() << std::endl;
+    }
+}
+
+void Application::reportPipelineStatistics() const{
+    using namespace vkutils;
+    const uint64_t pixelCount = static_cast<uint64_t>(getFramebufferSize().width) * getFramebufferSize().height;
+    for(const std::pair<std::string, PipelineCounters>& batch : getPipelineStatistics().getLastFrameCounters()){
+        const PipelineCounters& counters = batch.second;
+        std::cout << "Pipeline " << batch.first << ": " << counters[PIPELINE_COUNTER_INPUT_ASSEMBLY_PRIMITIVES] << " primitives, "
+                  << counters[PIPELINE_COUNTER_CLIPPING_PRIMITIVES] << " after clipping, "
+                  << counters[PIPELINE_COUNTER_VERTEX_SHADER_INVOCATIONS] << " vertex invocations (" << counters.verticesPerPrimitive() << " per primitive), "
+                  << counters[PIPELINE_COUNTER_FRAGMENT_SHADER_INVOCATIONS] << " fragment invocations (" << counters.fragmentsPerPixel(pixelCount) << "x overdraw)" << std::endl;
+    }
+}
+
+void Application::enableCpuTrace(const std::string& aPath, double aSpikeThresholdMs){
+    mCpuTracePath = aPath;
+    const std::string json = ".json";
+    std::string spikePrefix = aPath;
+    if(spikePrefix.size() >= json.size() && spikePrefix.compare(spikePrefix.size() - json.size(), json.size(), json) == 0){
+        spikePrefix.erase(spikePrefix.size() - json.size());
+    }
+    CpuProfiler::get().setSpikeCapture(aSpikeThresholdMs, spikePrefix + "_spike");
+    CpuProfiler::get().setEnabled(true);
+#ifndef VULKANBASE_CPU_PROFILER
+    std::cerr << "Warning: Built without VULKANBASE_CPU_PROFILER, so CPU traces will be empty." << std::endl;
+#endif
+}
+
+void Application::exportCpuTrace() const{
+    if(mCpuTracePath.empty()) return;
+    if(CpuProfiler::get().writeChromeTrace(mCpuTracePath)){
+        std::cout << "CPU trace written to " << mCpuTracePath << " (" << CpuProfiler::get().getOverwrittenCount() << " events overwritten)" << std::endl;
+    }else{
+        std::cerr << "Warning: Unable to write CPU trace to " << mCpuTracePath << std::endl;
+    }
+}
+
+void Application::exportFrameTimes(const FpsTimer& aTimer) const{
+    if(mFrameTimesPath.empty()) return;
+    std::ofstream out(mFrameTimesPath, std::ios::out | std::ios::trunc);
+    if(!out){
+        std::cerr << "Warning: Unable to write frame times to " << mFrameTimesPath << std::endl;
+        return;
+    }
+    const std::string json = ".json";
+    if(mFrameTimesPath.size() >= json.size() && mFrameTimesPath.compare(mFrameTimesPath.size() - json.size(), json.size(), json) == 0){
+        out << aTimer.toJson();
+    }else{
+        aTimer.writeCsv(out);
+    }
+}
+
+void Application::cyclePresentMode(){
+    const VkPresentModeKHR cycle[] = {VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR};
+    const size_t cycleLength = sizeof(cycle) / sizeof(cycle[0]);
+
+    size_t current = std::find(cycle, cycle + cycleLength, getPresentMode()) - cycle;
+    for(size_t step = 1; step <= cycleLength; ++step){
+        VkPresentModeKHR next = cycle[(current + step) % cycleLength];
+        if(setPresentMode(next)){
+            std::cout << "Present mode: " << getPresentModeName(next) << std::endl;
+            return;
+        }
+    }
+}
+
+void Application::runLatencyBenchmark(uint32_t aFramesPerMode){
+    const std::pair<LatencyModeEnum, const char*> modes[] = {
+        {LATENCY_MODE_LOW, "low"}, {LATENCY_MODE_BALANCED, "balanced"}, {LATENCY_MODE_THROUGHPUT, "throughput"}
+    };
+
+    // Measure every frame even if the window loses focus
+    BackgroundThrottlePolicy throttlePolicy = getBackgroundThrottlePolicy();
+    setBackgroundThrottlePolicy({false, 0.0});
+
+    const FramePacingConfig pacing = getFramePacing();
+    for(const std::pair<LatencyModeEnum, const char*>& mode : modes){
+        setLatencyMode(mode.first);
+        getFrameLatency().clear();
+
+        auto start = std::chrono::steady_clock::now();
+        uint32_t frames = 0;
+        while(frames < aFramesPerMode && !glfwWindowShouldClose(mWindow)){
+            glfwPollEvents();
+            if(!render()) continue;
+            ++frames;
+            ++mFrameNumber;
+        }
+        // Wait out the frames still in flight so each of them gets a latency sample
+        waitForFrameValue(getSubmittedFrameValue());
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        SampleSummary latency = getFrameLatency().summarize();
+        std::cout << mode.second << ": " << getPresentModeName(getPresentMode()) << ", " << getFramePacing().framesInFlight << " frames in flight, " 
+                  << frames / seconds << " fps, completion latency (ms) " << latency.toString() << std::endl;
+    }
+    applyFramePacing(pacing);
+    setBackgroundThrottlePolicy(throttlePolicy);
+}
+
+void Application::runBenchmark(const BenchmarkOptions& aOptions){
+    using clock = std::chrono::steady_clock;
+    using milliseconds = std::chrono::duration<double, std::milli>;
+
+    setBackgroundThrottlePolicy({false, 0.0});
+    setRenderOnDemand(false);
+    setGpuProfilingEnabled(true);
+    if(aOptions.uncapped){
+        setFrameRateLimit(0.0);
+        if(!isHeadless() && !setPresentMode(VK_PRESENT_MODE_IMMEDIATE_KHR)){
+            setPresentMode(VK_PRESENT_MODE_MAILBOX_KHR);
+        }
+    }
+
+    BenchmarkReport report;
+    auto runFrame = [&](bool aMeasured){
+        if(!isHeadless()) glfwPollEvents();
+        mFrameLimiter.wait();
+        TransferCounters before = get_transfer_counters();
+        clock::time_point start = clock::now();
+        if(!render()) return;
+        double cpuTime = milliseconds(clock::now() - start).count();
+        TransferCounters transfers = get_transfer_counters() - before;
+        ++mFrameNumber;
+        if(!aMeasured) return;
+
+        report.addSample("cpu_frame_ms", cpuTime);
+        report.addSample("submit_ms", getLastFrameCallTimings().submit);
+        if(!isHeadless()) report.addSample("present_ms", getLastFrameCallTimings().present);
+        report.addSample("upload_bytes", static_cast<double>(transfers.uploadBytes));
+        report.addSample("allocations", static_cast<double>(transfers.allocationCount));
+    };
+
+    for(uint32_t i = 0; i < aOptions.warmupFrames && (isHeadless() || !glfwWindowShouldClose(mWindow)); ++i){
+        runFrame(false);
+    }
+    waitForFrameValue(getSubmittedFrameValue());
+    getFrameLatency().clear();
+    getGpuProfiler().clearSamples();
+    getPipelineStatistics().clearSamples();
+
+    clock::time_point start = clock::now();
+    uint32_t frames = 0;
+    for(; frames < aOptions.measuredFrames && (isHeadless() || !glfwWindowShouldClose(mWindow)); ++frames){
+        runFrame(true);
+    }
+    // Wait out the frames still in flight so each of them gets a latency sample
+    waitForFrameValue(getSubmittedFrameValue());
+    double seconds = std::chrono::duration<double>(clock::now() - start).count();
+    // Time from the start of each frame on the CPU until its GPU work was seen complete
+    report.addSamples("frame_completion_ms", getFrameLatency().getSamples());
+    for(const std::string& scope : getGpuProfiler().getScopeNames()){
+        report.addSamples("gpu_" + scope + "_ms", getGpuProfiler().getSamples(scope));
+    }
+    for(const std::string& batch : getPipelineStatistics().getBatchNames()){
+        for(int counter = 0; counter < vkutils::PIPELINE_COUNTER_COUNT; ++counter){
+            vkutils::PipelineCounterEnum id = static_cast<vkutils::PipelineCounterEnum>(counter);
+            report.addSamples(batch + "_" + vkutils::PipelineStatistics::counter_name(id), getPipelineStatistics().getSamples(batch, id));
+        }
+    }
+
+    report.setProperty("device", std::string(mDeviceBundle.physicalDevice.mProperites.deviceName));
+    report.setProperty("headless", isHeadless());
+    report.setProperty("uncapped", aOptions.uncapped);
+    report.setProperty("present_mode", isHeadless() ? "none" : getPresentModeName(getPresentMode()));
+    report.setProperty("width", static_cast<double>(getFramebufferSize().width));
+    report.setProperty("height", static_cast<double>(getFramebufferSize().height));
+    report.setProperty("frames_in_flight", static_cast<double>(getFramePacing().framesInFlight));
+    report.setProperty("warmup_frames", static_cast<double>(aOptions.warmupFrames));
+    report.setProperty("measured_frames", static_cast<double>(frames));
+    report.setProperty("fps", seconds > 0.0 ? frames / seconds : 0.0);
+    report.setProperty("gpu_timestamps", isGpuProfilingEnabled());
+    report.setProperty("pipeline_statistics", isPipelineStatisticsEnabled());
+    report.write(aOptions.outputPath);
+
+    vkDeviceWaitIdle(mDeviceBundle.logicalDevice.handle());
+}
+
 void Application::cleanup(){
     // Deallocate the buffer holding our geometry and delete the buffer
     mGeometry->freeBuffer();
@@ -133,31 +519,85 @@ void Application::cleanup(){
     mTransformUniforms = nullptr;
     mAnimationUniforms = nullptr;
 
+    if(getFrameReadback().isValid()){
+        std::cout << "Frame readback: " << getFrameReadback().getDeliveredFrameCount() << " frames delivered, " 
+                  << getFrameReadback().getDroppedFrameCount() << " dropped, checksum " << mReadbackChecksum << std::endl;
+    }
+    // Stop readback first so no more frames reach the capture sink while it drains
+    disableFrameReadback();
+    if(mCaptureSink.isOpen()){
+        mCaptureSink.close();
+        std::cout << "Frame capture: " << mCaptureSink.getWrittenFrameCount() << " frames written, " 
+                  << mCaptureSink.getDroppedFrameCount() << " dropped" << std::endl;
+    }
+
     VulkanGraphicsApp::cleanup();
 }
 
-void Application::render(){
+void Application::enableFrameReadback(){
+    setFrameReadbackConsumer([this](const vkutils::ReadbackFrame& aFrame){
+        // Touch every byte like an encoder would, without the cost of actually encoding
+        uint64_t sum = 0;
+        for(size_t i = 0; i < aFrame.size; ++i){
+            sum += aFrame.data[i];
+        }
+        mReadbackChecksum += sum;
+    });
+}
+
+void Application::enableFrameCapture(const vkutils::FrameCaptureConfig& aConfig){
+    mCaptureSink.open(aConfig);
+    setFrameReadbackConsumer([this](const vkutils::ReadbackFrame& aFrame){
+        mCaptureSink.push(aFrame);
+    });
+}
+
+void Application::setStaticScene(bool aStatic){
+    setRenderOnDemand(aStatic);
+    if(aStatic){
+        removeAnimation("time");
+    }else{
+        addAnimation("time");
+    }
+}
+
+void Application::updateScene(){
+    CPU_PROFILE_ZONE("Application::updateScene");
 
     // Set the position of the top vertex 
-    if(glfwGetMouseButton(mWindow, GLFW_MOUSE_BUTTON_1) == GLFW_PRESS) {
+    if(!isHeadless() && glfwGetMouseButton(mWindow, GLFW_MOUSE_BUTTON_1) == GLFW_PRESS) {
         glm::vec2 mousePos = getMousePos();
         mGeometry->getVertices()[1].pos = glm::vec3(mousePos, 0.0);
         mGeometry->updateDevice();
         VulkanGraphicsApp::setVertexBuffer(mGeometry->getBuffer(), mGeometry->vertexCount());
     }
 
-    float time = static_cast<float>(glfwGetTime());
+    // Time stands still unless the scene is animated. Headless runs advance a fixed 60 Hz step per frame.
+    float time = 0.0f;
+    if(hasAnimations()){
+        time = isHeadless() ? static_cast<float>(mFrameNumber / 60.0) : static_cast<float>(glfwGetTime());
+    }
     VkExtent2D frameDimensions = getFramebufferSize();
 
-    // Set the value of our uniform variable
-    mTransformUniforms->pushUniformData({
+    // Set the value of our uniform variable. Pushing unchanged values would still flag the uniforms as dirty.
+    Transforms transforms = {
         glm::translate(glm::vec3(.1*cos(time), .1*sin(time), 0.0)),
         getOrthographicProjection(frameDimensions)
-    });
-    mAnimationUniforms->pushUniformData({time});
+    };
+    const Transforms& current = mTransformUniforms->getStructConst();
+    if(transforms.Model != current.Model || transforms.Perspective != current.Perspective){
+        mTransformUniforms->pushUniformData(transforms);
+    }
+    if(mAnimationUniforms->getStructConst().time != time){
+        mAnimationUniforms->pushUniformData({time});
+    }
+}
+
+bool Application::render(){
+    updateScene();
 
     // Tell the GPU to render a frame. 
-    VulkanGraphicsApp::render();
+    return(VulkanGraphicsApp::render());
 }
 
 void Application::initGeometry(){
@@ -200,9 +640,10 @@ void Application::initGeometry(){
 
 void Application::initShaders(){
 
-    // Load the compiled shader code from disk. 
-    VkShaderModule vertShader = vkutils::load_shader_module(mDeviceBundle.logicalDevice.handle(), STRIFY(SHADER_DIR) "/standard.vert.spv");
-    VkShaderModule fragShader = vkutils::load_shader_module(mDeviceBundle.logicalDevice.handle(), STRIFY(SHADER_DIR) "/vertexColor.frag.spv");
+    // Create shader modules from the compiled shader code embedded into the executable at build time. 
+    // Loading through the shader cache shares a single module between any shaders with identical code. 
+    VkShaderModule vertShader = getShaderCache().acquireEmbedded("standard.vert");
+    VkShaderModule fragShader = getShaderCache().acquireEmbedded("vertexColor.frag");
     
     assert(vertShader != VK_NULL_HANDLE);
     assert(fragShader != VK_NULL_HANDLE);
@@ -214,6 +655,8 @@ void Application::initShaders(){
 void Application::initUniforms(){
     mTransformUniforms = UniformTransformData::create();
     mAnimationUniforms = UniformAnimationData::create(); 
+    mTransformUniforms->pushUniformData({glm::mat4(1.0f), glm::mat4(1.0f)});
+    mAnimationUniforms->pushUniformData({0.0f});
     
     VulkanGraphicsApp::addUniform(0, mTransformUniforms);
     VulkanGraphicsApp::addUniform(1, mAnimationUniforms);
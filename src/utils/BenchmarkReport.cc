@@ -0,0 +1,110 @@
+#include "BenchmarkReport.h"
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+std::string json_string(const std::string& aValue){
+    std::string quoted = "\"";
+    for(char c : aValue){
+        switch(c){
+            case '"': quoted += "\\\""; break;
+            case '\\': quoted += "\\\\"; break;
+            case '\n': quoted += "\\n"; break;
+            case '\t': quoted += "\\t"; break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20){
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    quoted += escaped;
+                }else{
+                    quoted += c;
+                }
+        }
+    }
+    return(quoted + "\"");
+}
+
+static void set_encoded(std::vector<std::pair<std::string, std::string>>& aProperties, const std::string& aKey, const std::string& aEncoded){
+    for(std::pair<std::string, std::string>& property : aProperties){
+        if(property.first == aKey){
+            property.second = aEncoded;
+            return;
+        }
+    }
+    aProperties.emplace_back(aKey, aEncoded);
+}
+
+void BenchmarkReport::setProperty(const std::string& aKey, const std::string& aValue){
+    set_encoded(mProperties, aKey, json_string(aValue));
+}
+
+void BenchmarkReport::setProperty(const std::string& aKey, double aValue){
+    std::ostringstream builder;
+    builder << aValue;
+    set_encoded(mProperties, aKey, builder.str());
+}
+
+void BenchmarkReport::setProperty(const std::string& aKey, bool aValue){
+    set_encoded(mProperties, aKey, aValue ? "true" : "false");
+}
+
+std::vector<double>& BenchmarkReport::getMetric(const std::string& aMetric){
+    for(std::pair<std::string, std::vector<double>>& metric : mMetrics){
+        if(metric.first == aMetric) return(metric.second);
+    }
+    mMetrics.emplace_back(aMetric, std::vector<double>());
+    return(mMetrics.back().second);
+}
+
+void BenchmarkReport::addSample(const std::string& aMetric, double aValue){
+    getMetric(aMetric).push_back(aValue);
+}
+
+void BenchmarkReport::addSamples(const std::string& aMetric, const std::vector<double>& aValues){
+    std::vector<double>& samples = getMetric(aMetric);
+    samples.insert(samples.end(), aValues.begin(), aValues.end());
+}
+
+SampleSummary BenchmarkReport::summarize(const std::string& aMetric) const{
+    for(const std::pair<std::string, std::vector<double>>& metric : mMetrics){
+        if(metric.first == aMetric) return(summarize_samples(metric.second));
+    }
+    return(SampleSummary());
+}
+
+std::vector<std::string> BenchmarkReport::getMetricNames() const{
+    std::vector<std::string> names;
+    for(const std::pair<std::string, std::vector<double>>& metric : mMetrics){
+        names.push_back(metric.first);
+    }
+    return(names);
+}
+
+std::string BenchmarkReport::toJson() const{
+    std::ostringstream builder;
+    builder << "{\n  \"properties\": {";
+    for(size_t i = 0; i < mProperties.size(); ++i){
+        builder << (i == 0 ? "\n" : ",\n") << "    " << json_string(mProperties[i].first) << ": " << mProperties[i].second;
+    }
+    builder << (mProperties.empty() ? "},\n" : "\n  },\n");
+    builder << "  \"metrics\": {";
+    for(size_t i = 0; i < mMetrics.size(); ++i){
+        builder << (i == 0 ? "\n" : ",\n") << "    " << json_string(mMetrics[i].first) << ": " << summarize_samples(mMetrics[i].second).toJson();
+    }
+    builder << (mMetrics.empty() ? "}\n" : "\n  }\n") << "}\n";
+    return(builder.str());
+}
+
+void BenchmarkReport::write(const std::string& aPath) const{
+    const std::string json = toJson();
+    // Written to the C stream so the report stays intact if std::cout has been redirected
+    std::FILE* file = aPath == "-" ? stdout : std::fopen(aPath.c_str(), "wb");
+    if(file == nullptr){
+        throw std::runtime_error("BenchmarkReport Error: Unable to open '" + aPath + "' for writing!");
+    }
+    const bool complete = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+    const bool closed = file == stdout ? std::fflush(file) == 0 : std::fclose(file) == 0;
+    if(!closed || !complete){
+        throw std::runtime_error("BenchmarkReport Error: Failed to write '" + aPath + "'!");
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef BENCHMARK_REPORT_H_
+#define BENCHMARK_REPORT_H_
+#include "SampleSummary.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+/** Per-frame measurements of a benchmark run, written out as JSON so results can be compared between builds.
+ * Properties describe the run (resolution, present mode, ...). Each metric is summarized as min, mean, p50,
+ * p95, p99 and max. Properties and metrics are written in the order they were first added.
+*/
+class BenchmarkReport
+{
+ public:
+    void setProperty(const std::string& aKey, const std::string& aValue);
+    void setProperty(const std::string& aKey, const char* aValue) {setProperty(aKey, std::string(aValue));}
+    void setProperty(const std::string& aKey, double aValue);
+    void setProperty(const std::string& aKey, bool aValue);
+
+    void addSample(const std::string& aMetric, double aValue);
+    void addSamples(const std::string& aMetric, const std::vector<double>& aValues);
+    /// An empty summary if the metric has no samples
+    SampleSummary summarize(const std::string& aMetric) const;
+    std::vector<std::string> getMetricNames() const;
+
+    std::string toJson() const;
+    /// Write toJson() to aPath, or to stdout if aPath is "-". Throws if the file can't be written.
+    void write(const std::string& aPath) const;
+
+    void clear() {mProperties.clear(); mMetrics.clear();}
+
+ protected:
+    std::vector<double>& getMetric(const std::string& aMetric);
+
+    std::vector<std::pair<std::string, std::string>> mProperties; // Values are stored JSON encoded
+    std::vector<std::pair<std::string, std::vector<double>>> mMetrics;
+};
+
+/// Quote and escape aValue as a JSON string
+std::string json_string(const std::string& aValue);
+
+#endif
@@ -0,0 +1,168 @@
+#include "CpuProfiler.h"
+#include "BenchmarkReport.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+thread_local CpuProfiler::ThreadRing* CpuProfiler::sThreadRing = nullptr;
+thread_local std::string CpuProfiler::sThreadName;
+
+CpuProfiler& CpuProfiler::get(){
+    static CpuProfiler sProfiler;
+    return(sProfiler);
+}
+
+CpuProfiler::CpuProfiler() : mEpoch(std::chrono::steady_clock::now()) {}
+
+CpuProfiler::~CpuProfiler(){
+    waitForSpikeCapture();
+}
+
+CpuProfiler::ThreadRing& CpuProfiler::getThreadRing(){
+    if(sThreadRing == nullptr){
+        std::lock_guard<std::mutex> lock(mRingMutex);
+        mRings.emplace_back(new ThreadRing(mRingCapacity, static_cast<uint32_t>(mRings.size() + 1)));
+        sThreadRing = mRings.back().get();
+        sThreadRing->name = sThreadName;
+    }
+    return(*sThreadRing);
+}
+
+void CpuProfiler::record(const char* aName, bool aEnd){
+    const uint64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mEpoch).count();
+    ThreadRing& ring = getThreadRing();
+    const uint64_t index = ring.written.load(std::memory_order_relaxed);
+    ring.claimed.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    Event& event = ring.events[index % ring.capacity];
+    event.name.store(aName, std::memory_order_relaxed);
+    event.stamp.store((nanoseconds << 1) | (aEnd ? 1 : 0), std::memory_order_relaxed);
+    ring.written.store(index + 1, std::memory_order_release);
+}
+
+void CpuProfiler::setThreadName(const std::string& aName){
+    sThreadName = aName;
+    if(sThreadRing == nullptr) return;
+    std::lock_guard<std::mutex> lock(mRingMutex);
+    sThreadRing->name = aName;
+}
+
+void CpuProfiler::writeChromeTrace(std::ostream& aOut) const{
+    struct Copied
+    {
+        const char* name;
+        uint64_t stamp;
+    };
+
+    std::lock_guard<std::mutex> lock(mRingMutex);
+    const uint64_t nowNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mEpoch).count();
+    char timestamp[32];
+    auto microseconds = [&timestamp](uint64_t aNanoseconds){
+        std::snprintf(timestamp, sizeof(timestamp), "%.3f", aNanoseconds / 1000.0);
+        return(timestamp);
+    };
+
+    aOut << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    std::vector<Copied> copied;
+    std::vector<const char*> open;
+    for(const std::unique_ptr<ThreadRing>& ring : mRings){
+        if(!ring->name.empty()){
+            aOut << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->threadId
+                 << ",\"args\":{\"name\":" << json_string(ring->name) << "}}";
+            first = false;
+        }
+
+        const uint64_t written = ring->written.load(std::memory_order_acquire);
+        const uint64_t start = std::max(ring->cleared.load(std::memory_order_relaxed), written > ring->capacity ? written - ring->capacity : 0);
+        copied.clear();
+        for(uint64_t i = start; i < written; ++i){
+            const Event& event = ring->events[i % ring->capacity];
+            copied.push_back({event.name.load(std::memory_order_relaxed), event.stamp.load(std::memory_order_relaxed)});
+        }
+        // Anything the owning thread may have started overwriting while it was copied is discarded
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t claimed = ring->claimed.load(std::memory_order_relaxed);
+        const uint64_t firstIntact = std::max(start, claimed > ring->capacity ? claimed - ring->capacity : 0);
+        const size_t skipped = static_cast<size_t>(std::min<uint64_t>(firstIntact - start, copied.size()));
+
+        // End events whose begin has been overwritten are dropped, and zones still open are ended now
+        open.clear();
+        uint64_t lastStamp = 0;
+        for(size_t i = skipped; i < copied.size(); ++i){
+            const bool isEnd = copied[i].stamp & 1;
+            lastStamp = copied[i].stamp >> 1;
+            if(isEnd){
+                if(open.empty()) continue;
+                open.pop_back();
+            }else{
+                open.push_back(copied[i].name);
+            }
+            aOut << (first ? "\n" : ",\n") << "{\"name\":" << json_string(copied[i].name) << ",\"ph\":\"" << (isEnd ? 'E' : 'B')
+                 << "\",\"pid\":1,\"tid\":" << ring->threadId << ",\"ts\":" << microseconds(lastStamp) << "}";
+            first = false;
+        }
+        for(size_t i = open.size(); i > 0; --i){
+            aOut << ",\n{\"name\":" << json_string(open[i - 1]) << ",\"ph\":\"E\",\"pid\":1,\"tid\":" << ring->threadId
+                 << ",\"ts\":" << microseconds(std::max(lastStamp, nowNanoseconds)) << "}";
+        }
+    }
+    aOut << (first ? "]}\n" : "\n]}\n");
+}
+
+bool CpuProfiler::writeChromeTrace(const std::string& aPath) const{
+    std::ofstream out(aPath, std::ios::out | std::ios::trunc);
+    if(!out) return(false);
+    writeChromeTrace(out);
+    return(static_cast<bool>(out));
+}
+
+uint64_t CpuProfiler::getOverwrittenCount() const{
+    std::lock_guard<std::mutex> lock(mRingMutex);
+    uint64_t overwritten = 0;
+    for(const std::unique_ptr<ThreadRing>& ring : mRings){
+        const uint64_t written = ring->written.load(std::memory_order_relaxed);
+        if(written > ring->capacity) overwritten += written - ring->capacity;
+    }
+    return(overwritten);
+}
+
+void CpuProfiler::setSpikeCapture(double aThresholdMs, const std::string& aPathPrefix, uint32_t aMaxCaptures){
+    waitForSpikeCapture();
+    mSpikeThresholdMs = aThresholdMs;
+    mSpikePathPrefix = aPathPrefix;
+    mMaxSpikeCaptures = aMaxCaptures;
+    mSpikeCaptures = 0;
+}
+
+bool CpuProfiler::frameFinished(double aFrameMs){
+    if(mSpikeThresholdMs <= 0.0 || aFrameMs <= mSpikeThresholdMs || mSpikeCaptures >= mMaxSpikeCaptures || !isEnabled()
+       || mSpikeWriting.load(std::memory_order_acquire)){
+        return(false);
+    }
+    const std::string path = mSpikePathPrefix + std::to_string(mSpikeCaptures) + ".json";
+    ++mSpikeCaptures;
+
+    // The previous writer has finished, so joining it doesn't block
+    waitForSpikeCapture();
+    mSpikeWriting.store(true, std::memory_order_relaxed);
+    mSpikeWriter = std::thread([this, path](){
+        if(!writeChromeTrace(path)){
+            std::cerr << "Warning: Unable to write CPU trace to '" << path << "'" << std::endl;
+        }
+        mSpikeWriting.store(false, std::memory_order_release);
+    });
+    return(true);
+}
+
+void CpuProfiler::waitForSpikeCapture(){
+    if(mSpikeWriter.joinable()) mSpikeWriter.join();
+}
+
+void CpuProfiler::clear(){
+    std::lock_guard<std::mutex> lock(mRingMutex);
+    for(const std::unique_ptr<ThreadRing>& ring : mRings){
+        ring->cleared.store(ring->written.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
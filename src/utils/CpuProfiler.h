@@ -0,0 +1,142 @@
+#ifndef CPU_PROFILER_H_
+#define CPU_PROFILER_H_
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** Zone instrumentation, compiled in when VULKANBASE_CPU_PROFILER is defined and compiled out to nothing otherwise.
+ * Zone names must be string literals or otherwise outlive the profiler, since only the pointer is recorded.
+ *
+ *     bool VulkanGraphicsApp::render(){
+ *         CPU_PROFILE_FUNCTION();
+ *         { CPU_PROFILE_ZONE("acquire"); ... }
+ *     }
+*/
+#ifdef VULKANBASE_CPU_PROFILER
+    #define _CPU_PROFILE_CONCAT2(_A, _B) _A##_B
+    #define _CPU_PROFILE_CONCAT(_A, _B) _CPU_PROFILE_CONCAT2(_A, _B)
+    #define CPU_PROFILE_ZONE(_NAME) CpuProfileZone _CPU_PROFILE_CONCAT(_cpuProfileZone, __LINE__)(_NAME)
+    #define CPU_PROFILE_FUNCTION() CPU_PROFILE_ZONE(__func__)
+    #define CPU_PROFILE_THREAD_NAME(_NAME) CpuProfiler::get().setThreadName(_NAME)
+#else
+    #define CPU_PROFILE_ZONE(_NAME)
+    #define CPU_PROFILE_FUNCTION()
+    #define CPU_PROFILE_THREAD_NAME(_NAME)
+#endif
+
+/** Collects begin and end events of named zones from every thread. Each thread writes into its own fixed size ring,
+ * which only that thread writes to, so recording takes no locks and never allocates once the ring exists. When a
+ * ring is full the oldest events are overwritten. The rings are read on demand and written out as Chrome trace
+ * event JSON, which chrome://tracing and the Perfetto UI both open.
+*/
+class CpuProfiler
+{
+ public:
+    static CpuProfiler& get();
+
+    /// Recording is off until enabled, so instrumented builds only pay a flag check per zone
+    void setEnabled(bool aEnabled) {mEnabled.store(aEnabled, std::memory_order_relaxed);}
+    bool isEnabled() const {return(mEnabled.load(std::memory_order_relaxed));}
+    /// Events per thread ring, for threads that haven't recorded anything yet
+    void setRingCapacity(size_t aEvents) {mRingCapacity = aEvents > 0 ? aEvents : 1;}
+
+    void beginZone(const char* aName) {if(isEnabled()) record(aName, false);}
+    void endZone(const char* aName) {if(isEnabled()) record(aName, true);}
+    /// Name shown for the calling thread in the trace. Doesn't allocate the thread's ring if it has none yet.
+    void setThreadName(const std::string& aName);
+
+    /// Write the events still held by every ring as Chrome trace event JSON
+    void writeChromeTrace(std::ostream& aOut) const;
+    /// Returns false if aPath couldn't be written
+    bool writeChromeTrace(const std::string& aPath) const;
+    /// Events lost so far to rings wrapping around
+    uint64_t getOverwrittenCount() const;
+
+    /** Write a trace whenever a frame takes longer than aThresholdMs, at most aMaxCaptures times, to aPathPrefix
+     * followed by the capture number and ".json". A threshold of 0 disables spike captures.
+    */
+    void setSpikeCapture(double aThresholdMs, const std::string& aPathPrefix, uint32_t aMaxCaptures = 4);
+    /** Report a finished frame, and start writing a trace if it was a spike. Returns true if a trace was started.
+     * The trace is written on a worker thread, so the calling thread only pays for starting it. A spike while the
+     * previous trace is still being written isn't captured.
+    */
+    bool frameFinished(double aFrameMs);
+    uint32_t getSpikeCaptureCount() const {return(mSpikeCaptures);}
+    /// Block until the trace started by frameFinished(), if any, has been written
+    void waitForSpikeCapture();
+
+    /// Drop every recorded event, keeping the thread rings and names
+    void clear();
+
+ protected:
+    friend class CpuProfileZone;
+    CpuProfiler();
+    ~CpuProfiler();
+
+    struct Event
+    {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> stamp{0}; // Nanoseconds since the profiler was created, shifted up one with the low bit set for end events
+    };
+
+    struct ThreadRing
+    {
+        ThreadRing(size_t aCapacity, uint32_t aThreadId) : events(new Event[aCapacity]), capacity(aCapacity), threadId(aThreadId) {}
+
+        std::unique_ptr<Event[]> events;
+        const size_t capacity;
+        const uint32_t threadId;
+        // Only advanced by the owning thread. claimed moves before an event is written and written after, so a
+        // reader can tell which of the events it copied may have been overwritten meanwhile.
+        std::atomic<uint64_t> claimed{0};
+        std::atomic<uint64_t> written{0};
+        std::atomic<uint64_t> cleared{0}; // Events before this index were dropped by clear()
+        std::string name;
+    };
+
+    void record(const char* aName, bool aEnd);
+    ThreadRing& getThreadRing();
+
+    // Rings belong to the profiler and outlive their threads, so the pointer never dangles
+    static thread_local ThreadRing* sThreadRing;
+    static thread_local std::string sThreadName; // Applied once the thread's ring is created
+
+    const std::chrono::steady_clock::time_point mEpoch;
+    std::atomic<bool> mEnabled{false};
+    size_t mRingCapacity = 1U << 16;
+
+    mutable std::mutex mRingMutex; // Guards the list of rings and their names, not their events
+    std::vector<std::unique_ptr<ThreadRing>> mRings;
+
+    double mSpikeThresholdMs = 0.0;
+    std::string mSpikePathPrefix;
+    uint32_t mMaxSpikeCaptures = 0;
+    uint32_t mSpikeCaptures = 0;
+    std::thread mSpikeWriter;
+    std::atomic<bool> mSpikeWriting{false};
+};
+
+/** Records a zone for as long as it's in scope. Use CPU_PROFILE_ZONE() rather than this directly so the zone
+ * disappears from builds without the profiler.
+*/
+class CpuProfileZone
+{
+ public:
+    explicit CpuProfileZone(const char* aName) : mName(CpuProfiler::get().isEnabled() ? aName : nullptr) {if(mName) CpuProfiler::get().beginZone(mName);}
+    /// A zone that began is always ended, even if the profiler was disabled meanwhile, so its begin isn't left open
+    ~CpuProfileZone() {if(mName) CpuProfiler::get().record(mName, true);}
+
+    CpuProfileZone(const CpuProfileZone&) = delete;
+    CpuProfileZone& operator=(const CpuProfileZone&) = delete;
+
+ protected:
+    const char* mName; // Null if the profiler was disabled when the zone began
+};
+
+#endif
@@ -1,19 +1,96 @@
 #include "FpsTimer.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 
+const size_t LogHistogram::sBucketCount;
+const size_t FpsTimer::sDefaultRingSize;
+
+size_t LogHistogram::bucket_index(uint64_t aMicroseconds){
+    if(aMicroseconds < 32) return(static_cast<size_t>(aMicroseconds));
+    int msb = 63;
+    while(!(aMicroseconds & (uint64_t(1) << msb))) --msb;
+    // Shift the value down to 16..31 to find its sub-bucket within the power of two
+    const int shift = msb - 4;
+    size_t index = 32 + (shift - 1) * 16 + static_cast<size_t>((aMicroseconds >> shift) - 16);
+    return(std::min(index, sBucketCount - 1));
+}
+
+uint64_t LogHistogram::bucket_lower_bound(size_t aBucket){
+    if(aBucket < 32) return(aBucket);
+    const size_t offset = aBucket - 32;
+    return(static_cast<uint64_t>(offset % 16 + 16) << (offset / 16 + 1));
+}
+
+uint64_t LogHistogram::bucket_upper_bound(size_t aBucket){
+    if(aBucket < 32) return(aBucket + 1);
+    const size_t offset = aBucket - 32;
+    return(static_cast<uint64_t>(offset % 16 + 17) << (offset / 16 + 1));
+}
+
+void LogHistogram::record(uint64_t aMicroseconds){
+    ++mCounts[bucket_index(aMicroseconds)];
+    ++mTotalCount;
+}
+
+void LogHistogram::clear(){
+    mCounts.fill(0);
+    mTotalCount = 0;
+}
+
+double LogHistogram::getPercentile(double aPercentile) const{
+    if(mTotalCount == 0) return(0.0);
+    const double fraction = std::min(std::max(aPercentile, 0.0), 100.0) / 100.0;
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * mTotalCount)));
+    uint64_t seen = 0;
+    for(size_t i = 0; i < sBucketCount; ++i){
+        seen += mCounts[i];
+        if(seen >= rank){
+            if(i < 32) return(static_cast<double>(i));
+            return((bucket_lower_bound(i) + bucket_upper_bound(i)) / 2.0);
+        }
+    }
+    return(static_cast<double>(bucket_lower_bound(sBucketCount - 1)));
+}
+
+FpsTimer::FpsTimer(size_t aTimeBufferSize, double aHitchThresholdMs)
+ : mTimeBufferSize(aTimeBufferSize), mHitchThresholdMs(aHitchThresholdMs)
+{
+    mRecentFrameTimes.resize(aTimeBufferSize > 0 ? aTimeBufferSize : sDefaultRingSize);
+    reset();
+}
+
 void FpsTimer::frameStart(){
     mStartTime = std::chrono::high_resolution_clock::now();
 }
 void FpsTimer::frameFinish(){
     auto finish = std::chrono::high_resolution_clock::now();
-    mTotalTime += finish-mStartTime;
+    addFrameTime(finish-mStartTime);
+}
+
+void FpsTimer::addFrameTime(std::chrono::high_resolution_clock::duration aFrameTime){
+    mTotalTime += aFrameTime;
+    mMinTime = std::min(mMinTime, aFrameTime);
+    mMaxTime = std::max(mMaxTime, aFrameTime);
+
+    const double frameMs = std::chrono::duration<double, std::milli>(aFrameTime).count();
+    mRecentFrameTimes[mRingNext] = frameMs;
+    mRingNext = (mRingNext + 1) % mRecentFrameTimes.size();
+    mHistogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(aFrameTime).count()));
+    if(frameMs > mHitchThresholdMs) ++mHitchCount;
     ++mFrameNumber;
 }
+
 void FpsTimer::reset(){
     mTotalTime = std::chrono::high_resolution_clock::duration(0);
     mFrameNumber = 0;
+    mRingNext = 0;
+    mHistogram.clear();
+    mMinTime = std::chrono::high_resolution_clock::duration::max();
+    mMaxTime = std::chrono::high_resolution_clock::duration(0);
+    mHitchCount = 0;
 }
 
 void FpsTimer::report() const{
@@ -25,6 +102,8 @@ std::string FpsTimer::getReportString() const{
     reportBuilder.setf(std::ios_base::fixed, std::ios_base::floatfield);
     reportBuilder.precision(3);
     reportBuilder << currentFPS() << " fps ("  << currentFrameTime() << " microseconds)";
+    reportBuilder << " | p50 " << getPercentile(50.0) << " | p90 " << getPercentile(90.0) << " | p99 " << getPercentile(99.0)
+                  << " | p99.9 " << getPercentile(99.9) << " ms | " << mHitchCount << " hitches over " << mHitchThresholdMs << " ms";
     return(reportBuilder.str());
 }
 
@@ -35,7 +114,64 @@ double FpsTimer::currentFPS() const{
 
 double FpsTimer::currentFrameTime() const{
     uint64_t totalMicro = std::chrono::duration_cast<std::chrono::microseconds>(mTotalTime).count();
-    double denominator = static_cast<double>(mTimeBufferSize > 0 ? mTimeBufferSize : mFrameNumber);
+    double denominator = static_cast<double>(mFrameNumber);
     double averageFrametimeMicro = static_cast<double>(totalMicro) / denominator;
     return(averageFrametimeMicro);
 }
+
+double FpsTimer::getMinFrameTime() const{
+    if(mFrameNumber == 0) return(0.0);
+    return(std::chrono::duration<double, std::milli>(mMinTime).count());
+}
+
+double FpsTimer::getMaxFrameTime() const{
+    return(std::chrono::duration<double, std::milli>(mMaxTime).count());
+}
+
+std::vector<double> FpsTimer::getRecentFrameTimes() const{
+    const size_t count = std::min(mFrameNumber, mRecentFrameTimes.size());
+    // Once the ring has wrapped the oldest sample is the one about to be overwritten
+    const size_t oldest = mFrameNumber > mRecentFrameTimes.size() ? mRingNext : 0;
+    std::vector<double> ordered;
+    ordered.reserve(count);
+    for(size_t i = 0; i < count; ++i){
+        ordered.push_back(mRecentFrameTimes[(oldest + i) % mRecentFrameTimes.size()]);
+    }
+    return(ordered);
+}
+
+void FpsTimer::writeCsv(std::ostream& aOut) const{
+    const std::vector<double> frameTimes = getRecentFrameTimes();
+    const size_t firstFrame = mFrameNumber - frameTimes.size();
+    aOut << "frame,frame_time_ms\n";
+    for(size_t i = 0; i < frameTimes.size(); ++i){
+        aOut << firstFrame + i << "," << std::setprecision(6) << frameTimes[i] << "\n";
+    }
+}
+
+std::string FpsTimer::toJson() const{
+    std::ostringstream builder;
+    builder.setf(std::ios_base::fixed, std::ios_base::floatfield);
+    builder.precision(4);
+    builder << "{\n  \"frames\": " << mFrameNumber << ",\n"
+            << "  \"mean_ms\": " << (mFrameNumber > 0 ? currentFrameTime() / 1000.0 : 0.0) << ",\n"
+            << "  \"min_ms\": " << getMinFrameTime() << ",\n"
+            << "  \"max_ms\": " << getMaxFrameTime() << ",\n"
+            << "  \"p50_ms\": " << getPercentile(50.0) << ",\n"
+            << "  \"p90_ms\": " << getPercentile(90.0) << ",\n"
+            << "  \"p99_ms\": " << getPercentile(99.0) << ",\n"
+            << "  \"p99_9_ms\": " << getPercentile(99.9) << ",\n"
+            << "  \"hitch_threshold_ms\": " << mHitchThresholdMs << ",\n"
+            << "  \"hitches\": " << mHitchCount << ",\n"
+            << "  \"histogram\": [";
+    // Only buckets that were hit, as [lower bound us, upper bound us, count]
+    bool first = true;
+    for(size_t i = 0; i < LogHistogram::sBucketCount; ++i){
+        if(mHistogram.getBucketCount(i) == 0) continue;
+        builder << (first ? "\n" : ",\n") << "    [" << LogHistogram::bucket_lower_bound(i) << ", "
+                << LogHistogram::bucket_upper_bound(i) << ", " << mHistogram.getBucketCount(i) << "]";
+        first = false;
+    }
+    builder << (first ? "]\n}\n" : "\n  ]\n}\n");
+    return(builder.str());
+}
@@ -1,35 +1,102 @@
 #ifndef FPS_COUNTER_H_
 #define FPS_COUNTER_H_
+#include <array>
 #include <chrono>
+#include <cstdint>
+#include <ostream>
 #include <string>
+#include <vector>
 
+/** Histogram of durations in microseconds with logarithmically sized buckets, in the style of HdrHistogram.
+ * Values below 32us get exact buckets; above that each power of two is split into 16 buckets, so any recorded
+ * value is known to within 6.25%. Storage is a fixed array, so recording never allocates.
+*/
+class LogHistogram
+{
+ public:
+    static const size_t sBucketCount = 32 + 16 * 32;
+
+    void record(uint64_t aMicroseconds);
+    void clear();
+
+    uint64_t getTotalCount() const {return(mTotalCount);}
+    uint64_t getBucketCount(size_t aBucket) const {return(mCounts[aBucket]);}
+
+    /// Value at aPercentile (0 to 100) in microseconds, estimated as the middle of the bucket it falls in
+    double getPercentile(double aPercentile) const;
+
+    static size_t bucket_index(uint64_t aMicroseconds);
+    /// Smallest value in the bucket and one past the largest, in microseconds
+    static uint64_t bucket_lower_bound(size_t aBucket);
+    static uint64_t bucket_upper_bound(size_t aBucket);
+
+ protected:
+    std::array<uint64_t, sBucketCount> mCounts = {};
+    uint64_t mTotalCount = 0;
+};
+
+/** Frame time statistics. Every frame goes into a log bucketed histogram for percentiles over the whole run, and
+ * into a fixed size ring holding the most recent frame times for export. Frames slower than the hitch threshold
+ * are counted separately. Nothing is allocated per frame.
+*/
 class FpsTimer
 {
  public:
-    FpsTimer(size_t aTimeBufferSize = 1024U) : mTimeBufferSize(aTimeBufferSize){}
+    /// aTimeBufferSize frames fill the buffer for isBufferFull() and size the ring of recent frame times.
+    /// 0 never fills, and keeps the most recent sDefaultRingSize frame times.
+    FpsTimer(size_t aTimeBufferSize = 1024U, double aHitchThresholdMs = 50.0);
 
     void frameStart();
     void frameFinish();
-    void reset(); 
+    /// Record a frame measured elsewhere
+    void addFrameTime(std::chrono::high_resolution_clock::duration aFrameTime);
+    void reset();
 
     bool isBufferFull() const {return(mFrameNumber >= mTimeBufferSize);}
     void reportAndReset() {report(); reset();}
     std::string getReportString() const;
-    double currentFPS() const; 
+    double currentFPS() const;
     double currentFrameTime() const;
 
     size_t getFrameNumber() const {return(mFrameNumber);}
 
+    /// Frame time at aPercentile (0 to 100) in milliseconds, e.g. 99.9 for the slowest frame in a thousand
+    double getPercentile(double aPercentile) const {return(mHistogram.getPercentile(aPercentile) / 1000.0);}
+    double getMinFrameTime() const;
+    double getMaxFrameTime() const;
+    const LogHistogram& getHistogram() const {return(mHistogram);}
+
+    void setHitchThreshold(double aMilliseconds) {mHitchThresholdMs = aMilliseconds;}
+    double getHitchThreshold() const {return(mHitchThresholdMs);}
+    uint64_t getHitchCount() const {return(mHitchCount);}
+
+    /// Most recent frame times in milliseconds, oldest first
+    std::vector<double> getRecentFrameTimes() const;
+    /// One "frame,frame_time_ms" row per frame in the ring
+    void writeCsv(std::ostream& aOut) const;
+    /// Summary statistics, hitches and the non-empty histogram buckets
+    std::string toJson() const;
+
+    static const size_t sDefaultRingSize = 4096U;
+
  protected:
     void report() const;
-    
+
     size_t mFrameNumber = 0;
     std::chrono::high_resolution_clock::duration mTotalTime{0U};
     std::chrono::high_resolution_clock::time_point mStartTime;
 
     const size_t mTimeBufferSize;
+
+    std::vector<double> mRecentFrameTimes; // Ring of frame times in milliseconds, allocated up front
+    size_t mRingNext = 0;
+    LogHistogram mHistogram;
+    std::chrono::high_resolution_clock::duration mMinTime;
+    std::chrono::high_resolution_clock::duration mMaxTime{0U};
+    double mHitchThresholdMs;
+    uint64_t mHitchCount = 0;
 };
 
 
 
-#endif
\ No newline at end of file
+#endif
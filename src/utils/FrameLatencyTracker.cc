@@ -0,0 +1,12 @@
+#include "FrameLatencyTracker.h"
+
+void FrameLatencyTracker::frameStarted(uint64_t aFrameValue, clock::time_point aTime){
+    mPending.emplace_back(aFrameValue, aTime);
+}
+
+void FrameLatencyTracker::framesCompleted(uint64_t aFrameValue, clock::time_point aTime){
+    while(!mPending.empty() && mPending.front().first <= aFrameValue){
+        mSamples.add(std::chrono::duration<double, std::milli>(aTime - mPending.front().second).count());
+        mPending.pop_front();
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef FRAME_LATENCY_TRACKER_H_
+#define FRAME_LATENCY_TRACKER_H_
+#include "SampleSummary.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/** Measures how long each frame takes from the start of its CPU work until the CPU observes its GPU work as
+ * complete, by polling or waiting on the frame's fence or timeline value. This is frame completion latency: it
+ * stops once rendering is done and doesn't include the time until the image is shown, which also depends on the
+ * present mode and how many images are queued for presentation. Frames are identified by increasing frame values.
+ * Only the most recent samples are kept, so the tracker can run indefinitely.
+*/
+class FrameLatencyTracker
+{
+ public:
+    using clock = std::chrono::steady_clock;
+
+    FrameLatencyTracker(size_t aSampleCapacity = 4096U) : mSamples(aSampleCapacity) {}
+
+    /// CPU work for the frame with value aFrameValue started at aTime
+    void frameStarted(uint64_t aFrameValue, clock::time_point aTime = clock::now());
+    /// Every frame up to and including aFrameValue was found complete at aTime
+    void framesCompleted(uint64_t aFrameValue, clock::time_point aTime = clock::now());
+    /// Forget frames whose completion will never be observed, e.g. after waiting for the device to go idle
+    void discardPending() {mPending.clear();}
+
+    /// Latencies in milliseconds, oldest first
+    std::vector<double> getSamples() const {return(mSamples.getSamples());}
+    SampleSummary summarize() const {return(mSamples.summarize());}
+    size_t getSampleCount() const {return(mSamples.size());}
+    void clear() {mPending.clear(); mSamples.clear();}
+
+ protected:
+    std::deque<std::pair<uint64_t, clock::time_point>> mPending;
+    SampleWindow mSamples;
+};
+
+#endif
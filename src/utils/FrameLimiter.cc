@@ -0,0 +1,65 @@
+#include "FrameLimiter.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+FrameLimiter::FrameLimiter(double aTargetFps){
+    setTargetFps(aTargetFps);
+}
+
+void FrameLimiter::setTargetFps(double aTargetFps){
+    if(aTargetFps <= 0.0){
+        setTargetFrameTime(clock::duration::zero());
+    }else{
+        setTargetFrameTime(std::chrono::nanoseconds(std::llround(1e9 / aTargetFps)));
+    }
+}
+
+void FrameLimiter::setTargetFrameTime(clock::duration aFrameTime){
+    mFrameTime = std::max(aFrameTime, clock::duration::zero());
+    mHasDeadline = false;
+}
+
+void FrameLimiter::wait(){
+    if(!isEnabled()) return;
+
+    clock::time_point now = clock::now();
+    if(!mHasDeadline){
+        // The first frame starts right away
+        mDeadline = now + mFrameTime;
+        mHasDeadline = true;
+        return;
+    }
+
+    // Sleep through all but the expected overshoot, keeping a safety margin for jitter
+    const clock::duration spinMargin = std::chrono::nanoseconds(static_cast<int64_t>(mOvershootMean + 2.0 * mOvershootDeviation));
+    if(mDeadline - now > spinMargin){
+        clock::duration request = mDeadline - now - spinMargin;
+        std::this_thread::sleep_for(request);
+        clock::time_point woke = clock::now();
+        recordSleepOvershoot(woke - now - request);
+        now = woke;
+    }
+    while(now < mDeadline){
+        std::this_thread::yield();
+        now = clock::now();
+    }
+
+    mPacingErrors.add(std::chrono::duration<double, std::milli>(now - mDeadline).count());
+
+    // After a long stall, restart the schedule instead of rendering a burst of frames to catch up
+    mDeadline += mFrameTime;
+    if(now > mDeadline) mDeadline = now + mFrameTime;
+}
+
+double FrameLimiter::getSleepOvershootEstimate() const{
+    return(mOvershootMean * 1e-6);
+}
+
+void FrameLimiter::recordSleepOvershoot(clock::duration aOvershoot){
+    const double weight = 1.0 / 16.0;
+    double sample = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(aOvershoot).count());
+    sample = std::max(sample, 0.0);
+    mOvershootDeviation += weight * (std::fabs(sample - mOvershootMean) - mOvershootDeviation);
+    mOvershootMean += weight * (sample - mOvershootMean);
+}
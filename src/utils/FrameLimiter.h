@@ -0,0 +1,47 @@
+#ifndef FRAME_LIMITER_H_
+#define FRAME_LIMITER_H_
+#include "SampleSummary.h"
+#include <chrono>
+
+/** Caps the frame rate by blocking until each frame's deadline. Most of the wait is an OS sleep, which costs no
+ * CPU but may overshoot. The overshoot seen on recent sleeps is tracked, and that much of the wait is spent
+ * spinning instead so frames still start on time. Deadlines advance by exactly one frame time, so a slightly
+ * late frame is made up by the next one rather than drifting.
+*/
+class FrameLimiter
+{
+ public:
+    using clock = std::chrono::steady_clock;
+
+    /// aTargetFps of 0 disables limiting
+    FrameLimiter(double aTargetFps = 0.0);
+
+    void setTargetFps(double aTargetFps);
+    void setTargetFrameTime(clock::duration aFrameTime);
+    clock::duration getTargetFrameTime() const {return(mFrameTime);}
+    bool isEnabled() const {return(mFrameTime > clock::duration::zero());}
+
+    /// Block until the next frame should start. Call once per frame, before the frame's work.
+    void wait();
+
+    /// How late frames started relative to their deadline, in milliseconds
+    SampleSummary getPacingErrorSummary() const {return(mPacingErrors.summarize());}
+    /// Current estimate of how far an OS sleep overshoots, in milliseconds
+    double getSleepOvershootEstimate() const;
+    void resetStatistics() {mPacingErrors.clear();}
+
+ protected:
+    void recordSleepOvershoot(clock::duration aOvershoot);
+
+    clock::duration mFrameTime{0};
+    clock::time_point mDeadline;
+    bool mHasDeadline = false;
+
+    // Running mean and mean deviation of sleep overshoot, in nanoseconds
+    double mOvershootMean = 1e6;
+    double mOvershootDeviation = 0.0;
+
+    SampleWindow mPacingErrors;
+};
+
+#endif
@@ -0,0 +1,124 @@
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& aOther){
+    *this = std::move(aOther);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& aOther){
+    if(this == &aOther) return(*this);
+    close();
+    std::swap(mIsOpen, aOther.mIsOpen);
+    std::swap(mData, aOther.mData);
+    std::swap(mSize, aOther.mSize);
+    std::swap(mPath, aOther.mPath);
+#ifdef _WIN32
+    std::swap(mFileHandle, aOther.mFileHandle);
+    std::swap(mMappingHandle, aOther.mMappingHandle);
+#endif
+    return(*this);
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& aFilePath){
+    close();
+    HANDLE file = CreateFileA(aFilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE) return(false);
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize)){
+        CloseHandle(file);
+        return(false);
+    }
+
+    // Empty files can't be mapped, but are still considered successfully opened.
+    if(fileSize.QuadPart > 0){
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(mapping == nullptr){
+            CloseHandle(file);
+            return(false);
+        }
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if(view == nullptr){
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return(false);
+        }
+        mMappingHandle = mapping;
+        mData = static_cast<const uint8_t*>(view);
+    }
+
+    mFileHandle = file;
+    mSize = static_cast<size_t>(fileSize.QuadPart);
+    mPath = aFilePath;
+    mIsOpen = true;
+    return(true);
+}
+
+void MappedFile::close(){
+    if(!mIsOpen) return;
+    if(mData != nullptr) UnmapViewOfFile(mData);
+    if(mMappingHandle != nullptr) CloseHandle(mMappingHandle);
+    if(mFileHandle != nullptr) CloseHandle(mFileHandle);
+    mMappingHandle = nullptr;
+    mFileHandle = nullptr;
+    mData = nullptr;
+    mSize = 0;
+    mPath.clear();
+    mIsOpen = false;
+}
+
+#else
+
+bool MappedFile::open(const std::string& aFilePath){
+    close();
+    int fd = ::open(aFilePath.c_str(), O_RDONLY);
+    if(fd < 0) return(false);
+
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0){
+        ::close(fd);
+        return(false);
+    }
+
+    // Empty files can't be mapped, but are still considered successfully opened.
+    if(fileStat.st_size > 0){
+        void* mapping = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapping == MAP_FAILED){
+            ::close(fd);
+            return(false);
+        }
+        mData = static_cast<const uint8_t*>(mapping);
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+
+    mSize = static_cast<size_t>(fileStat.st_size);
+    mPath = aFilePath;
+    mIsOpen = true;
+    return(true);
+}
+
+void MappedFile::close(){
+    if(!mIsOpen) return;
+    if(mData != nullptr) munmap(const_cast<uint8_t*>(mData), mSize);
+    mData = nullptr;
+    mSize = 0;
+    mPath.clear();
+    mIsOpen = false;
+}
+
+#endif
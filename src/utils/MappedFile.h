@@ -0,0 +1,44 @@
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+/** Read-only memory mapping of a file. The file contents can be read straight out of
+ * the page cache through data() without copying them into an intermediate buffer. 
+*/
+class MappedFile
+{
+ public:
+    MappedFile(){}
+    explicit MappedFile(const std::string& aFilePath) {open(aFilePath);}
+    ~MappedFile() {close();}
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& aOther);
+    MappedFile& operator=(MappedFile&& aOther);
+
+    /// Map the file at aFilePath, unmapping any previously mapped file. Returns false on failure.
+    bool open(const std::string& aFilePath);
+    void close();
+
+    bool isOpen() const {return(mIsOpen);}
+    /// nullptr for an empty file, which still opens with a size of 0
+    const uint8_t* data() const {return(mData);}
+    size_t size() const {return(mSize);}
+    const std::string& path() const {return(mPath);}
+
+ protected:
+    bool mIsOpen = false;
+    const uint8_t* mData = nullptr;
+    size_t mSize = 0;
+    std::string mPath;
+
+#ifdef _WIN32
+    void* mFileHandle = nullptr;
+    void* mMappingHandle = nullptr;
+#endif
+};
+
+#endif
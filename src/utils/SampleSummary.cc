@@ -0,0 +1,64 @@
+#include "SampleSummary.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+
+SampleSummary summarize_samples(std::vector<double> aSamples){
+    SampleSummary summary;
+    if(aSamples.empty()) return(summary);
+
+    std::sort(aSamples.begin(), aSamples.end());
+    summary.count = aSamples.size();
+    summary.min = aSamples.front();
+    summary.max = aSamples.back();
+    summary.mean = std::accumulate(aSamples.begin(), aSamples.end(), 0.0) / aSamples.size();
+    summary.p50 = sorted_percentile(aSamples, 50.0);
+    summary.p95 = sorted_percentile(aSamples, 95.0);
+    summary.p99 = sorted_percentile(aSamples, 99.0);
+    return(summary);
+}
+
+double sorted_percentile(const std::vector<double>& aSorted, double aPercentile){
+    if(aSorted.empty()) return(0.0);
+    double rank = std::min(std::max(aPercentile, 0.0), 100.0) / 100.0 * (aSorted.size() - 1);
+    size_t lower = static_cast<size_t>(std::floor(rank));
+    size_t upper = std::min(lower + 1, aSorted.size() - 1);
+    double fraction = rank - lower;
+    return(aSorted[lower] + (aSorted[upper] - aSorted[lower]) * fraction);
+}
+
+void SampleWindow::add(double aSample){
+    if(mCapacity == 0) return;
+    if(mSamples.size() < mCapacity){
+        mSamples.push_back(aSample);
+    }else{
+        mSamples[mNext] = aSample;
+        mNext = (mNext + 1) % mCapacity;
+    }
+}
+
+std::vector<double> SampleWindow::getSamples() const{
+    std::vector<double> ordered;
+    ordered.reserve(mSamples.size());
+    ordered.insert(ordered.end(), mSamples.begin() + mNext, mSamples.end());
+    ordered.insert(ordered.end(), mSamples.begin(), mSamples.begin() + mNext);
+    return(ordered);
+}
+
+std::string SampleSummary::toString(int aPrecision) const{
+    std::ostringstream builder;
+    builder.setf(std::ios_base::fixed, std::ios_base::floatfield);
+    builder.precision(aPrecision);
+    builder << "mean " << mean << " | p50 " << p50 << " | p95 " << p95 << " | p99 " << p99 << " | max " << max;
+    return(builder.str());
+}
+
+std::string SampleSummary::toJson(int aPrecision) const{
+    std::ostringstream builder;
+    builder.setf(std::ios_base::fixed, std::ios_base::floatfield);
+    builder.precision(aPrecision);
+    builder << "{\"count\": " << count << ", \"min\": " << min << ", \"mean\": " << mean << ", \"p50\": " << p50
+            << ", \"p95\": " << p95 << ", \"p99\": " << p99 << ", \"max\": " << max << "}";
+    return(builder.str());
+}
@@ -0,0 +1,50 @@
+#ifndef SAMPLE_SUMMARY_H_
+#define SAMPLE_SUMMARY_H_
+#include <string>
+#include <vector>
+
+/// Order statistics of a set of measurements
+struct SampleSummary
+{
+    size_t count = 0;
+    double min = 0.0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+
+    /// e.g. "mean 1.000 | p50 1.000 | p95 2.000 | p99 2.000 | max 3.000"
+    std::string toString(int aPrecision = 3) const;
+    /// e.g. {"count": 3, "min": 1.0, "mean": 2.0, "p50": 2.0, "p95": 2.9, "p99": 2.98, "max": 3.0}
+    std::string toJson(int aPrecision = 4) const;
+};
+
+SampleSummary summarize_samples(std::vector<double> aSamples);
+
+/// Fixed capacity window over the most recent samples of a measurement
+class SampleWindow
+{
+ public:
+    SampleWindow(size_t aCapacity = 4096U) : mCapacity(aCapacity) {}
+
+    void add(double aSample);
+    /// Samples in the window, oldest first
+    std::vector<double> getSamples() const;
+    SampleSummary summarize() const {return(summarize_samples(mSamples));}
+
+    size_t size() const {return(mSamples.size());}
+    size_t capacity() const {return(mCapacity);}
+    bool empty() const {return(mSamples.empty());}
+    void clear() {mSamples.clear(); mNext = 0;}
+
+ protected:
+    size_t mCapacity;
+    std::vector<double> mSamples;
+    size_t mNext = 0; // Position of the oldest sample once the window is full
+};
+
+/// Value at aPercentile (0 to 100) of ascending aSorted, interpolating between the nearest ranks
+double sorted_percentile(const std::vector<double>& aSorted, double aPercentile);
+
+#endif
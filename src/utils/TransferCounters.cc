@@ -0,0 +1,26 @@
+#include "TransferCounters.h"
+#include <atomic>
+
+static std::atomic<uint64_t> sUploadBytes{0};
+static std::atomic<uint64_t> sUploadCount{0};
+static std::atomic<uint64_t> sAllocationCount{0};
+static std::atomic<uint64_t> sAllocationBytes{0};
+
+void count_device_upload(uint64_t aBytes){
+    sUploadBytes += aBytes;
+    ++sUploadCount;
+}
+
+void count_device_allocation(uint64_t aBytes){
+    sAllocationBytes += aBytes;
+    ++sAllocationCount;
+}
+
+TransferCounters get_transfer_counters(){
+    TransferCounters counters;
+    counters.uploadBytes = sUploadBytes;
+    counters.uploadCount = sUploadCount;
+    counters.allocationCount = sAllocationCount;
+    counters.allocationBytes = sAllocationBytes;
+    return(counters);
+}
@@ -0,0 +1,29 @@
+#ifndef TRANSFER_COUNTERS_H_
+#define TRANSFER_COUNTERS_H_
+#include <cstdint>
+
+/** Process wide totals of host to device uploads and device memory allocations. Buffers count themselves as
+ * they upload and allocate, so per-frame costs can be found by differencing snapshots around a frame.
+*/
+struct TransferCounters
+{
+    uint64_t uploadBytes = 0;
+    uint64_t uploadCount = 0;
+    uint64_t allocationCount = 0;
+    uint64_t allocationBytes = 0;
+
+    friend TransferCounters operator-(const TransferCounters& lhs, const TransferCounters& rhs){
+        TransferCounters diff;
+        diff.uploadBytes = lhs.uploadBytes - rhs.uploadBytes;
+        diff.uploadCount = lhs.uploadCount - rhs.uploadCount;
+        diff.allocationCount = lhs.allocationCount - rhs.allocationCount;
+        diff.allocationBytes = lhs.allocationBytes - rhs.allocationBytes;
+        return(diff);
+    }
+};
+
+void count_device_upload(uint64_t aBytes);
+void count_device_allocation(uint64_t aBytes);
+TransferCounters get_transfer_counters();
+
+#endif
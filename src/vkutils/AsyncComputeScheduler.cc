@@ -0,0 +1,143 @@
+#include "AsyncComputeScheduler.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace vkutils{
+
+AsyncComputeScheduler::~AsyncComputeScheduler(){
+    destroy();
+}
+
+void AsyncComputeScheduler::create(const VkDevice& aDevice, uint32_t aQueueFamily, VkQueue aQueue, uint32_t aFrameSlots){
+    destroy();
+    if(aDevice == VK_NULL_HANDLE || aQueue == VK_NULL_HANDLE || aFrameSlots == 0){
+        throw std::runtime_error("AsyncComputeScheduler Error: A device, a queue and at least one frame slot are required!");
+    }
+    mDevice = aDevice;
+    mQueueFamily = aQueueFamily;
+    mFrameSlots.resize(aFrameSlots);
+
+    VkCommandPoolCreateInfo poolInfo;{
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.pNext = nullptr;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        poolInfo.queueFamilyIndex = aQueueFamily;
+    }
+    VkSemaphoreCreateInfo semaphoreInfo = {VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, nullptr, 0};
+
+    for(FrameSlot& slot : mFrameSlots){
+        if(vkCreateCommandPool(mDevice, &poolInfo, nullptr, &slot.pool) != VK_SUCCESS){
+            slot.pool = VK_NULL_HANDLE;
+            destroy();
+            throw std::runtime_error("Failed to create command pool for async compute!");
+        }
+
+        VkCommandBufferAllocateInfo allocInfo;{
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.pNext = nullptr;
+            allocInfo.commandPool = slot.pool;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandBufferCount = 1;
+        }
+        if(vkAllocateCommandBuffers(mDevice, &allocInfo, &slot.commandBuffer) != VK_SUCCESS){
+            slot.commandBuffer = VK_NULL_HANDLE;
+            destroy();
+            throw std::runtime_error("Failed to allocate async compute command buffer!");
+        }
+
+        if(vkCreateSemaphore(mDevice, &semaphoreInfo, nullptr, &slot.finished) != VK_SUCCESS){
+            slot.finished = VK_NULL_HANDLE;
+            destroy();
+            throw std::runtime_error("Failed to create async compute semaphore!");
+        }
+    }
+    mQueue = aQueue;
+}
+
+void AsyncComputeScheduler::destroy(){
+    for(FrameSlot& slot : mFrameSlots){
+        // Command buffers are freed along with their pool
+        if(slot.pool != VK_NULL_HANDLE) vkDestroyCommandPool(mDevice, slot.pool, nullptr);
+        if(slot.finished != VK_NULL_HANDLE) vkDestroySemaphore(mDevice, slot.finished, nullptr);
+    }
+    mFrameSlots.clear();
+    mQueue = VK_NULL_HANDLE;
+}
+
+void AsyncComputeScheduler::addPass(const std::string& aName, RecordFunction aRecord, VkPipelineStageFlags aConsumerStages){
+    if(!aRecord){
+        throw std::runtime_error("AsyncComputeScheduler Error: Pass '" + aName + "' has no record function!");
+    }
+    if(aConsumerStages == 0){
+        throw std::runtime_error("AsyncComputeScheduler Error: Pass '" + aName + "' must name the graphics stages consuming its output!");
+    }
+    auto matchName = [&aName](const Pass& aPass) -> bool {return(aPass.name == aName);};
+    auto findPass = std::find_if(mPasses.begin(), mPasses.end(), matchName);
+    if(findPass != mPasses.end()){
+        findPass->record = aRecord;
+        findPass->consumerStages = aConsumerStages;
+    }else{
+        mPasses.push_back(Pass{aName, aRecord, aConsumerStages});
+    }
+}
+
+void AsyncComputeScheduler::removePass(const std::string& aName){
+    auto matchName = [&aName](const Pass& aPass) -> bool {return(aPass.name == aName);};
+    mPasses.erase(std::remove_if(mPasses.begin(), mPasses.end(), matchName), mPasses.end());
+}
+
+bool AsyncComputeScheduler::hasPass(const std::string& aName) const{
+    auto matchName = [&aName](const Pass& aPass) -> bool {return(aPass.name == aName);};
+    return(std::find_if(mPasses.begin(), mPasses.end(), matchName) != mPasses.end());
+}
+
+VkPipelineStageFlags AsyncComputeScheduler::getWaitStages() const{
+    VkPipelineStageFlags stages = 0;
+    for(const Pass& pass : mPasses){
+        stages |= pass.consumerStages;
+    }
+    return(stages);
+}
+
+VkSemaphore AsyncComputeScheduler::submit(uint32_t aFrameSlot){
+    if(mPasses.empty()) return(VK_NULL_HANDLE);
+    if(!isValid()){
+        throw std::runtime_error("AsyncComputeScheduler Error: Cannot submit passes before create() is called!");
+    }
+
+    FrameSlot& slot = mFrameSlots[aFrameSlot % mFrameSlots.size()];
+    vkResetCommandPool(mDevice, slot.pool, 0);
+
+    VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, nullptr, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, nullptr};
+    if(vkBeginCommandBuffer(slot.commandBuffer, &beginInfo) != VK_SUCCESS){
+        throw std::runtime_error("Failed to begin async compute command recording!");
+    }
+    for(const Pass& pass : mPasses){
+        pass.record(slot.commandBuffer, aFrameSlot);
+    }
+    if(vkEndCommandBuffer(slot.commandBuffer) != VK_SUCCESS){
+        throw std::runtime_error("Failed to end async compute command buffer!");
+    }
+
+    // A binary semaphore can't be signaled again while signaled. If the graphics submission that should have
+    // waited on the last signal never happened, this submission waits it off before signaling anew.
+    const VkPipelineStageFlags staleWaitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    VkSubmitInfo submitInfo = {
+        VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr,
+        slot.unconsumed ? 1U : 0U, &slot.finished, &staleWaitStage,
+        1, &slot.commandBuffer,
+        1, &slot.finished
+    };
+    if(vkQueueSubmit(mQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS){
+        throw std::runtime_error("Submit to compute queue failed!");
+    }
+    slot.unconsumed = true;
+    return(slot.finished);
+}
+
+void AsyncComputeScheduler::consumed(uint32_t aFrameSlot){
+    if(mFrameSlots.empty()) return;
+    mFrameSlots[aFrameSlot % mFrameSlots.size()].unconsumed = false;
+}
+
+} // end namespace vkutils
@@ -0,0 +1,86 @@
+#ifndef ASYNC_COMPUTE_SCHEDULER_H_
+#define ASYNC_COMPUTE_SCHEDULER_H_
+#include <vulkan/vulkan.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace vkutils{
+
+/** Records compute passes (simulation, culling, post-processing) into per-frame command buffers and submits
+ * them to a compute queue ahead of the frame's graphics work. Each submission signals a semaphore that the
+ * graphics submission waits on at the earliest stage consuming compute output, so compute for one frame
+ * overlaps rasterization of the previous frame when the compute queue is separate from the graphics queue.
+ *
+ * Resources written by compute and read by graphics should be duplicated per frame slot, since compute for
+ * a slot runs while the other slots may still be drawing. When the compute and graphics families differ,
+ * shared resources need VK_SHARING_MODE_CONCURRENT across both families, or explicit ownership transfers.
+*/
+class AsyncComputeScheduler
+{
+ public:
+    /// Records one pass into aCommandBuffer for the frame slot aFrameSlot
+    using RecordFunction = std::function<void(VkCommandBuffer aCommandBuffer, uint32_t aFrameSlot)>;
+
+    AsyncComputeScheduler(){}
+    ~AsyncComputeScheduler();
+
+    AsyncComputeScheduler(const AsyncComputeScheduler&) = delete;
+    AsyncComputeScheduler& operator=(const AsyncComputeScheduler&) = delete;
+
+    /// Create a command pool, command buffer and completion semaphore for each of aFrameSlots frame slots
+    void create(const VkDevice& aDevice, uint32_t aQueueFamily, VkQueue aQueue, uint32_t aFrameSlots);
+    void destroy();
+    bool isValid() const {return(mQueue != VK_NULL_HANDLE);}
+    uint32_t getFrameSlotCount() const {return(static_cast<uint32_t>(mFrameSlots.size()));}
+
+    /** Add a pass, recorded after all previously added passes. Replaces any existing pass named aName.
+     * aConsumerStages are the graphics pipeline stages that read the pass's output.
+    */
+    void addPass(const std::string& aName, RecordFunction aRecord, VkPipelineStageFlags aConsumerStages);
+    void removePass(const std::string& aName);
+    bool hasPass(const std::string& aName) const;
+    size_t getPassCount() const {return(mPasses.size());}
+
+    /// Graphics stages that must wait on the compute semaphore, the union of every pass's consumer stages
+    VkPipelineStageFlags getWaitStages() const;
+
+    /** Record and submit the passes for aFrameSlot. Work previously submitted for the slot must have completed.
+     * Returns the semaphore the frame's graphics submission must wait on, or VK_NULL_HANDLE if there are no passes.
+     * The returned semaphore is signaled exactly once, so it must be waited on exactly once. Call consumed() once
+     * the graphics submission waiting on it succeeded. If it never is, e.g. because that submission failed, the
+     * next submit() for the slot waits the stale signal off itself before signaling again.
+    */
+    VkSemaphore submit(uint32_t aFrameSlot);
+    /// A submission waiting on aFrameSlot's semaphore has been made
+    void consumed(uint32_t aFrameSlot);
+
+    uint32_t getQueueFamily() const {return(mQueueFamily);}
+    VkQueue getQueue() const {return(mQueue);}
+
+ protected:
+    struct Pass
+    {
+        std::string name;
+        RecordFunction record;
+        VkPipelineStageFlags consumerStages;
+    };
+
+    struct FrameSlot
+    {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkSemaphore finished = VK_NULL_HANDLE;
+        bool unconsumed = false; // finished was signaled and nothing has waited on it yet
+    };
+
+    VkDevice mDevice = VK_NULL_HANDLE;
+    VkQueue mQueue = VK_NULL_HANDLE;
+    uint32_t mQueueFamily = 0;
+    std::vector<FrameSlot> mFrameSlots;
+    std::vector<Pass> mPasses;
+};
+
+} // end namespace vkutils
+
+#endif
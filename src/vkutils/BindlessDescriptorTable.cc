@@ -0,0 +1,172 @@
+#include "BindlessDescriptorTable.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace vkutils{
+
+const uint32_t SlotAllocator::sInvalidSlot;
+const uint32_t BindlessDescriptorTable::sStorageBufferBinding;
+const uint32_t BindlessDescriptorTable::sSampledImageBinding;
+
+uint32_t SlotAllocator::acquire(){
+    if(!mFreeSlots.empty()){
+        uint32_t slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+        return(slot);
+    }
+    if(mHighWater >= mCapacity) return(sInvalidSlot);
+    return(mHighWater++);
+}
+
+void SlotAllocator::release(uint32_t aSlot){
+    if(aSlot >= mHighWater || std::find(mFreeSlots.begin(), mFreeSlots.end(), aSlot) != mFreeSlots.end()){
+        throw std::runtime_error("SlotAllocator Error: Releasing slot " + std::to_string(aSlot) + " which is not in use!");
+    }
+    mFreeSlots.push_back(aSlot);
+}
+
+void SlotAllocator::reset(uint32_t aCapacity){
+    mCapacity = aCapacity;
+    mHighWater = 0;
+    mFreeSlots.clear();
+}
+
+BindlessDescriptorTable::~BindlessDescriptorTable(){
+    destroy();
+}
+
+VkDescriptorBindingFlagsEXT BindlessDescriptorTable::getBindingFlags(){
+    return(VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT);
+}
+
+void BindlessDescriptorTable::create(const VkDevice& aDevice, uint32_t aMaxStorageBuffers, uint32_t aMaxSampledImages){
+    destroy();
+    if(aMaxStorageBuffers == 0 || aMaxSampledImages == 0){
+        throw std::runtime_error("BindlessDescriptorTable Error: Capacities must be non-zero!");
+    }
+    mDevice = aDevice;
+
+    const VkDescriptorSetLayoutBinding bindings[2] = {
+        {sStorageBufferBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, aMaxStorageBuffers, VK_SHADER_STAGE_ALL, nullptr},
+        {sSampledImageBinding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, aMaxSampledImages, VK_SHADER_STAGE_ALL, nullptr}
+    };
+    const VkDescriptorBindingFlagsEXT bindingFlags[2] = {getBindingFlags(), getBindingFlags()};
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT flagsInfo;
+    {
+        flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+        flagsInfo.pNext = nullptr;
+        flagsInfo.bindingCount = 2;
+        flagsInfo.pBindingFlags = bindingFlags;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo;
+    {
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.pNext = &flagsInfo;
+        layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+        layoutInfo.bindingCount = 2;
+        layoutInfo.pBindings = bindings;
+    }
+    if(vkCreateDescriptorSetLayout(mDevice, &layoutInfo, nullptr, &mLayout) != VK_SUCCESS){
+        throw std::runtime_error("Failed to create bindless descriptor set layout!");
+    }
+
+    const VkDescriptorPoolSize poolSizes[2] = {
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, aMaxStorageBuffers},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, aMaxSampledImages}
+    };
+    VkDescriptorPoolCreateInfo poolInfo;
+    {
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.pNext = nullptr;
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+        poolInfo.maxSets = 1;
+        poolInfo.poolSizeCount = 2;
+        poolInfo.pPoolSizes = poolSizes;
+    }
+    if(vkCreateDescriptorPool(mDevice, &poolInfo, nullptr, &mPool) != VK_SUCCESS){
+        destroy();
+        throw std::runtime_error("Failed to create bindless descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo;
+    {
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.pNext = nullptr;
+        allocInfo.descriptorPool = mPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &mLayout;
+    }
+    if(vkAllocateDescriptorSets(mDevice, &allocInfo, &mSet) != VK_SUCCESS){
+        mSet = VK_NULL_HANDLE;
+        destroy();
+        throw std::runtime_error("Failed to allocate bindless descriptor set!");
+    }
+
+    mBufferSlots.reset(aMaxStorageBuffers);
+    mImageSlots.reset(aMaxSampledImages);
+}
+
+void BindlessDescriptorTable::destroy(){
+    // The set is freed along with its pool
+    if(mPool != VK_NULL_HANDLE){
+        vkDestroyDescriptorPool(mDevice, mPool, nullptr);
+        mPool = VK_NULL_HANDLE;
+    }
+    if(mLayout != VK_NULL_HANDLE){
+        vkDestroyDescriptorSetLayout(mDevice, mLayout, nullptr);
+        mLayout = VK_NULL_HANDLE;
+    }
+    mSet = VK_NULL_HANDLE;
+    mBufferSlots.reset(0);
+    mImageSlots.reset(0);
+}
+
+uint32_t BindlessDescriptorTable::addStorageBuffer(const VkDescriptorBufferInfo& aInfo){
+    uint32_t slot = mBufferSlots.acquire();
+    if(slot == SlotAllocator::sInvalidSlot){
+        throw std::runtime_error("BindlessDescriptorTable Error: All " + std::to_string(mBufferSlots.getCapacity()) + " storage buffer slots are in use!");
+    }
+    updateStorageBuffer(slot, aInfo);
+    return(slot);
+}
+
+uint32_t BindlessDescriptorTable::addSampledImage(const VkDescriptorImageInfo& aInfo){
+    uint32_t slot = mImageSlots.acquire();
+    if(slot == SlotAllocator::sInvalidSlot){
+        throw std::runtime_error("BindlessDescriptorTable Error: All " + std::to_string(mImageSlots.getCapacity()) + " sampled image slots are in use!");
+    }
+    updateSampledImage(slot, aInfo);
+    return(slot);
+}
+
+void BindlessDescriptorTable::updateStorageBuffer(uint32_t aSlot, const VkDescriptorBufferInfo& aInfo){
+    write(sStorageBufferBinding, aSlot, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &aInfo, nullptr);
+}
+
+void BindlessDescriptorTable::updateSampledImage(uint32_t aSlot, const VkDescriptorImageInfo& aInfo){
+    write(sSampledImageBinding, aSlot, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, nullptr, &aInfo);
+}
+
+void BindlessDescriptorTable::write(uint32_t aBinding, uint32_t aSlot, VkDescriptorType aType, const VkDescriptorBufferInfo* aBufferInfo, const VkDescriptorImageInfo* aImageInfo){
+    if(!isValid()){
+        throw std::runtime_error("BindlessDescriptorTable Error: Table has not been created!");
+    }
+    VkWriteDescriptorSet writer = {
+        /* sType = */ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        /* pNext = */ nullptr,
+        /* dstSet = */ mSet,
+        /* dstBinding = */ aBinding,
+        /* dstArrayElement = */ aSlot,
+        /* descriptorCount = */ 1,
+        /* descriptorType = */ aType,
+        /* pImageInfo = */ aImageInfo,
+        /* pBufferInfo = */ aBufferInfo,
+        /* pTexelBufferView = */ nullptr
+    };
+    vkUpdateDescriptorSets(mDevice, 1, &writer, 0, nullptr);
+}
+
+} // end namespace vkutils
@@ -0,0 +1,94 @@
+#ifndef BINDLESS_DESCRIPTOR_TABLE_H_
+#define BINDLESS_DESCRIPTOR_TABLE_H_
+#include <vulkan/vulkan.h>
+#include <vector>
+
+namespace vkutils{
+
+/// Hands out integer slots in [0, capacity), reusing released slots before growing
+class SlotAllocator
+{
+ public:
+    static const uint32_t sInvalidSlot = 0xFFFFFFFFU;
+
+    SlotAllocator(uint32_t aCapacity = 0) : mCapacity(aCapacity) {}
+
+    /// Returns sInvalidSlot if every slot is in use
+    uint32_t acquire();
+    void release(uint32_t aSlot);
+    void reset(uint32_t aCapacity);
+
+    uint32_t getCapacity() const {return(mCapacity);}
+    uint32_t getUsedCount() const {return(mHighWater - static_cast<uint32_t>(mFreeSlots.size()));}
+    /// One past the highest slot ever handed out
+    uint32_t getHighWater() const {return(mHighWater);}
+
+ protected:
+    uint32_t mCapacity = 0;
+    uint32_t mHighWater = 0;
+    std::vector<uint32_t> mFreeSlots;
+};
+
+/** One large, globally bound descriptor set holding every storage buffer and sampled image in the scene.
+ * Resources are added once and referred to by slot index, which shaders receive through push constants
+ * and use to index the arrays:
+ *
+ *     layout(set = 1, binding = 0) readonly buffer Buffers { float data[]; } uBuffers[];
+ *     layout(set = 1, binding = 1) uniform sampler2D uTextures[];
+ *
+ * Bindings are update-after-bind and partially bound, so slots may be filled while the set is in use
+ * by pending command buffers and unused slots need not hold valid descriptors.
+ * Requires VK_EXT_descriptor_indexing (core in Vulkan 1.2) with the matching features enabled on the device.
+*/
+class BindlessDescriptorTable
+{
+ public:
+    static const uint32_t sStorageBufferBinding = 0;
+    static const uint32_t sSampledImageBinding = 1;
+
+    BindlessDescriptorTable(){}
+    ~BindlessDescriptorTable();
+
+    BindlessDescriptorTable(const BindlessDescriptorTable&) = delete;
+    BindlessDescriptorTable& operator=(const BindlessDescriptorTable&) = delete;
+
+    /// Create the layout, pool and set. Capacities are clamped to the device's update-after-bind limits by the caller.
+    void create(const VkDevice& aDevice, uint32_t aMaxStorageBuffers, uint32_t aMaxSampledImages);
+    void destroy();
+
+    bool isValid() const {return(mSet != VK_NULL_HANDLE);}
+    VkDescriptorSetLayout getLayout() const {return(mLayout);}
+    VkDescriptorSet getSet() const {return(mSet);}
+
+    /// Write a storage buffer into a free slot and return its index. Throws if the table is full.
+    uint32_t addStorageBuffer(const VkDescriptorBufferInfo& aInfo);
+    /// Write a combined image sampler into a free slot and return its index. Throws if the table is full.
+    uint32_t addSampledImage(const VkDescriptorImageInfo& aInfo);
+
+    void updateStorageBuffer(uint32_t aSlot, const VkDescriptorBufferInfo& aInfo);
+    void updateSampledImage(uint32_t aSlot, const VkDescriptorImageInfo& aInfo);
+
+    /// Free a slot for reuse. The caller must make sure no pending work still indexes it.
+    void removeStorageBuffer(uint32_t aSlot) {mBufferSlots.release(aSlot);}
+    void removeSampledImage(uint32_t aSlot) {mImageSlots.release(aSlot);}
+
+    const SlotAllocator& getStorageBufferSlots() const {return(mBufferSlots);}
+    const SlotAllocator& getSampledImageSlots() const {return(mImageSlots);}
+
+    /// Binding flags used for both bindings of the table
+    static VkDescriptorBindingFlagsEXT getBindingFlags();
+
+ protected:
+    void write(uint32_t aBinding, uint32_t aSlot, VkDescriptorType aType, const VkDescriptorBufferInfo* aBufferInfo, const VkDescriptorImageInfo* aImageInfo);
+
+    VkDevice mDevice = VK_NULL_HANDLE;
+    VkDescriptorSetLayout mLayout = VK_NULL_HANDLE;
+    VkDescriptorPool mPool = VK_NULL_HANDLE;
+    VkDescriptorSet mSet = VK_NULL_HANDLE;
+    SlotAllocator mBufferSlots;
+    SlotAllocator mImageSlots;
+};
+
+} // end namespace vkutils
+
+#endif
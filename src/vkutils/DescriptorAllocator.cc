@@ -0,0 +1,378 @@
+#include "DescriptorAllocator.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+namespace vkutils{
+
+namespace{
+// Non-dispatchable handles are pointers on 64-bit platforms and uint64_t on 32-bit ones
+template<typename HandleType>
+uint64_t handle_bits(HandleType aHandle){
+    return((uint64_t)(aHandle));
+}
+
+void add_count(DescriptorAllocator::PoolRatios& aCounts, VkDescriptorType aType, float aCount){
+    for(std::pair<VkDescriptorType, float>& count : aCounts){
+        if(count.first == aType){
+            count.second += aCount;
+            return;
+        }
+    }
+    aCounts.emplace_back(aType, aCount);
+}
+} // end anonymous namespace
+
+const uint32_t DescriptorAllocator::sMaxSetsPerPool;
+
+const DescriptorAllocator::PoolRatios& DescriptorAllocator::defaultRatios(){
+    static const PoolRatios sRatios = {
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.0f},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2.0f},
+        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 0.5f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0.5f}
+    };
+    return(sRatios);
+}
+
+DescriptorAllocator::PoolRatios DescriptorAllocator::layout_counts(const std::vector<VkDescriptorSetLayoutBinding>& aBindings){
+    PoolRatios counts;
+    for(const VkDescriptorSetLayoutBinding& binding : aBindings){
+        add_count(counts, binding.descriptorType, static_cast<float>(binding.descriptorCount));
+    }
+    return(counts);
+}
+
+DescriptorAllocator::DescriptorAllocator(const VkDevice& aDevice, const PoolRatios& aRatios, uint32_t aInitialSetsPerPool)
+ : mDevice(aDevice), mRatios(aRatios), mSetsPerPool(std::max(1U, aInitialSetsPerPool))
+{}
+
+DescriptorAllocator::~DescriptorAllocator(){
+    destroy();
+}
+
+DescriptorAllocator::DescriptorAllocator(DescriptorAllocator&& aOther){
+    *this = std::move(aOther);
+}
+
+DescriptorAllocator& DescriptorAllocator::operator=(DescriptorAllocator&& aOther){
+    if(this == &aOther) return(*this);
+    destroy();
+    mDevice = aOther.mDevice;
+    mRatios = std::move(aOther.mRatios);
+    mSetsPerPool = aOther.mSetsPerPool;
+    mCurrentPool = aOther.mCurrentPool;
+    mUsedPools = std::move(aOther.mUsedPools);
+    mFreePools = std::move(aOther.mFreePools);
+    mAllocatedSets = aOther.mAllocatedSets;
+
+    aOther.mCurrentPool = VK_NULL_HANDLE;
+    aOther.mUsedPools.clear();
+    aOther.mFreePools.clear();
+    aOther.mAllocatedSets = 0;
+    return(*this);
+}
+
+void DescriptorAllocator::setDevice(const VkDevice& aDevice){
+    if(mDevice == aDevice) return;
+    if(getPoolCount() > 0){
+        throw std::runtime_error("DescriptorAllocator::setDevice() Error: Cannot change device while pools exist!");
+    }
+    mDevice = aDevice;
+    if(mRatios.empty()) mRatios = defaultRatios();
+}
+
+void DescriptorAllocator::fitLayout(const PoolRatios& aLayoutCounts){
+    if(mRatios.empty()) mRatios = defaultRatios();
+    // Repeated types add up, as they would for separate bindings of one layout
+    PoolRatios merged;
+    for(const std::pair<VkDescriptorType, float>& count : aLayoutCounts){
+        add_count(merged, count.first, count.second);
+    }
+    for(const std::pair<VkDescriptorType, float>& count : merged){
+        PoolRatios::iterator existing = std::find_if(mRatios.begin(), mRatios.end(),
+            [&count](const std::pair<VkDescriptorType, float>& aRatio){return(aRatio.first == count.first);});
+        if(existing != mRatios.end()){
+            existing->second = std::max(existing->second, count.second);
+        }else{
+            mRatios.push_back(count);
+        }
+    }
+}
+
+VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout aLayout){
+    if(mDevice == VK_NULL_HANDLE){
+        throw std::runtime_error("DescriptorAllocator Error: No device has been set!");
+    }
+    bool createdPool = false;
+    if(mCurrentPool == VK_NULL_HANDLE){
+        mCurrentPool = grabPool(createdPool);
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo;
+    {
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.pNext = nullptr;
+        allocInfo.descriptorPool = mCurrentPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &aLayout;
+    }
+
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    VkResult result = vkAllocateDescriptorSets(mDevice, &allocInfo, &descriptorSet);
+    // The current pool is full, or a recycled one was sized before fitLayout() raised the mix. Move along
+    // the chain until a pool fits; once a brand new pool doesn't fit either there is nothing left to try.
+    while((result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) && !createdPool){
+        mCurrentPool = grabPool(createdPool);
+        allocInfo.descriptorPool = mCurrentPool;
+        result = vkAllocateDescriptorSets(mDevice, &allocInfo, &descriptorSet);
+    }
+    if(result != VK_SUCCESS){
+        throw std::runtime_error(createdPool && result == VK_ERROR_OUT_OF_POOL_MEMORY
+            ? "DescriptorAllocator Error: Layout needs more descriptors than a pool holds, pass its bindings to fitLayout()!"
+            : "DescriptorAllocator Error: Failed to allocate descriptor set!");
+    }
+
+    ++mAllocatedSets;
+    return(descriptorSet);
+}
+
+void DescriptorAllocator::reset(){
+    for(VkDescriptorPool pool : mUsedPools){
+        vkResetDescriptorPool(mDevice, pool, 0);
+        mFreePools.push_back(pool);
+    }
+    mUsedPools.clear();
+    mCurrentPool = VK_NULL_HANDLE;
+    mAllocatedSets = 0;
+}
+
+void DescriptorAllocator::destroy(){
+    for(VkDescriptorPool pool : mUsedPools){
+        vkDestroyDescriptorPool(mDevice, pool, nullptr);
+    }
+    for(VkDescriptorPool pool : mFreePools){
+        vkDestroyDescriptorPool(mDevice, pool, nullptr);
+    }
+    mUsedPools.clear();
+    mFreePools.clear();
+    mCurrentPool = VK_NULL_HANDLE;
+    mAllocatedSets = 0;
+}
+
+VkDescriptorPool DescriptorAllocator::grabPool(bool& aCreatedOut){
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    aCreatedOut = mFreePools.empty();
+    if(!mFreePools.empty()){
+        pool = mFreePools.back();
+        mFreePools.pop_back();
+    }else{
+        pool = createPool(mSetsPerPool);
+        // Each new pool is larger than the last so long running growth needs few pools
+        mSetsPerPool = std::min(sMaxSetsPerPool, mSetsPerPool + mSetsPerPool / 2U);
+    }
+    mUsedPools.push_back(pool);
+    return(pool);
+}
+
+VkDescriptorPool DescriptorAllocator::createPool(uint32_t aSetCount) const{
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    poolSizes.reserve(mRatios.size());
+    for(const std::pair<VkDescriptorType, float>& ratio : mRatios){
+        poolSizes.emplace_back(VkDescriptorPoolSize{
+            /* type = */ ratio.first,
+            /* descriptorCount = */ std::max(1U, static_cast<uint32_t>(ratio.second * aSetCount))
+        });
+    }
+
+    VkDescriptorPoolCreateInfo createInfo;
+    {
+        createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        createInfo.pNext = nullptr;
+        createInfo.flags = 0;
+        createInfo.maxSets = aSetCount;
+        createInfo.poolSizeCount = poolSizes.size();
+        createInfo.pPoolSizes = poolSizes.data();
+    }
+
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    if(vkCreateDescriptorPool(mDevice, &createInfo, nullptr, &pool) != VK_SUCCESS){
+        throw std::runtime_error("DescriptorAllocator Error: Failed to create descriptor pool!");
+    }
+    return(pool);
+}
+
+DescriptorBinding DescriptorBinding::buffer(uint32_t aBinding, VkDescriptorType aType, const VkDescriptorBufferInfo& aInfo){
+    DescriptorBinding result;
+    result.binding = aBinding;
+    result.type = aType;
+    result.bufferInfo = aInfo;
+    return(result);
+}
+
+DescriptorBinding DescriptorBinding::image(uint32_t aBinding, VkDescriptorType aType, const VkDescriptorImageInfo& aInfo){
+    DescriptorBinding result;
+    result.binding = aBinding;
+    result.type = aType;
+    result.imageInfo = aInfo;
+    return(result);
+}
+
+bool DescriptorBinding::isImage() const{
+    switch(type){
+        case VK_DESCRIPTOR_TYPE_SAMPLER:
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+            return(true);
+        default:
+            return(false);
+    }
+}
+
+bool DescriptorBinding::operator==(const DescriptorBinding& aOther) const{
+    if(binding != aOther.binding || type != aOther.type) return(false);
+    if(isImage()){
+        return(imageInfo.sampler == aOther.imageInfo.sampler && imageInfo.imageView == aOther.imageInfo.imageView && imageInfo.imageLayout == aOther.imageInfo.imageLayout);
+    }
+    return(bufferInfo.buffer == aOther.bufferInfo.buffer && bufferInfo.offset == aOther.bufferInfo.offset && bufferInfo.range == aOther.bufferInfo.range);
+}
+
+void DescriptorSetCache::setDevice(const VkDevice& aDevice){
+    if(aDevice == mDevice) return;
+    clear();
+    mDevice = aDevice;
+}
+
+VkDescriptorSet DescriptorSetCache::getOrCreate(VkDescriptorSetLayout aLayout, const std::vector<DescriptorBinding>& aBindings){
+    DescriptorAllocator::PoolRatios counts;
+    for(const DescriptorBinding& binding : aBindings){
+        counts.emplace_back(binding.type, 1.0f);
+    }
+    bool allocated = false;
+    VkDescriptorSet descriptorSet = findOrAllocate(SetKey{aLayout, aBindings}, counts, allocated);
+    if(allocated){
+        writeSet(descriptorSet, aBindings);
+    }
+    return(descriptorSet);
+}
+
+VkDescriptorSet DescriptorSetCache::getOrCreate(const DescriptorUpdateTemplate& aTemplate, const std::vector<DescriptorBinding>& aBindings){
+    DescriptorAllocator::PoolRatios counts;
+    for(const VkDescriptorUpdateTemplateEntry& entry : aTemplate.getEntries()){
+        counts.emplace_back(entry.descriptorType, static_cast<float>(entry.descriptorCount));
+    }
+    bool allocated = false;
+    VkDescriptorSet descriptorSet = findOrAllocate(SetKey{aTemplate.getLayout(), aBindings}, counts, allocated);
+    if(allocated){
+        mScratchPayload.assign(aTemplate.getPayloadCount(), DescriptorPayload{});
+        for(const DescriptorBinding& binding : aBindings){
+            size_t slot = aTemplate.getSlot(binding.binding);
+            if(slot >= mScratchPayload.size()){
+                throw std::runtime_error("DescriptorSetCache Error: Binding " + std::to_string(binding.binding) + " is not part of the update template!");
+            }
+            if(binding.isImage()){
+                mScratchPayload[slot].image = binding.imageInfo;
+            }else{
+                mScratchPayload[slot].buffer = binding.bufferInfo;
+            }
+        }
+        aTemplate.update(descriptorSet, mScratchPayload.data());
+    }
+    return(descriptorSet);
+}
+
+VkDescriptorSet DescriptorSetCache::findOrAllocate(SetKey&& aKey, const DescriptorAllocator::PoolRatios& aLayoutCounts, bool& aAllocatedOut){
+    auto bindingLess = [](const DescriptorBinding& lhs, const DescriptorBinding& rhs) -> bool {return(lhs.binding < rhs.binding);};
+    std::sort(aKey.bindings.begin(), aKey.bindings.end(), bindingLess);
+
+    auto found = mSets.find(aKey);
+    if(found != mSets.end()){
+        ++mStats.cacheHits;
+        aAllocatedOut = false;
+        return(found->second);
+    }
+
+    auto chain = mAllocators.find(aKey.layout);
+    if(chain == mAllocators.end()){
+        chain = mAllocators.emplace(aKey.layout, DescriptorAllocator(mDevice)).first;
+    }
+    chain->second.fitLayout(aLayoutCounts);
+    VkDescriptorSet descriptorSet = chain->second.allocate(aKey.layout);
+    ++mStats.setsWritten;
+    mSets.emplace(std::move(aKey), descriptorSet);
+    aAllocatedOut = true;
+    return(descriptorSet);
+}
+
+void DescriptorSetCache::forgetLayout(VkDescriptorSetLayout aLayout){
+    for(auto iter = mSets.begin(); iter != mSets.end(); /*no-op*/){
+        if(iter->first.layout == aLayout){
+            iter = mSets.erase(iter);
+        }else{
+            ++iter;
+        }
+    }
+    // Destroying the chain frees every set allocated from it
+    mAllocators.erase(aLayout);
+}
+
+void DescriptorSetCache::clear(){
+    mSets.clear();
+    mAllocators.clear();
+}
+
+size_t DescriptorSetCache::getPoolCount() const{
+    size_t count = 0;
+    for(const std::pair<const VkDescriptorSetLayout, DescriptorAllocator>& chain : mAllocators){
+        count += chain.second.getPoolCount();
+    }
+    return(count);
+}
+
+size_t DescriptorSetCache::hashKey(VkDescriptorSetLayout aLayout, const std::vector<DescriptorBinding>& aBindings){
+    size_t seed = std::hash<uint64_t>()(handle_bits(aLayout));
+    auto combine = [&seed](uint64_t aValue){ seed ^= std::hash<uint64_t>()(aValue) + 0x9e3779b9 + (seed << 6) + (seed >> 2); };
+    for(const DescriptorBinding& binding : aBindings){
+        combine(binding.binding);
+        combine(static_cast<uint64_t>(binding.type));
+        if(binding.isImage()){
+            combine(handle_bits(binding.imageInfo.sampler));
+            combine(handle_bits(binding.imageInfo.imageView));
+            combine(static_cast<uint64_t>(binding.imageInfo.imageLayout));
+        }else{
+            combine(handle_bits(binding.bufferInfo.buffer));
+            combine(binding.bufferInfo.offset);
+            combine(binding.bufferInfo.range);
+        }
+    }
+    return(seed);
+}
+
+void DescriptorSetCache::writeSet(VkDescriptorSet aSet, const std::vector<DescriptorBinding>& aBindings) const{
+    std::vector<VkWriteDescriptorSet> setWriters;
+    setWriters.reserve(aBindings.size());
+    for(const DescriptorBinding& binding : aBindings){
+        setWriters.emplace_back(
+            VkWriteDescriptorSet{
+                /* sType = */ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                /* pNext = */ nullptr,
+                /* dstSet = */ aSet,
+                /* dstBinding = */ binding.binding,
+                /* dstArrayElement = */ 0,
+                /* descriptorCount = */ 1,
+                /* descriptorType = */ binding.type,
+                /* pImageInfo = */ binding.isImage() ? &binding.imageInfo : nullptr,
+                /* pBufferInfo = */ binding.isImage() ? nullptr : &binding.bufferInfo,
+                /* pTexelBufferView = */ nullptr
+            }
+        );
+    }
+    vkUpdateDescriptorSets(mDevice, setWriters.size(), setWriters.data(), 0, nullptr);
+}
+
+} // end namespace vkutils
@@ -0,0 +1,162 @@
+#ifndef DESCRIPTOR_ALLOCATOR_H_
+#define DESCRIPTOR_ALLOCATOR_H_
+#include "DescriptorUpdateTemplate.h"
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+
+namespace vkutils{
+
+/** Allocates descriptor sets from a growing chain of descriptor pools.
+ * Each pool is sized for a mix of descriptor types given as a count per set. When the current pool is
+ * exhausted a new, larger one is chained on rather than failing, so callers never need to know up front
+ * how many sets they will allocate. Layouts needing more of a type than the mix provides must be passed to
+ * fitLayout() first, which raises the mix so every pool created afterwards can hold at least one such set.
+ * reset() recycles every pool at once, which makes a separate allocator per in-flight frame a cheap way to hand out transient sets.
+*/
+class DescriptorAllocator
+{
+ public:
+    /// Descriptor type and the average number of descriptors of that type per set
+    using PoolRatios = std::vector<std::pair<VkDescriptorType, float>>;
+
+    /// Type mix suitable for uniform buffers, storage buffers and sampled images
+    static const PoolRatios& defaultRatios();
+    /// Number of descriptors of each type in one set of a layout made from aBindings
+    static PoolRatios layout_counts(const std::vector<VkDescriptorSetLayoutBinding>& aBindings);
+
+    DescriptorAllocator(){}
+    DescriptorAllocator(const VkDevice& aDevice, const PoolRatios& aRatios = defaultRatios(), uint32_t aInitialSetsPerPool = 16U);
+    ~DescriptorAllocator();
+
+    DescriptorAllocator(const DescriptorAllocator&) = delete;
+    DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+    DescriptorAllocator(DescriptorAllocator&& aOther);
+    DescriptorAllocator& operator=(DescriptorAllocator&& aOther);
+
+    /// Set the device pools are created on. Must be called before allocate() if default constructed.
+    void setDevice(const VkDevice& aDevice);
+    const VkDevice& getDevice() const {return(mDevice);}
+
+    /// Raise the type mix to at least aLayoutCounts per set. Pools that already exist keep their old sizes.
+    void fitLayout(const PoolRatios& aLayoutCounts);
+    void fitLayout(const std::vector<VkDescriptorSetLayoutBinding>& aBindings) {fitLayout(layout_counts(aBindings));}
+    const PoolRatios& getRatios() const {return(mRatios);}
+
+    /** Allocate a set with aLayout, moving on through the pool chain until one has room. Throws if a newly
+     * created pool still can't hold the set, which means the layout was never passed to fitLayout().
+    */
+    VkDescriptorSet allocate(VkDescriptorSetLayout aLayout);
+
+    /// Return every set allocated so far to its pool. Sets from before the reset must no longer be in use.
+    void reset();
+
+    /// Destroy all pools
+    void destroy();
+
+    size_t getPoolCount() const {return(mUsedPools.size() + mFreePools.size());}
+    size_t getAllocatedSetCount() const {return(mAllocatedSets);}
+
+    /// Number of sets the next new pool will be sized for
+    uint32_t getNextPoolSize() const {return(mSetsPerPool);}
+
+ protected:
+    VkDescriptorPool grabPool(bool& aCreatedOut);
+    VkDescriptorPool createPool(uint32_t aSetCount) const;
+
+    static const uint32_t sMaxSetsPerPool = 4096U;
+
+    VkDevice mDevice = VK_NULL_HANDLE;
+    PoolRatios mRatios;
+    uint32_t mSetsPerPool = 16U;
+    VkDescriptorPool mCurrentPool = VK_NULL_HANDLE;
+    std::vector<VkDescriptorPool> mUsedPools;
+    std::vector<VkDescriptorPool> mFreePools;
+    size_t mAllocatedSets = 0;
+};
+
+/// Contents of a single descriptor binding, used to identify a descriptor set in DescriptorSetCache
+struct DescriptorBinding
+{
+    uint32_t binding = 0;
+    VkDescriptorType type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    VkDescriptorBufferInfo bufferInfo = {};
+    VkDescriptorImageInfo imageInfo = {};
+
+    static DescriptorBinding buffer(uint32_t aBinding, VkDescriptorType aType, const VkDescriptorBufferInfo& aInfo);
+    static DescriptorBinding image(uint32_t aBinding, VkDescriptorType aType, const VkDescriptorImageInfo& aInfo);
+
+    bool isImage() const;
+    bool operator==(const DescriptorBinding& aOther) const;
+    bool operator!=(const DescriptorBinding& aOther) const {return(!(*this == aOther));}
+};
+
+/** Cache of immutable descriptor sets keyed by their layout and the resources bound to them.
+ * Requesting a set with the same layout and bindings as an earlier request returns the earlier set without
+ * allocating or writing anything, so rebuilding the render setup (on resize, new uniforms, new objects)
+ * only writes descriptors for sets whose contents actually changed. Each layout gets its own pool chain,
+ * sized for that layout, so forgetLayout() can return its sets' pool memory without touching other layouts.
+*/
+class DescriptorSetCache
+{
+ public:
+    struct Stats
+    {
+        size_t setsWritten = 0;
+        size_t cacheHits = 0;
+    };
+
+    DescriptorSetCache(){}
+    DescriptorSetCache(const VkDevice& aDevice) {setDevice(aDevice);}
+
+    DescriptorSetCache(const DescriptorSetCache&) = delete;
+    DescriptorSetCache& operator=(const DescriptorSetCache&) = delete;
+
+    void setDevice(const VkDevice& aDevice);
+    const VkDevice& getDevice() const {return(mDevice);}
+
+    /// Get a set with aLayout whose bindings hold exactly aBindings, allocating and writing one if none exists yet
+    VkDescriptorSet getOrCreate(VkDescriptorSetLayout aLayout, const std::vector<DescriptorBinding>& aBindings);
+    /// As above, but new sets are written in one call through aTemplate, which must have been created for aLayout
+    VkDescriptorSet getOrCreate(const DescriptorUpdateTemplate& aTemplate, const std::vector<DescriptorBinding>& aBindings);
+
+    /// Drop cached sets using aLayout and destroy their pools, e.g. before the layout is destroyed. The sets must no longer be in use.
+    void forgetLayout(VkDescriptorSetLayout aLayout);
+
+    /// Release all cached sets and destroy the backing pools
+    void clear();
+
+    size_t size() const {return(mSets.size());}
+    /// Pools across the chains of every layout
+    size_t getPoolCount() const;
+    const Stats& getStats() const {return(mStats);}
+
+    /// Hash of a layout and its bindings, as used to key the cache
+    static size_t hashKey(VkDescriptorSetLayout aLayout, const std::vector<DescriptorBinding>& aBindings);
+
+ protected:
+    struct SetKey
+    {
+        VkDescriptorSetLayout layout;
+        std::vector<DescriptorBinding> bindings;
+        bool operator==(const SetKey& aOther) const {return(layout == aOther.layout && bindings == aOther.bindings);}
+    };
+    struct SetKeyHash
+    {
+        size_t operator()(const SetKey& aKey) const {return(hashKey(aKey.layout, aKey.bindings));}
+    };
+
+    VkDescriptorSet findOrAllocate(SetKey&& aKey, const DescriptorAllocator::PoolRatios& aLayoutCounts, bool& aAllocatedOut);
+    void writeSet(VkDescriptorSet aSet, const std::vector<DescriptorBinding>& aBindings) const;
+
+    VkDevice mDevice = VK_NULL_HANDLE;
+    std::unordered_map<VkDescriptorSetLayout, DescriptorAllocator> mAllocators; // Pool chain of each layout
+    std::vector<DescriptorPayload> mScratchPayload;
+    std::unordered_map<SetKey, VkDescriptorSet, SetKeyHash> mSets;
+    Stats mStats;
+};
+
+} // end namespace vkutils
+
+#endif
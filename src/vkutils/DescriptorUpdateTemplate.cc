@@ -0,0 +1,91 @@
+#include "DescriptorUpdateTemplate.h"
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace vkutils{
+
+DescriptorUpdateTemplate::~DescriptorUpdateTemplate(){
+    destroy();
+}
+
+void DescriptorUpdateTemplate::create(const VkDevice& aDevice, VkDescriptorSetLayout aLayout, const std::vector<VkDescriptorSetLayoutBinding>& aBindings){
+    destroy();
+
+    mEntries = buildEntries(aBindings);
+    mPayloadCount = 0;
+    for(const VkDescriptorUpdateTemplateEntry& entry : mEntries){
+        mPayloadCount += entry.descriptorCount;
+    }
+
+    VkDescriptorUpdateTemplateCreateInfo createInfo;
+    {
+        createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+        createInfo.pNext = nullptr;
+        createInfo.flags = 0;
+        createInfo.descriptorUpdateEntryCount = mEntries.size();
+        createInfo.pDescriptorUpdateEntries = mEntries.data();
+        createInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+        createInfo.descriptorSetLayout = aLayout;
+        // Only used for push descriptor templates
+        createInfo.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        createInfo.pipelineLayout = VK_NULL_HANDLE;
+        createInfo.set = 0;
+    }
+
+    if(vkCreateDescriptorUpdateTemplate(aDevice, &createInfo, nullptr, &mTemplate) != VK_SUCCESS){
+        mTemplate = VK_NULL_HANDLE;
+        throw std::runtime_error("Failed to create descriptor update template!");
+    }
+    mDevice = aDevice;
+    mLayout = aLayout;
+}
+
+void DescriptorUpdateTemplate::destroy(){
+    if(mTemplate != VK_NULL_HANDLE){
+        vkDestroyDescriptorUpdateTemplate(mDevice, mTemplate, nullptr);
+        mTemplate = VK_NULL_HANDLE;
+    }
+    mLayout = VK_NULL_HANDLE;
+    mEntries.clear();
+    mPayloadCount = 0;
+}
+
+size_t DescriptorUpdateTemplate::getSlot(uint32_t aBinding, uint32_t aArrayElement) const{
+    for(const VkDescriptorUpdateTemplateEntry& entry : mEntries){
+        if(entry.dstBinding == aBinding && aArrayElement < entry.descriptorCount){
+            return(entry.offset / sizeof(DescriptorPayload) + aArrayElement);
+        }
+    }
+    return(mPayloadCount);
+}
+
+void DescriptorUpdateTemplate::update(VkDescriptorSet aSet, const DescriptorPayload* aPayload) const{
+    assert(mTemplate != VK_NULL_HANDLE);
+    vkUpdateDescriptorSetWithTemplate(mDevice, aSet, mTemplate, aPayload);
+}
+
+std::vector<VkDescriptorUpdateTemplateEntry> DescriptorUpdateTemplate::buildEntries(const std::vector<VkDescriptorSetLayoutBinding>& aBindings){
+    std::vector<VkDescriptorSetLayoutBinding> sorted = aBindings;
+    auto bindingLess = [](const VkDescriptorSetLayoutBinding& lhs, const VkDescriptorSetLayoutBinding& rhs) -> bool {return(lhs.binding < rhs.binding);};
+    std::sort(sorted.begin(), sorted.end(), bindingLess);
+
+    std::vector<VkDescriptorUpdateTemplateEntry> entries;
+    entries.reserve(sorted.size());
+    size_t slot = 0;
+    for(const VkDescriptorSetLayoutBinding& binding : sorted){
+        if(binding.descriptorCount == 0) continue;
+        entries.emplace_back(VkDescriptorUpdateTemplateEntry{
+            /* dstBinding = */ binding.binding,
+            /* dstArrayElement = */ 0,
+            /* descriptorCount = */ binding.descriptorCount,
+            /* descriptorType = */ binding.descriptorType,
+            /* offset = */ slot * sizeof(DescriptorPayload),
+            /* stride = */ sizeof(DescriptorPayload)
+        });
+        slot += binding.descriptorCount;
+    }
+    return(entries);
+}
+
+} // end namespace vkutils
@@ -0,0 +1,62 @@
+#ifndef DESCRIPTOR_UPDATE_TEMPLATE_H_
+#define DESCRIPTOR_UPDATE_TEMPLATE_H_
+#include <vulkan/vulkan.h>
+#include <vector>
+
+namespace vkutils{
+
+/// One descriptor's worth of update data. Arrays of these are the packed source data for DescriptorUpdateTemplate.
+union DescriptorPayload
+{
+    VkDescriptorBufferInfo buffer;
+    VkDescriptorImageInfo image;
+    VkBufferView texelBufferView;
+};
+
+/** Wrapper around VkDescriptorUpdateTemplate generated from a descriptor set layout's bindings.
+ * Every descriptor in the layout gets one DescriptorPayload slot, ordered by binding then array element,
+ * so a whole set is written by a single vkUpdateDescriptorSetWithTemplate() call reading straight from a
+ * packed array. No VkWriteDescriptorSet structures are built, which keeps per-frame descriptor churn cheap.
+*/
+class DescriptorUpdateTemplate
+{
+ public:
+    DescriptorUpdateTemplate(){}
+    ~DescriptorUpdateTemplate();
+
+    DescriptorUpdateTemplate(const DescriptorUpdateTemplate&) = delete;
+    DescriptorUpdateTemplate& operator=(const DescriptorUpdateTemplate&) = delete;
+
+    /// Create the template for sets of aLayout, which must have been created from aBindings. Throws on failure.
+    void create(const VkDevice& aDevice, VkDescriptorSetLayout aLayout, const std::vector<VkDescriptorSetLayoutBinding>& aBindings);
+    void destroy();
+
+    bool isValid() const {return(mTemplate != VK_NULL_HANDLE);}
+    VkDescriptorUpdateTemplate handle() const {return(mTemplate);}
+    VkDescriptorSetLayout getLayout() const {return(mLayout);}
+
+    const std::vector<VkDescriptorUpdateTemplateEntry>& getEntries() const {return(mEntries);}
+
+    /// Number of DescriptorPayload slots a source array for update() must hold
+    size_t getPayloadCount() const {return(mPayloadCount);}
+
+    /// Slot in the payload array for aArrayElement of aBinding. Returns getPayloadCount() if aBinding is not in the layout.
+    size_t getSlot(uint32_t aBinding, uint32_t aArrayElement = 0) const;
+
+    /// Write every descriptor of aSet from aPayload, an array of getPayloadCount() slots
+    void update(VkDescriptorSet aSet, const DescriptorPayload* aPayload) const;
+
+    /// Template entries with packed offsets for aBindings. Exposed for testing.
+    static std::vector<VkDescriptorUpdateTemplateEntry> buildEntries(const std::vector<VkDescriptorSetLayoutBinding>& aBindings);
+
+ protected:
+    VkDevice mDevice = VK_NULL_HANDLE;
+    VkDescriptorSetLayout mLayout = VK_NULL_HANDLE;
+    VkDescriptorUpdateTemplate mTemplate = VK_NULL_HANDLE;
+    std::vector<VkDescriptorUpdateTemplateEntry> mEntries;
+    size_t mPayloadCount = 0;
+};
+
+} // end namespace vkutils
+
+#endif
@@ -0,0 +1,207 @@
+#include "DeviceFeatureSet.h"
+#include "VulkanDevices.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace vkutils{
+
+/// Run of consecutive VkBool32 members within a feature struct
+struct BoolRange
+{
+    size_t offset;
+    size_t count;
+};
+
+#define BOOL_RANGE(StructType, first, last) BoolRange{offsetof(StructType, first), (offsetof(StructType, last) - offsetof(StructType, first)) / sizeof(VkBool32) + 1}
+
+static const BoolRange sCoreRange = BOOL_RANGE(VkPhysicalDeviceFeatures, robustBufferAccess, inheritedQueries);
+static const BoolRange sVulkan11Range = BOOL_RANGE(VkPhysicalDeviceVulkan11Features, storageBuffer16BitAccess, shaderDrawParameters);
+static const BoolRange sVulkan12Range = BOOL_RANGE(VkPhysicalDeviceVulkan12Features, samplerMirrorClampToEdge, subgroupBroadcastDynamicId);
+static const BoolRange sVulkan13Range = BOOL_RANGE(VkPhysicalDeviceVulkan13Features, robustImageAccess, maintenance4);
+
+// The pre-1.2 extension structs share member order with a run of the core structs
+static const BoolRange s16BitStorageInVulkan11 = BOOL_RANGE(VkPhysicalDeviceVulkan11Features, storageBuffer16BitAccess, storageInputOutput16);
+static const BoolRange sDescriptorIndexingInVulkan12 = BOOL_RANGE(VkPhysicalDeviceVulkan12Features, shaderInputAttachmentArrayDynamicIndexing, runtimeDescriptorArray);
+
+#undef BOOL_RANGE
+
+static VkBool32* bools_at(void* aStruct, const BoolRange& aRange){
+    return(reinterpret_cast<VkBool32*>(static_cast<char*>(aStruct) + aRange.offset));
+}
+static const VkBool32* bools_at(const void* aStruct, const BoolRange& aRange){
+    return(reinterpret_cast<const VkBool32*>(static_cast<const char*>(aStruct) + aRange.offset));
+}
+
+static size_t count_range(const void* aStruct, const BoolRange& aRange){
+    const VkBool32* bools = bools_at(aStruct, aRange);
+    return(std::count_if(bools, bools + aRange.count, [](VkBool32 b){return(b != VK_FALSE);}));
+}
+
+static void merge_range(void* aDst, const void* aSrc, const BoolRange& aRange){
+    VkBool32* dst = bools_at(aDst, aRange);
+    const VkBool32* src = bools_at(aSrc, aRange);
+    for(size_t i = 0; i < aRange.count; ++i){
+        dst[i] = (dst[i] || src[i]) ? VK_TRUE : VK_FALSE;
+    }
+}
+
+/// AND aAvailable into aRequested, returning the number of requested features that were dropped
+static size_t intersect_range(void* aRequested, const void* aAvailable, const BoolRange& aRange){
+    VkBool32* requested = bools_at(aRequested, aRange);
+    const VkBool32* available = bools_at(aAvailable, aRange);
+    size_t dropped = 0;
+    for(size_t i = 0; i < aRange.count; ++i){
+        if(requested[i] && !available[i]) ++dropped;
+        requested[i] = (requested[i] && available[i]) ? VK_TRUE : VK_FALSE;
+    }
+    return(dropped);
+}
+
+DeviceFeatureSet::DeviceFeatureSet(uint32_t aApiVersion) : mApiVersion(aApiVersion) {
+    mFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    mVulkan11.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+    mVulkan12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    mVulkan13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    m16BitStorage.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES;
+    mDescriptorIndexing.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    mTimelineSemaphore.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+}
+
+DeviceFeatureSet::DeviceFeatureSet(const DeviceFeatureSet& aOther){
+    *this = aOther;
+}
+
+DeviceFeatureSet& DeviceFeatureSet::operator=(const DeviceFeatureSet& aOther){
+    mApiVersion = aOther.mApiVersion;
+    mHasDescriptorIndexingExt = aOther.mHasDescriptorIndexingExt;
+    mHasTimelineSemaphoreExt = aOther.mHasTimelineSemaphoreExt;
+    mFeatures2 = aOther.mFeatures2;
+    mVulkan11 = aOther.mVulkan11;
+    mVulkan12 = aOther.mVulkan12;
+    mVulkan13 = aOther.mVulkan13;
+    m16BitStorage = aOther.m16BitStorage;
+    mDescriptorIndexing = aOther.mDescriptorIndexing;
+    mTimelineSemaphore = aOther.mTimelineSemaphore;
+    // pNext pointers refer to the other object, so the chain is rebuilt on demand by getChain()
+    mFeatures2.pNext = nullptr;
+    return(*this);
+}
+
+DeviceFeatureSet DeviceFeatureSet::query(const VulkanPhysicalDevice& aDevice, uint32_t aInstanceApiVersion){
+    DeviceFeatureSet available(std::min(aInstanceApiVersion, aDevice.mProperites.apiVersion));
+    available.setExtensionSupport(
+        aDevice.hasExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME),
+        aDevice.hasExtension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)
+    );
+
+    if(available.mApiVersion >= VK_API_VERSION_1_1){
+        available.linkChain(true);
+        vkGetPhysicalDeviceFeatures2(aDevice.handle(), &available.mFeatures2);
+        available.copyFromExtensionStructs();
+    }else{
+        available.core() = aDevice.mFeatures;
+    }
+    return(available);
+}
+
+DeviceFeatureSet DeviceFeatureSet::intersect(const DeviceFeatureSet& aRequested, const DeviceFeatureSet& aAvailable, size_t* aDroppedOut){
+    DeviceFeatureSet result = aRequested;
+    result.mApiVersion = aAvailable.mApiVersion;
+    result.mHasDescriptorIndexingExt = aAvailable.mHasDescriptorIndexingExt;
+    result.mHasTimelineSemaphoreExt = aAvailable.mHasTimelineSemaphoreExt;
+
+    size_t dropped = 0;
+    dropped += intersect_range(&result.mFeatures2.features, &aAvailable.mFeatures2.features, sCoreRange);
+    dropped += intersect_range(&result.mVulkan11, &aAvailable.mVulkan11, sVulkan11Range);
+    dropped += intersect_range(&result.mVulkan12, &aAvailable.mVulkan12, sVulkan12Range);
+    dropped += intersect_range(&result.mVulkan13, &aAvailable.mVulkan13, sVulkan13Range);
+
+    if(aDroppedOut != nullptr) *aDroppedOut = dropped;
+    return(result);
+}
+
+void DeviceFeatureSet::merge(const DeviceFeatureSet& aOther){
+    merge_range(&mFeatures2.features, &aOther.mFeatures2.features, sCoreRange);
+    merge_range(&mVulkan11, &aOther.mVulkan11, sVulkan11Range);
+    merge_range(&mVulkan12, &aOther.mVulkan12, sVulkan12Range);
+    merge_range(&mVulkan13, &aOther.mVulkan13, sVulkan13Range);
+}
+
+size_t DeviceFeatureSet::count() const{
+    return(
+        count_range(&mFeatures2.features, sCoreRange) + count_range(&mVulkan11, sVulkan11Range) +
+        count_range(&mVulkan12, sVulkan12Range) + count_range(&mVulkan13, sVulkan13Range)
+    );
+}
+
+const void* DeviceFeatureSet::getChain(){
+    copyToExtensionStructs();
+    linkChain(false);
+    if(mApiVersion < VK_API_VERSION_1_1) return(mFeatures2.pNext);
+    return(&mFeatures2);
+}
+
+std::vector<std::string> DeviceFeatureSet::getRequiredExtensions() const{
+    std::vector<std::string> extensions;
+    if(mApiVersion >= VK_API_VERSION_1_2) return(extensions);
+
+    if(mHasDescriptorIndexingExt && count_range(&mVulkan12, sDescriptorIndexingInVulkan12) > 0){
+        extensions.emplace_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    }
+    if(mHasTimelineSemaphoreExt && mVulkan12.timelineSemaphore){
+        extensions.emplace_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    }
+    return(extensions);
+}
+
+void DeviceFeatureSet::setExtensionSupport(bool aDescriptorIndexing, bool aTimelineSemaphore){
+    mHasDescriptorIndexingExt = aDescriptorIndexing;
+    mHasTimelineSemaphoreExt = aTimelineSemaphore;
+}
+
+void DeviceFeatureSet::linkChain(bool aForQuery){
+    mFeatures2.pNext = nullptr;
+    mVulkan11.pNext = nullptr;
+    mVulkan12.pNext = nullptr;
+    mVulkan13.pNext = nullptr;
+    m16BitStorage.pNext = nullptr;
+    mDescriptorIndexing.pNext = nullptr;
+    mTimelineSemaphore.pNext = nullptr;
+
+    void** tail = &mFeatures2.pNext;
+    auto append = [&tail](void* aStruct, void** aNext){*tail = aStruct; tail = aNext;};
+
+    if(mApiVersion >= VK_API_VERSION_1_2){
+        append(&mVulkan11, &mVulkan11.pNext);
+        append(&mVulkan12, &mVulkan12.pNext);
+        if(mApiVersion >= VK_API_VERSION_1_3) append(&mVulkan13, &mVulkan13.pNext);
+        return;
+    }
+
+    // Vulkan 1.1 has 16-bit storage in core, but not the aggregate VkPhysicalDeviceVulkan11Features
+    if(mApiVersion >= VK_API_VERSION_1_1) append(&m16BitStorage, &m16BitStorage.pNext);
+
+    // Extension structs are only chained when creating a device if some feature in them is enabled
+    const bool wantIndexing = aForQuery || count_range(&mVulkan12, sDescriptorIndexingInVulkan12) > 0;
+    const bool wantTimeline = aForQuery || mVulkan12.timelineSemaphore;
+    if(mHasDescriptorIndexingExt && wantIndexing) append(&mDescriptorIndexing, &mDescriptorIndexing.pNext);
+    if(mHasTimelineSemaphoreExt && wantTimeline) append(&mTimelineSemaphore, &mTimelineSemaphore.pNext);
+}
+
+void DeviceFeatureSet::copyFromExtensionStructs(){
+    if(mApiVersion >= VK_API_VERSION_1_2) return;
+    std::memcpy(bools_at(&mVulkan11, s16BitStorageInVulkan11), &m16BitStorage.storageBuffer16BitAccess, s16BitStorageInVulkan11.count * sizeof(VkBool32));
+    std::memcpy(bools_at(&mVulkan12, sDescriptorIndexingInVulkan12), &mDescriptorIndexing.shaderInputAttachmentArrayDynamicIndexing, sDescriptorIndexingInVulkan12.count * sizeof(VkBool32));
+    mVulkan12.descriptorIndexing = count_range(&mVulkan12, sDescriptorIndexingInVulkan12) > 0 ? VK_TRUE : VK_FALSE;
+    mVulkan12.timelineSemaphore = mTimelineSemaphore.timelineSemaphore;
+}
+
+void DeviceFeatureSet::copyToExtensionStructs(){
+    if(mApiVersion >= VK_API_VERSION_1_2) return;
+    std::memcpy(&m16BitStorage.storageBuffer16BitAccess, bools_at(&mVulkan11, s16BitStorageInVulkan11), s16BitStorageInVulkan11.count * sizeof(VkBool32));
+    std::memcpy(&mDescriptorIndexing.shaderInputAttachmentArrayDynamicIndexing, bools_at(&mVulkan12, sDescriptorIndexingInVulkan12), sDescriptorIndexingInVulkan12.count * sizeof(VkBool32));
+    mTimelineSemaphore.timelineSemaphore = mVulkan12.timelineSemaphore;
+}
+
+} // end namespace vkutils
@@ -0,0 +1,89 @@
+#ifndef DEVICE_FEATURE_SET_H_
+#define DEVICE_FEATURE_SET_H_
+#include <vulkan/vulkan.h>
+#include <string>
+#include <vector>
+
+class VulkanPhysicalDevice;
+
+namespace vkutils{
+
+/** Complete set of device features, covering VkPhysicalDeviceFeatures and the Vulkan 1.1, 1.2 and 1.3 feature structs.
+ * Features are always read and written through the core structs returned by core(), vulkan11(), vulkan12() and vulkan13().
+ * When the API version in use is below 1.2, getChain() maps the 1.1/1.2 fields onto the equivalent extension structs
+ * (16-bit storage, VK_EXT_descriptor_indexing, VK_KHR_timeline_semaphore) so the same request works on older devices.
+ *
+ * Typical use: fill in a requested set, query() the available set from the device, intersect() the two, and pass
+ * the result's getChain() as the pNext of VkDeviceCreateInfo along with its getEnabledFeatures() and getRequiredExtensions().
+*/
+class DeviceFeatureSet
+{
+ public:
+    DeviceFeatureSet(uint32_t aApiVersion = VK_API_VERSION_1_0);
+    DeviceFeatureSet(const DeviceFeatureSet& aOther);
+    DeviceFeatureSet& operator=(const DeviceFeatureSet& aOther);
+
+    /// Features supported by aDevice, limited to those usable with an instance created for aInstanceApiVersion
+    static DeviceFeatureSet query(const VulkanPhysicalDevice& aDevice, uint32_t aInstanceApiVersion);
+
+    /** Features both requested and available. The result takes the API version and extension support of aAvailable.
+     * If aDroppedOut is given, it receives the number of requested features which are not available.
+    */
+    static DeviceFeatureSet intersect(const DeviceFeatureSet& aRequested, const DeviceFeatureSet& aAvailable, size_t* aDroppedOut = nullptr);
+
+    uint32_t getApiVersion() const {return(mApiVersion);}
+
+    VkPhysicalDeviceFeatures& core() {return(mFeatures2.features);}
+    const VkPhysicalDeviceFeatures& core() const {return(mFeatures2.features);}
+    VkPhysicalDeviceVulkan11Features& vulkan11() {return(mVulkan11);}
+    const VkPhysicalDeviceVulkan11Features& vulkan11() const {return(mVulkan11);}
+    VkPhysicalDeviceVulkan12Features& vulkan12() {return(mVulkan12);}
+    const VkPhysicalDeviceVulkan12Features& vulkan12() const {return(mVulkan12);}
+    VkPhysicalDeviceVulkan13Features& vulkan13() {return(mVulkan13);}
+    const VkPhysicalDeviceVulkan13Features& vulkan13() const {return(mVulkan13);}
+
+    /// Enable every feature enabled in aOther, in addition to those already enabled
+    void merge(const DeviceFeatureSet& aOther);
+
+    /// Number of features set to true across all structs
+    size_t count() const;
+
+    /** VkPhysicalDeviceFeatures2 heading a pNext chain of the structs appropriate for the API version.
+     * Vulkan 1.0 can't take VkPhysicalDeviceFeatures2 in VkDeviceCreateInfo::pNext, so there the chain only holds
+     * the extension structs in use, if any, and the core features must be passed as getEnabledFeatures() instead.
+     * The chain points into this object, so it must outlive any use of the returned pointer.
+    */
+    const void* getChain();
+
+    /// Core features for VkDeviceCreateInfo::pEnabledFeatures. nullptr when getChain() already carries them.
+    const VkPhysicalDeviceFeatures* getEnabledFeatures() const {return(mApiVersion >= VK_API_VERSION_1_1 ? nullptr : &mFeatures2.features);}
+
+    /// Device extensions that must be enabled for the features in the chain. Empty for API version 1.2 and later.
+    std::vector<std::string> getRequiredExtensions() const;
+
+    /// Record which feature extensions the device offers. Only these are chained for API versions below 1.2.
+    void setExtensionSupport(bool aDescriptorIndexing, bool aTimelineSemaphore);
+
+ protected:
+    void linkChain(bool aForQuery);
+    void copyFromExtensionStructs();
+    void copyToExtensionStructs();
+
+    uint32_t mApiVersion = VK_API_VERSION_1_0;
+    bool mHasDescriptorIndexingExt = false;
+    bool mHasTimelineSemaphoreExt = false;
+
+    VkPhysicalDeviceFeatures2 mFeatures2 = {};
+    VkPhysicalDeviceVulkan11Features mVulkan11 = {};
+    VkPhysicalDeviceVulkan12Features mVulkan12 = {};
+    VkPhysicalDeviceVulkan13Features mVulkan13 = {};
+
+    // Pre-1.2 equivalents of parts of mVulkan11 and mVulkan12
+    VkPhysicalDevice16BitStorageFeatures m16BitStorage = {};
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT mDescriptorIndexing = {};
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR mTimelineSemaphore = {};
+};
+
+} // end namespace vkutils
+
+#endif
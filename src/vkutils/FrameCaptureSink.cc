@@ -0,0 +1,281 @@
+#include "FrameCaptureSink.h"
+#include "utils/CpuProfiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace vkutils{
+
+static uint8_t unorm_to_byte(float aValue){
+    return(static_cast<uint8_t>(std::min(std::max(aValue, 0.0f), 1.0f) * 255.0f + 0.5f));
+}
+
+static float half_to_float(uint16_t aHalf){
+    const int exponent = (aHalf >> 10) & 0x1F;
+    const int mantissa = aHalf & 0x3FF;
+    float magnitude = 0.0f;
+    if(exponent == 0){
+        magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+    }else if(exponent == 31){
+        magnitude = mantissa == 0 ? INFINITY : 0.0f; // NaN is written as black
+    }else{
+        magnitude = std::ldexp(static_cast<float>(mantissa | 0x400), exponent - 25);
+    }
+    return((aHalf & 0x8000) ? -magnitude : magnitude);
+}
+
+FrameCaptureSink::~FrameCaptureSink(){
+    close();
+}
+
+bool FrameCaptureSink::convert_to_rgb8(VkFormat aFormat, const uint8_t* aSrc, size_t aTexelCount, uint8_t* aDst){
+    switch(aFormat){
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+            for(size_t i = 0; i < aTexelCount; ++i, aSrc += 4, aDst += 3){
+                aDst[0] = aSrc[2]; aDst[1] = aSrc[1]; aDst[2] = aSrc[0];
+            }
+            return(true);
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            for(size_t i = 0; i < aTexelCount; ++i, aSrc += 4, aDst += 3){
+                aDst[0] = aSrc[0]; aDst[1] = aSrc[1]; aDst[2] = aSrc[2];
+            }
+            return(true);
+        case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
+        case VK_FORMAT_A2B10G10R10_UNORM_PACK32:{
+            // Red is in the high bits for A2R10G10B10 and the low bits for A2B10G10R10
+            const int redShift = aFormat == VK_FORMAT_A2R10G10B10_UNORM_PACK32 ? 20 : 0;
+            for(size_t i = 0; i < aTexelCount; ++i, aSrc += 4, aDst += 3){
+                uint32_t texel;
+                std::memcpy(&texel, aSrc, sizeof(texel));
+                aDst[0] = static_cast<uint8_t>(((texel >> redShift) & 0x3FF) >> 2);
+                aDst[1] = static_cast<uint8_t>(((texel >> 10) & 0x3FF) >> 2);
+                aDst[2] = static_cast<uint8_t>(((texel >> (20 - redShift)) & 0x3FF) >> 2);
+            }
+            return(true);
+        }
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+            for(size_t i = 0; i < aTexelCount; ++i, aSrc += 8, aDst += 3){
+                uint16_t texel[3];
+                std::memcpy(texel, aSrc, sizeof(texel));
+                for(int c = 0; c < 3; ++c) aDst[c] = unorm_to_byte(half_to_float(texel[c]));
+            }
+            return(true);
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            for(size_t i = 0; i < aTexelCount; ++i, aSrc += 16, aDst += 3){
+                float texel[3];
+                std::memcpy(texel, aSrc, sizeof(texel));
+                for(int c = 0; c < 3; ++c) aDst[c] = unorm_to_byte(texel[c]);
+            }
+            return(true);
+        default:
+            return(false);
+    }
+}
+
+void FrameCaptureSink::rgb8_to_yuv444(const uint8_t* aRgb, size_t aTexelCount, uint8_t* aY, uint8_t* aU, uint8_t* aV){
+    for(size_t i = 0; i < aTexelCount; ++i, aRgb += 3){
+        const int r = aRgb[0], g = aRgb[1], b = aRgb[2];
+        aY[i] = static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        aU[i] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        aV[i] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+}
+
+void FrameCaptureSink::open(const FrameCaptureConfig& aConfig){
+    close();
+    if(aConfig.queueDepth == 0 || aConfig.converterCount == 0 || aConfig.fps == 0){
+        throw std::runtime_error("FrameCaptureSink Error: Queue depth, converter count and frame rate must be non-zero!");
+    }
+
+    mConfig = aConfig;
+    mPerFrameFiles = mConfig.format == CAPTURE_FORMAT_PPM && mConfig.path.find('%') != std::string::npos;
+    if(mConfig.path == "-"){
+        mFile = stdout;
+    }else if(!mPerFrameFiles){
+        mFile = std::fopen(mConfig.path.c_str(), "wb");
+        if(mFile == nullptr){
+            throw std::runtime_error("FrameCaptureSink Error: Unable to open '" + mConfig.path + "' for writing!");
+        }
+    }
+
+    mHeaderWritten = false;
+    mStreamExtent = {0, 0};
+    mNextSequence = 0;
+    mNextWrite = 0;
+    mQueued = 0;
+    mStopping = false;
+    for(uint32_t i = 0; i < mConfig.converterCount; ++i){
+        mConverters.emplace_back(&FrameCaptureSink::converterLoop, this);
+    }
+    mWriter = std::thread(&FrameCaptureSink::writerLoop, this);
+}
+
+void FrameCaptureSink::close(){
+    if(!isOpen()) return;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mJobSignal.notify_all();
+    mSpaceSignal.notify_all();
+    // Converters drain the job queue before exiting, after which the writer can drain the rest
+    for(std::thread& converter : mConverters){
+        converter.join();
+    }
+    mConverters.clear();
+    mWriteSignal.notify_all();
+    mWriter.join();
+
+    if(mFile == stdout){
+        std::fflush(mFile);
+    }else if(mFile != nullptr){
+        std::fclose(mFile);
+    }
+    mFile = nullptr;
+}
+
+bool FrameCaptureSink::push(const ReadbackFrame& aFrame){
+    if(!isOpen() || aFrame.data == nullptr){
+        ++mDropped;
+        return(false);
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    if(mStreamExtent.width == 0){
+        mStreamExtent = aFrame.extent;
+    }else if(aFrame.extent.width != mStreamExtent.width || aFrame.extent.height != mStreamExtent.height){
+        ++mDropped;
+        return(false);
+    }
+
+    if(mConfig.overflow == CAPTURE_OVERFLOW_BLOCK){
+        mSpaceSignal.wait(lock, [this](){return(mStopping || mQueued < mConfig.queueDepth);});
+    }
+    if(mStopping || mQueued >= mConfig.queueDepth){
+        ++mDropped;
+        return(false);
+    }
+    ++mQueued;
+    const uint64_t sequence = mNextSequence++;
+    lock.unlock();
+
+    // Copy outside the lock so other pushes and the workers aren't held up
+    std::unique_ptr<Job> job(new Job());
+    job->sequence = sequence;
+    job->extent = aFrame.extent;
+    job->format = aFrame.format;
+    job->rowPitch = aFrame.rowPitch;
+    job->pixels.assign(aFrame.data, aFrame.data + aFrame.size);
+
+    lock.lock();
+    mJobs.push_back(std::move(job));
+    lock.unlock();
+    mJobSignal.notify_one();
+    return(true);
+}
+
+std::vector<uint8_t> FrameCaptureSink::encode(const Job& aJob) const{
+    CPU_PROFILE_ZONE("FrameCaptureSink::encode");
+    const size_t width = aJob.extent.width;
+    const size_t height = aJob.extent.height;
+    const size_t texelCount = width * height;
+    const uint32_t texelSize = FrameReadback::texel_size(aJob.format);
+    if(texelSize == 0 || aJob.rowPitch < width * texelSize || aJob.pixels.size() < aJob.rowPitch * height){
+        return(std::vector<uint8_t>());
+    }
+
+    std::vector<uint8_t> rgb(texelCount * 3);
+    for(size_t row = 0; row < height; ++row){
+        if(!convert_to_rgb8(aJob.format, aJob.pixels.data() + row * aJob.rowPitch, width, rgb.data() + row * width * 3)){
+            return(std::vector<uint8_t>());
+        }
+    }
+
+    if(mConfig.format == CAPTURE_FORMAT_PPM){
+        const std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+        std::vector<uint8_t> bytes(header.begin(), header.end());
+        bytes.insert(bytes.end(), rgb.begin(), rgb.end());
+        return(bytes);
+    }
+
+    const std::string header = "FRAME\n";
+    std::vector<uint8_t> bytes(header.size() + texelCount * 3);
+    std::copy(header.begin(), header.end(), bytes.begin());
+    uint8_t* planes = bytes.data() + header.size();
+    rgb8_to_yuv444(rgb.data(), texelCount, planes, planes + texelCount, planes + 2 * texelCount);
+    return(bytes);
+}
+
+void FrameCaptureSink::converterLoop(){
+    CPU_PROFILE_THREAD_NAME("Capture converter");
+    std::unique_lock<std::mutex> lock(mMutex);
+    while(true){
+        mJobSignal.wait(lock, [this](){return(mStopping || !mJobs.empty());});
+        if(mJobs.empty()) break;
+        std::unique_ptr<Job> job = std::move(mJobs.front());
+        mJobs.pop_front();
+        lock.unlock();
+
+        std::vector<uint8_t> bytes = encode(*job);
+
+        lock.lock();
+        // An empty result marks a frame that couldn't be converted, so the writer doesn't wait on it forever
+        mEncoded[job->sequence] = std::move(bytes);
+        mWriteSignal.notify_one();
+    }
+}
+
+void FrameCaptureSink::writerLoop(){
+    CPU_PROFILE_THREAD_NAME("Capture writer");
+    std::unique_lock<std::mutex> lock(mMutex);
+    while(true){
+        mWriteSignal.wait(lock, [this](){return(mEncoded.count(mNextWrite) != 0 || (mStopping && mQueued == 0));});
+        std::map<uint64_t, std::vector<uint8_t>>::iterator next = mEncoded.find(mNextWrite);
+        if(next == mEncoded.end()) break;
+        std::vector<uint8_t> bytes = std::move(next->second);
+        mEncoded.erase(next);
+        lock.unlock();
+
+        const bool written = !bytes.empty() && writeFrame(mNextWrite, bytes);
+        if(written) ++mWritten; else ++mDropped;
+
+        lock.lock();
+        ++mNextWrite;
+        --mQueued;
+        mSpaceSignal.notify_all();
+    }
+}
+
+bool FrameCaptureSink::writeFrame(uint64_t aSequence, const std::vector<uint8_t>& aBytes){
+    CPU_PROFILE_ZONE("FrameCaptureSink::writeFrame");
+    if(mPerFrameFiles){
+        // Number files by frames written so a dropped frame doesn't leave a gap encoders would stop at
+        std::vector<char> path(mConfig.path.size() + 32);
+        std::snprintf(path.data(), path.size(), mConfig.path.c_str(), static_cast<int>(mWritten.load()));
+        std::FILE* file = std::fopen(path.data(), "wb");
+        if(file == nullptr){
+            std::cerr << "Warning: Frame capture unable to open '" << path.data() << "'" << std::endl;
+            return(false);
+        }
+        const bool complete = std::fwrite(aBytes.data(), 1, aBytes.size(), file) == aBytes.size();
+        return(std::fclose(file) == 0 && complete);
+    }
+
+    if(mConfig.format == CAPTURE_FORMAT_Y4M && !mHeaderWritten){
+        const std::string header = "YUV4MPEG2 W" + std::to_string(mStreamExtent.width) + " H" + std::to_string(mStreamExtent.height)
+            + " F" + std::to_string(mConfig.fps) + ":1 Ip A1:1 C444\n";
+        if(std::fwrite(header.data(), 1, header.size(), mFile) != header.size()) return(false);
+        mHeaderWritten = true;
+    }
+    if(std::fwrite(aBytes.data(), 1, aBytes.size(), mFile) != aBytes.size()){
+        std::cerr << "Warning: Frame capture failed to write frame " << aSequence << std::endl;
+        return(false);
+    }
+    return(true);
+}
+
+} // end namespace vkutils
@@ -0,0 +1,112 @@
+#ifndef FRAME_CAPTURE_SINK_H_
+#define FRAME_CAPTURE_SINK_H_
+#include "FrameReadback.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vkutils{
+
+enum CaptureFormatEnum{
+    CAPTURE_FORMAT_Y4M, // YUV4MPEG2 stream, 4:4:4 BT.601 limited range
+    CAPTURE_FORMAT_PPM  // Binary P6 images, concatenated into one stream or written one file per frame
+};
+
+enum CaptureOverflowEnum{
+    CAPTURE_OVERFLOW_DROP, // Drop new frames while the queue is full
+    CAPTURE_OVERFLOW_BLOCK // Make push() wait for space
+};
+
+struct FrameCaptureConfig
+{
+    CaptureFormatEnum format = CAPTURE_FORMAT_Y4M;
+    /// "-" writes to stdout. For PPM, a printf style frame number pattern such as "frame_%05d.ppm" writes one file per frame.
+    std::string path = "-";
+    uint32_t fps = 60; // Frame rate recorded in the Y4M header
+    uint32_t queueDepth = 8; // Frames waiting to be converted or written before the overflow policy applies
+    uint32_t converterCount = 2; // Colour conversion threads. Frames are still written in order.
+    CaptureOverflowEnum overflow = CAPTURE_OVERFLOW_DROP;
+};
+
+/** Streams frames from FrameReadback to Y4M or PPM for piping into an encoder. push() only copies the pixels
+ * into a bounded queue; colour conversion runs on a pool of worker threads and a single writer thread puts the
+ * results on disk in frame order. With the drop policy push() never waits on the disk. With the block policy it
+ * waits for space, which applies back pressure to the readback worker rather than to the render loop.
+ * Every frame in a stream must have the same extent as the first; others are dropped.
+*/
+class FrameCaptureSink
+{
+ public:
+    FrameCaptureSink(){}
+    ~FrameCaptureSink();
+
+    FrameCaptureSink(const FrameCaptureSink&) = delete;
+    FrameCaptureSink& operator=(const FrameCaptureSink&) = delete;
+
+    /// Open the output and start the worker threads. Throws if the output can't be opened.
+    void open(const FrameCaptureConfig& aConfig);
+    /// Write every queued frame, then stop the workers and close the output
+    void close();
+    bool isOpen() const {return(mWriter.joinable());}
+
+    /// Queue a copy of aFrame. Returns false if the frame was dropped.
+    bool push(const ReadbackFrame& aFrame);
+
+    uint64_t getWrittenFrameCount() const {return(mWritten);}
+    uint64_t getDroppedFrameCount() const {return(mDropped);}
+    const FrameCaptureConfig& getConfig() const {return(mConfig);}
+
+    /// Convert aTexelCount texels of aFormat to packed 8-bit RGB. Returns false for unsupported formats.
+    static bool convert_to_rgb8(VkFormat aFormat, const uint8_t* aSrc, size_t aTexelCount, uint8_t* aDst);
+    /// Convert packed 8-bit RGB to separate BT.601 limited range Y, Cb and Cr planes
+    static void rgb8_to_yuv444(const uint8_t* aRgb, size_t aTexelCount, uint8_t* aY, uint8_t* aU, uint8_t* aV);
+
+ protected:
+    struct Job
+    {
+        uint64_t sequence = 0;
+        VkExtent2D extent = {0, 0};
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        uint32_t rowPitch = 0;
+        std::vector<uint8_t> pixels;
+    };
+
+    void converterLoop();
+    void writerLoop();
+    std::vector<uint8_t> encode(const Job& aJob) const;
+    bool writeFrame(uint64_t aSequence, const std::vector<uint8_t>& aBytes);
+
+    FrameCaptureConfig mConfig;
+    std::FILE* mFile = nullptr;
+    bool mPerFrameFiles = false;
+    bool mHeaderWritten = false;
+    VkExtent2D mStreamExtent = {0, 0};
+
+    // Shared with the worker threads
+    std::mutex mMutex;
+    std::condition_variable mJobSignal;
+    std::condition_variable mWriteSignal;
+    std::condition_variable mSpaceSignal;
+    std::deque<std::unique_ptr<Job>> mJobs;
+    std::map<uint64_t, std::vector<uint8_t>> mEncoded; // Converted frames waiting for their turn to be written
+    uint64_t mNextSequence = 0;
+    uint64_t mNextWrite = 0;
+    size_t mQueued = 0; // Frames accepted but not yet written
+    bool mStopping = false;
+    std::vector<std::thread> mConverters;
+    std::thread mWriter;
+
+    std::atomic<uint64_t> mWritten{0};
+    std::atomic<uint64_t> mDropped{0};
+};
+
+} // end namespace vkutils
+
+#endif
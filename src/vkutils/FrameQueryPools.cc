@@ -0,0 +1,99 @@
+#include "FrameQueryPools.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace vkutils{
+
+FrameQueryPools::~FrameQueryPools(){
+    destroy();
+}
+
+void FrameQueryPools::create(VkDevice aDevice, const VkQueryPoolCreateInfo& aPoolInfo, uint32_t aSlotCount, uint32_t aMaxEntries){
+    destroy();
+    if(aSlotCount == 0 || aMaxEntries == 0){
+        throw std::runtime_error("FrameQueryPools Error: At least one slot and one entry are required!");
+    }
+    if(aMaxEntries < mEntryNames.size()){
+        throw std::runtime_error("FrameQueryPools Error: Recreated with room for fewer entries than are registered!");
+    }
+
+    mDevice = aDevice;
+    mQueryCount = aPoolInfo.queryCount;
+    mMaxEntries = aMaxEntries;
+    mPools.assign(aSlotCount, VK_NULL_HANDLE);
+    for(VkQueryPool& pool : mPools){
+        if(vkCreateQueryPool(mDevice, &aPoolInfo, nullptr, &pool) != VK_SUCCESS){
+            pool = VK_NULL_HANDLE;
+            destroy();
+            throw std::runtime_error("Failed to create query pool!");
+        }
+    }
+    mSlotFrames.assign(aSlotCount, 0);
+}
+
+void FrameQueryPools::destroy(){
+    for(VkQueryPool pool : mPools){
+        if(pool != VK_NULL_HANDLE) vkDestroyQueryPool(mDevice, pool, nullptr);
+    }
+    mPools.clear();
+    mSlotFrames.clear();
+}
+
+uint32_t FrameQueryPools::getEntry(const std::string& aName){
+    const int existing = findEntry(aName);
+    if(existing >= 0) return(static_cast<uint32_t>(existing));
+    if(isValid() && mEntryNames.size() >= mMaxEntries){
+        throw std::runtime_error("FrameQueryPools Error: No room left for '" + aName + "'!");
+    }
+    mEntryNames.push_back(aName);
+    return(static_cast<uint32_t>(mEntryNames.size() - 1));
+}
+
+int FrameQueryPools::findEntry(const std::string& aName) const{
+    std::vector<std::string>::const_iterator existing = std::find(mEntryNames.begin(), mEntryNames.end(), aName);
+    if(existing == mEntryNames.end()) return(-1);
+    return(static_cast<int>(existing - mEntryNames.begin()));
+}
+
+void FrameQueryPools::cmdResetSlot(VkCommandBuffer aCommandBuffer, uint32_t aSlot){
+    vkCmdResetQueryPool(aCommandBuffer, mPools[aSlot], 0, mQueryCount);
+}
+
+void FrameQueryPools::slotSubmitted(uint32_t aSlot, uint64_t aFrameValue){
+    // Results of an earlier frame that were never collected are overwritten by this submission
+    mSlotFrames[aSlot] = aFrameValue;
+}
+
+std::vector<uint32_t> FrameQueryPools::takeFinishedSlots(uint64_t aCompletedValue){
+    // In frame order, so results read last are from the newest frame
+    std::vector<std::pair<uint64_t, uint32_t>> finished;
+    for(uint32_t slot = 0; slot < mSlotFrames.size(); ++slot){
+        if(mSlotFrames[slot] != 0 && mSlotFrames[slot] <= aCompletedValue) finished.emplace_back(mSlotFrames[slot], slot);
+    }
+    std::sort(finished.begin(), finished.end());
+
+    std::vector<uint32_t> slots;
+    slots.reserve(finished.size());
+    for(const std::pair<uint64_t, uint32_t>& entry : finished){
+        mSlotFrames[entry.second] = 0;
+        slots.push_back(entry.second);
+    }
+    return(slots);
+}
+
+const uint64_t* FrameQueryPools::readSlot(uint32_t aSlot, uint32_t aQueryCount, uint32_t aValuesPerQuery){
+    if(aQueryCount == 0) return(nullptr);
+    const size_t stride = aValuesPerQuery + 1;
+    mResults.resize(stride * aQueryCount);
+
+    // Queries the command buffers didn't write stay unavailable, which makes the call return VK_NOT_READY
+    VkResult result = vkGetQueryPoolResults(
+        mDevice, mPools[aSlot], 0, aQueryCount, mResults.size() * sizeof(uint64_t), mResults.data(),
+        stride * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+    );
+    if(result != VK_SUCCESS && result != VK_NOT_READY) return(nullptr);
+    return(mResults.data());
+}
+
+} // end namespace vkutils
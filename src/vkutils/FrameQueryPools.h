@@ -0,0 +1,65 @@
+#ifndef FRAME_QUERY_POOLS_H_
+#define FRAME_QUERY_POOLS_H_
+#include <vulkan/vulkan.h>
+#include <string>
+#include <vector>
+
+namespace vkutils{
+
+/** Query pools for per-frame measurements, one per slot, each holding the queries of a fixed number of named
+ * entries. Command buffers write into the pool of the slot they are recorded for, and a slot is read back once
+ * the frame it was submitted with is known to be complete, so reading never waits on the GPU.
+ * Used by GpuProfiler for timestamp scopes and by PipelineStatistics for statistics batches.
+*/
+class FrameQueryPools
+{
+ public:
+    FrameQueryPools(){}
+    ~FrameQueryPools();
+
+    FrameQueryPools(const FrameQueryPools&) = delete;
+    FrameQueryPools& operator=(const FrameQueryPools&) = delete;
+
+    /** Create aSlotCount pools from aPoolInfo, with room for aMaxEntries entries. Entries are kept if recreated.
+     * Throws if there are no slots or entries, or fewer entries than are already registered.
+    */
+    void create(VkDevice aDevice, const VkQueryPoolCreateInfo& aPoolInfo, uint32_t aSlotCount, uint32_t aMaxEntries);
+    /// The device must be idle, or at least done with every command buffer writing to the pools
+    void destroy();
+    bool isValid() const {return(!mPools.empty());}
+    uint32_t getSlotCount() const {return(static_cast<uint32_t>(mPools.size()));}
+    VkQueryPool getPool(uint32_t aSlot) const {return(mPools[aSlot]);}
+
+    /// Id of the entry named aName, registering it if it's new. Throws if no room is left for another entry.
+    uint32_t getEntry(const std::string& aName);
+    /// Id of the entry named aName, or -1 if it isn't registered
+    int findEntry(const std::string& aName) const;
+    const std::vector<std::string>& getEntryNames() const {return(mEntryNames);}
+
+    /// Reset every query of aSlot, outside of a render pass
+    void cmdResetSlot(VkCommandBuffer aCommandBuffer, uint32_t aSlot);
+
+    /// Command buffers writing to aSlot were submitted as part of frame aFrameValue
+    void slotSubmitted(uint32_t aSlot, uint64_t aFrameValue);
+    /// Slots submitted with a frame value of at most aCompletedValue, oldest frame first. They count as collected.
+    std::vector<uint32_t> takeFinishedSlots(uint64_t aCompletedValue);
+
+    /** Read the first aQueryCount queries of aSlot as aValuesPerQuery 64-bit values each, followed by an
+     * availability value that is 0 for queries the command buffers didn't write. Returns nullptr on failure.
+     * The results stay valid until the next call.
+    */
+    const uint64_t* readSlot(uint32_t aSlot, uint32_t aQueryCount, uint32_t aValuesPerQuery);
+
+ protected:
+    VkDevice mDevice = VK_NULL_HANDLE;
+    std::vector<VkQueryPool> mPools;
+    std::vector<uint64_t> mSlotFrames; // Frame value each slot was last submitted with, 0 once collected
+    uint32_t mQueryCount = 0;
+    uint32_t mMaxEntries = 0;
+    std::vector<std::string> mEntryNames;
+    std::vector<uint64_t> mResults; // Reused for reading back
+};
+
+} // end namespace vkutils
+
+#endif
@@ -0,0 +1,323 @@
+#include "FrameReadback.h"
+#include "utils/CpuProfiler.h"
+#include "utils/TransferCounters.h"
+#include <iostream>
+#include <stdexcept>
+
+namespace vkutils{
+
+FrameReadback::~FrameReadback(){
+    destroy();
+}
+
+uint32_t FrameReadback::texel_size(VkFormat aFormat){
+    switch(aFormat){
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
+        case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+            return(4U);
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+            return(8U);
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            return(16U);
+        default:
+            return(0U);
+    }
+}
+
+void FrameReadback::create(const VulkanDeviceBundle& aDeviceBundle, uint32_t aQueueFamily, VkExtent2D aExtent, VkFormat aFormat, uint32_t aSlotCount){
+    destroy();
+    if(texel_size(aFormat) == 0){
+        throw std::runtime_error("FrameReadback Error: Unsupported image format " + std::to_string(aFormat) + "!");
+    }
+    if(aSlotCount == 0 || aExtent.width == 0 || aExtent.height == 0){
+        throw std::runtime_error("FrameReadback Error: At least one slot and a non-empty extent are required!");
+    }
+
+    mDevice = aDeviceBundle.logicalDevice.handle();
+    mExtent = aExtent;
+    mFormat = aFormat;
+    mRowPitch = aExtent.width * texel_size(aFormat);
+    mFrameSize = static_cast<VkDeviceSize>(mRowPitch) * aExtent.height;
+    mCoherent = true;
+
+    VkCommandPoolCreateInfo poolInfo;{
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.pNext = nullptr;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        poolInfo.queueFamilyIndex = aQueueFamily;
+    }
+    if(vkCreateCommandPool(mDevice, &poolInfo, nullptr, &mCommandPool) != VK_SUCCESS){
+        mCommandPool = VK_NULL_HANDLE;
+        throw std::runtime_error("Failed to create command pool for frame readback!");
+    }
+
+    mSlots.resize(aSlotCount);
+    try{
+        for(Slot& slot : mSlots){
+            createSlot(slot, aDeviceBundle);
+        }
+    }catch(...){
+        destroy();
+        throw;
+    }
+
+    mStopWorker = false;
+    mWorker = std::thread(&FrameReadback::workerLoop, this);
+}
+
+void FrameReadback::createSlot(Slot& aSlot, const VulkanDeviceBundle& aDeviceBundle){
+    VkBufferCreateInfo bufferInfo;{
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.pNext = nullptr;
+        bufferInfo.flags = 0;
+        bufferInfo.size = mFrameSize;
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        bufferInfo.queueFamilyIndexCount = 0;
+        bufferInfo.pQueueFamilyIndices = nullptr;
+    }
+    if(vkCreateBuffer(mDevice, &bufferInfo, nullptr, &aSlot.buffer) != VK_SUCCESS){
+        aSlot.buffer = VK_NULL_HANDLE;
+        throw std::runtime_error("Failed to create frame readback buffer!");
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(mDevice, aSlot.buffer, &memRequirements);
+    VkPhysicalDeviceMemoryProperties memoryProps;
+    vkGetPhysicalDeviceMemoryProperties(aDeviceBundle.physicalDevice.handle(), &memoryProps);
+
+    // Cached memory makes CPU reads fast. Fall back on any host visible memory.
+    const VkMemoryPropertyFlags cachedFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+    uint32_t memTypeIndex = VK_MAX_MEMORY_TYPES;
+    for(uint32_t i = 0; i < memoryProps.memoryTypeCount; ++i){
+        if(!(memRequirements.memoryTypeBits & (1 << i))) continue;
+        VkMemoryPropertyFlags flags = memoryProps.memoryTypes[i].propertyFlags;
+        if((flags & cachedFlags) == cachedFlags){
+            memTypeIndex = i;
+            break;
+        }
+        if(memTypeIndex == VK_MAX_MEMORY_TYPES && (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)){
+            memTypeIndex = i;
+        }
+    }
+    if(memTypeIndex == VK_MAX_MEMORY_TYPES){
+        throw std::runtime_error("No host visible memory type could be found for frame readback!");
+    }
+    if(!(memoryProps.memoryTypes[memTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)){
+        mCoherent = false;
+    }
+
+    VkMemoryAllocateInfo allocInfo = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, nullptr, memRequirements.size, memTypeIndex};
+    if(vkAllocateMemory(mDevice, &allocInfo, nullptr, &aSlot.memory) != VK_SUCCESS){
+        aSlot.memory = VK_NULL_HANDLE;
+        throw std::runtime_error("Failed to allocate frame readback memory!");
+    }
+    count_device_allocation(memRequirements.size);
+    vkBindBufferMemory(mDevice, aSlot.buffer, aSlot.memory, 0);
+
+    void* mapped = nullptr;
+    if(vkMapMemory(mDevice, aSlot.memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS){
+        throw std::runtime_error("Failed to map frame readback memory!");
+    }
+    aSlot.mapped = reinterpret_cast<uint8_t*>(mapped);
+
+    VkCommandBufferAllocateInfo commandInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO, nullptr, mCommandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1};
+    if(vkAllocateCommandBuffers(mDevice, &commandInfo, &aSlot.commandBuffer) != VK_SUCCESS){
+        aSlot.commandBuffer = VK_NULL_HANDLE;
+        throw std::runtime_error("Failed to allocate frame readback command buffer!");
+    }
+}
+
+void FrameReadback::destroy(){
+    if(mWorker.joinable()){
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopWorker = true;
+        }
+        mWorkerSignal.notify_all();
+        mWorker.join();
+    }
+    mReady.clear();
+    mInFlight.clear();
+
+    for(Slot& slot : mSlots){
+        if(slot.memory != VK_NULL_HANDLE){
+            if(slot.mapped != nullptr) vkUnmapMemory(mDevice, slot.memory);
+            vkFreeMemory(mDevice, slot.memory, nullptr);
+        }
+        if(slot.buffer != VK_NULL_HANDLE) vkDestroyBuffer(mDevice, slot.buffer, nullptr);
+    }
+    mSlots.clear();
+
+    // Command buffers are freed along with their pool
+    if(mCommandPool != VK_NULL_HANDLE){
+        vkDestroyCommandPool(mDevice, mCommandPool, nullptr);
+        mCommandPool = VK_NULL_HANDLE;
+    }
+}
+
+void FrameReadback::setConsumer(ConsumerFunction aConsumer){
+    std::lock_guard<std::mutex> lock(mMutex);
+    mConsumer = aConsumer;
+}
+
+VkCommandBuffer FrameReadback::recordCopy(VkImage aImage, VkImageLayout aLayout, uint64_t aFrameValue){
+    if(!isValid()) return(VK_NULL_HANDLE);
+
+    size_t slotIndex = mSlots.size();
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for(size_t i = 0; i < mSlots.size(); ++i){
+            if(mSlots[i].state == SLOT_FREE){
+                slotIndex = i;
+                mSlots[i].state = SLOT_IN_FLIGHT;
+                break;
+            }
+        }
+    }
+    if(slotIndex == mSlots.size()){
+        ++mDropped;
+        return(VK_NULL_HANDLE);
+    }
+    Slot& slot = mSlots[slotIndex];
+    slot.frameValue = aFrameValue;
+
+    VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, nullptr, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, nullptr};
+    if(vkBeginCommandBuffer(slot.commandBuffer, &beginInfo) != VK_SUCCESS){
+        throw std::runtime_error("Failed to begin frame readback command recording!");
+    }
+
+    // Wait for rendering to finish writing the image before copying it. The render pass only has the implicit
+    // dependency to VK_SUBPASS_EXTERNAL, whose destination stage is BOTTOM_OF_PIPE, so only a source scope of
+    // ALL_COMMANDS chains onto it and keeps the copy from racing the transition into the final layout.
+    VkImageMemoryBarrier toTransfer;{
+        toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        toTransfer.pNext = nullptr;
+        toTransfer.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        toTransfer.oldLayout = aLayout;
+        toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toTransfer.image = aImage;
+        toTransfer.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    }
+    vkCmdPipelineBarrier(slot.commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+    VkBufferImageCopy region;{
+        region.bufferOffset = 0;
+        region.bufferRowLength = 0; // Tightly packed
+        region.bufferImageHeight = 0;
+        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {mExtent.width, mExtent.height, 1};
+    }
+    vkCmdCopyImageToBuffer(slot.commandBuffer, aImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer, 1, &region);
+
+    // Return the image to the layout presentation or the next frame expects
+    if(aLayout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL){
+        VkImageMemoryBarrier toOriginal = toTransfer;
+        toOriginal.srcAccessMask = 0;
+        toOriginal.dstAccessMask = 0;
+        toOriginal.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        toOriginal.newLayout = aLayout;
+        vkCmdPipelineBarrier(slot.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &toOriginal);
+    }
+
+    // Make the copy visible to host reads once the frame is complete
+    VkBufferMemoryBarrier toHost;{
+        toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        toHost.pNext = nullptr;
+        toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.buffer = slot.buffer;
+        toHost.offset = 0;
+        toHost.size = VK_WHOLE_SIZE;
+    }
+    vkCmdPipelineBarrier(slot.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &toHost, 0, nullptr);
+
+    if(vkEndCommandBuffer(slot.commandBuffer) != VK_SUCCESS){
+        throw std::runtime_error("Failed to end frame readback command buffer!");
+    }
+    mInFlight.push_back(slotIndex);
+    return(slot.commandBuffer);
+}
+
+void FrameReadback::cancelCopy(VkCommandBuffer aCommandBuffer){
+    if(aCommandBuffer == VK_NULL_HANDLE || mInFlight.empty() || mSlots[mInFlight.back()].commandBuffer != aCommandBuffer) return;
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSlots[mInFlight.back()].state = SLOT_FREE;
+    mInFlight.pop_back();
+    ++mDropped;
+}
+
+void FrameReadback::collect(uint64_t aCompletedValue){
+    if(mInFlight.empty() || mSlots[mInFlight.front()].frameValue > aCompletedValue) return;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        while(!mInFlight.empty() && mSlots[mInFlight.front()].frameValue <= aCompletedValue){
+            mSlots[mInFlight.front()].state = SLOT_CONSUMING;
+            mReady.push_back(mInFlight.front());
+            mInFlight.pop_front();
+        }
+    }
+    mWorkerSignal.notify_one();
+}
+
+void FrameReadback::waitIdle(){
+    std::unique_lock<std::mutex> lock(mMutex);
+    mIdleSignal.wait(lock, [this](){return(mReady.empty() && !mConsuming);});
+}
+
+void FrameReadback::workerLoop(){
+    CPU_PROFILE_THREAD_NAME("Frame readback");
+    std::unique_lock<std::mutex> lock(mMutex);
+    while(true){
+        mWorkerSignal.wait(lock, [this](){return(mStopWorker || !mReady.empty());});
+        // Frames already handed over are still delivered when stopping
+        if(mReady.empty()) break;
+
+        Slot& slot = mSlots[mReady.front()];
+        mReady.pop_front();
+        mConsuming = true;
+        ConsumerFunction consumer = mConsumer;
+        lock.unlock();
+
+        if(!mCoherent){
+            VkMappedMemoryRange range = {VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, nullptr, slot.memory, 0, VK_WHOLE_SIZE};
+            vkInvalidateMappedMemoryRanges(mDevice, 1, &range);
+        }
+        if(consumer){
+            CPU_PROFILE_ZONE("FrameReadback::consume");
+            ReadbackFrame frame;{
+                frame.frameValue = slot.frameValue;
+                frame.extent = mExtent;
+                frame.format = mFormat;
+                frame.rowPitch = mRowPitch;
+                frame.data = slot.mapped;
+                frame.size = static_cast<size_t>(mFrameSize);
+            }
+            try{
+                consumer(frame);
+            }catch(const std::exception& e){
+                std::cerr << "Warning: Frame readback consumer threw: " << e.what() << std::endl;
+            }
+        }
+        ++mDelivered;
+
+        lock.lock();
+        slot.state = SLOT_FREE;
+        mConsuming = false;
+        if(mReady.empty()) mIdleSignal.notify_all();
+    }
+    mConsuming = false;
+    mIdleSignal.notify_all();
+}
+
+} // end namespace vkutils
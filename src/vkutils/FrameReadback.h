@@ -0,0 +1,124 @@
+#ifndef FRAME_READBACK_H_
+#define FRAME_READBACK_H_
+#include "VulkanDevices.h"
+#include <vulkan/vulkan.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vkutils{
+
+/// A rendered frame copied back to host memory. The data is only valid during the consumer callback.
+struct ReadbackFrame
+{
+    uint64_t frameValue = 0;
+    VkExtent2D extent = {0, 0};
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t rowPitch = 0; // Bytes between the starts of consecutive rows
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+/** Streams rendered images back to the CPU without stalling the render loop. Each frame's copy is recorded
+ * into a command buffer that is submitted along with the frame, writing into one of a ring of persistently
+ * mapped host buffers, preferably HOST_CACHED for fast CPU reads. Once the frame is known to be complete the
+ * buffer is handed to a worker thread, which invokes the consumer and then returns the buffer to the ring.
+ * If every buffer is still in flight or being consumed, the frame is dropped rather than waited on.
+*/
+class FrameReadback
+{
+ public:
+    using ConsumerFunction = std::function<void(const ReadbackFrame& aFrame)>;
+
+    FrameReadback(){}
+    ~FrameReadback();
+
+    FrameReadback(const FrameReadback&) = delete;
+    FrameReadback& operator=(const FrameReadback&) = delete;
+
+    /** Create aSlotCount readback buffers for images of aExtent and aFormat, and start the worker thread.
+     * Copy command buffers are allocated for aQueueFamily, the family the frames are submitted to.
+    */
+    void create(const VulkanDeviceBundle& aDeviceBundle, uint32_t aQueueFamily, VkExtent2D aExtent, VkFormat aFormat, uint32_t aSlotCount);
+    /// Wait for the worker to consume every delivered frame, then free everything. In flight frames are discarded.
+    void destroy();
+    bool isValid() const {return(mCommandPool != VK_NULL_HANDLE);}
+
+    /// Called on the worker thread for every completed frame, in frame order
+    void setConsumer(ConsumerFunction aConsumer);
+
+    /** Record a copy of aImage, currently in aLayout after rendering frame aFrameValue, into a free slot.
+     * The image is returned to aLayout afterwards. Returns the command buffer to submit right after the frame's
+     * own command buffers, or VK_NULL_HANDLE if no slot is free and the frame is dropped.
+    */
+    VkCommandBuffer recordCopy(VkImage aImage, VkImageLayout aLayout, uint64_t aFrameValue);
+    /// Release the slot of the copy just recorded into aCommandBuffer, which was never submitted. It counts as dropped.
+    void cancelCopy(VkCommandBuffer aCommandBuffer);
+
+    /// Hand every recorded frame with a value of at most aCompletedValue to the worker. Never blocks on the GPU.
+    void collect(uint64_t aCompletedValue);
+
+    /// Block until the worker has consumed every frame handed to it
+    void waitIdle();
+
+    uint64_t getDeliveredFrameCount() const {return(mDelivered);}
+    uint64_t getDroppedFrameCount() const {return(mDropped);}
+    VkExtent2D getExtent() const {return(mExtent);}
+    VkFormat getFormat() const {return(mFormat);}
+    uint32_t getSlotCount() const {return(static_cast<uint32_t>(mSlots.size()));}
+
+    /// Size in bytes of one texel of aFormat, or 0 for formats readback doesn't support
+    static uint32_t texel_size(VkFormat aFormat);
+
+ protected:
+    enum SlotStateEnum{
+        SLOT_FREE,
+        SLOT_IN_FLIGHT,
+        SLOT_CONSUMING
+    };
+
+    struct Slot
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        uint8_t* mapped = nullptr;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        uint64_t frameValue = 0;
+        SlotStateEnum state = SLOT_FREE;
+    };
+
+    void createSlot(Slot& aSlot, const VulkanDeviceBundle& aDeviceBundle);
+    void workerLoop();
+
+    VkDevice mDevice = VK_NULL_HANDLE;
+    VkCommandPool mCommandPool = VK_NULL_HANDLE;
+    VkExtent2D mExtent = {0, 0};
+    VkFormat mFormat = VK_FORMAT_UNDEFINED;
+    uint32_t mRowPitch = 0;
+    VkDeviceSize mFrameSize = 0;
+    bool mCoherent = true;
+
+    std::vector<Slot> mSlots;
+    std::deque<size_t> mInFlight; // Slot indices in submission order
+
+    // Shared with the worker thread
+    std::mutex mMutex;
+    std::condition_variable mWorkerSignal;
+    std::condition_variable mIdleSignal;
+    std::deque<size_t> mReady;
+    bool mConsuming = false;
+    bool mStopWorker = false;
+    ConsumerFunction mConsumer;
+    std::thread mWorker;
+
+    std::atomic<uint64_t> mDelivered{0};
+    std::atomic<uint64_t> mDropped{0};
+};
+
+} // end namespace vkutils
+
+#endif
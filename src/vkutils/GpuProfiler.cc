@@ -0,0 +1,83 @@
+#include "GpuProfiler.h"
+#include <stdexcept>
+
+namespace vkutils{
+
+bool GpuProfiler::is_supported(const VulkanDeviceBundle& aDeviceBundle, uint32_t aQueueFamily){
+    const std::vector<QueueFamily>& families = aDeviceBundle.physicalDevice.mQueueFamilies;
+    if(aQueueFamily >= families.size()) return(false);
+    return(families[aQueueFamily].mTimeStampValidBits > 0 && aDeviceBundle.physicalDevice.mProperites.limits.timestampPeriod > 0.0f);
+}
+
+double GpuProfiler::ticks_to_ms(uint64_t aBegin, uint64_t aEnd, uint32_t aValidBits, float aTimestampPeriod){
+    const uint64_t mask = aValidBits >= 64 ? ~uint64_t(0) : (uint64_t(1) << aValidBits) - 1;
+    const uint64_t ticks = (aEnd - aBegin) & mask;
+    return(static_cast<double>(ticks) * aTimestampPeriod / 1e6);
+}
+
+void GpuProfiler::create(const VulkanDeviceBundle& aDeviceBundle, uint32_t aQueueFamily, uint32_t aSlotCount, uint32_t aMaxScopes){
+    destroy();
+    if(!is_supported(aDeviceBundle, aQueueFamily)){
+        throw std::runtime_error("GpuProfiler Error: Queue family " + std::to_string(aQueueFamily) + " does not support timestamp queries!");
+    }
+
+    mValidBits = aDeviceBundle.physicalDevice.mQueueFamilies[aQueueFamily].mTimeStampValidBits;
+    mTimestampPeriod = aDeviceBundle.physicalDevice.mProperites.limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo poolInfo;{
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.pNext = nullptr;
+        poolInfo.flags = 0;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = 2 * aMaxScopes;
+        poolInfo.pipelineStatistics = 0;
+    }
+    mQueries.create(aDeviceBundle.logicalDevice.handle(), poolInfo, aSlotCount, aMaxScopes);
+}
+
+uint32_t GpuProfiler::getScope(const std::string& aName){
+    const uint32_t scope = mQueries.getEntry(aName);
+    if(scope == mScopeSamples.size()) mScopeSamples.emplace_back(4096U);
+    return(scope);
+}
+
+void GpuProfiler::cmdBeginScope(VkCommandBuffer aCommandBuffer, uint32_t aSlot, uint32_t aScope, VkPipelineStageFlagBits aStage){
+    vkCmdWriteTimestamp(aCommandBuffer, aStage, mQueries.getPool(aSlot), 2 * aScope);
+}
+
+void GpuProfiler::cmdEndScope(VkCommandBuffer aCommandBuffer, uint32_t aSlot, uint32_t aScope, VkPipelineStageFlagBits aStage){
+    vkCmdWriteTimestamp(aCommandBuffer, aStage, mQueries.getPool(aSlot), 2 * aScope + 1);
+}
+
+void GpuProfiler::collect(uint64_t aCompletedValue){
+    const uint32_t queryCount = 2 * static_cast<uint32_t>(mScopeSamples.size());
+    for(uint32_t slot : mQueries.takeFinishedSlots(aCompletedValue)){
+        const uint64_t* results = mQueries.readSlot(slot, queryCount, 1);
+        if(results == nullptr) continue;
+
+        mLastFrameTimes.clear();
+        for(size_t scope = 0; scope < mScopeSamples.size(); ++scope){
+            const uint64_t* begin = &results[4 * scope];
+            const uint64_t* end = begin + 2;
+            if(begin[1] == 0 || end[1] == 0) continue;
+            double duration = ticks_to_ms(begin[0], end[0], mValidBits, mTimestampPeriod);
+            mScopeSamples[scope].add(duration);
+            mLastFrameTimes.emplace_back(getScopeNames()[scope], duration);
+        }
+    }
+}
+
+std::vector<double> GpuProfiler::getSamples(const std::string& aScope) const{
+    const int scope = mQueries.findEntry(aScope);
+    if(scope < 0) return(std::vector<double>());
+    return(mScopeSamples[scope].getSamples());
+}
+
+void GpuProfiler::clearSamples(){
+    for(SampleWindow& samples : mScopeSamples){
+        samples.clear();
+    }
+    mLastFrameTimes.clear();
+}
+
+} // end namespace vkutils
@@ -0,0 +1,71 @@
+#ifndef GPU_PROFILER_H_
+#define GPU_PROFILER_H_
+#include "FrameQueryPools.h"
+#include "VulkanDevices.h"
+#include "utils/SampleSummary.h"
+#include <vulkan/vulkan.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vkutils{
+
+/** Measures GPU time spent in named scopes with timestamp queries. Each slot's FrameQueryPools pool holds a
+ * begin and end timestamp per scope. Results arrive as many frames late as the frames in flight.
+*/
+class GpuProfiler
+{
+ public:
+    GpuProfiler(){}
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    /** Create aSlotCount query pools with room for aMaxScopes scopes each, for command buffers submitted to
+     * aQueueFamily. Scopes and their samples are kept if the profiler is recreated. Throws if the family
+     * doesn't support timestamps.
+    */
+    void create(const VulkanDeviceBundle& aDeviceBundle, uint32_t aQueueFamily, uint32_t aSlotCount, uint32_t aMaxScopes = 16);
+    /// See FrameQueryPools::destroy()
+    void destroy() {mQueries.destroy();}
+    bool isValid() const {return(mQueries.isValid());}
+    uint32_t getSlotCount() const {return(mQueries.getSlotCount());}
+
+    static bool is_supported(const VulkanDeviceBundle& aDeviceBundle, uint32_t aQueueFamily);
+
+    /// Id of the scope named aName, registering it if it's new. Throws if no room is left for another scope.
+    uint32_t getScope(const std::string& aName);
+
+    /// Reset every query of aSlot. Record it before the slot's scopes, outside of a render pass.
+    void cmdResetSlot(VkCommandBuffer aCommandBuffer, uint32_t aSlot) {mQueries.cmdResetSlot(aCommandBuffer, aSlot);}
+    void cmdBeginScope(VkCommandBuffer aCommandBuffer, uint32_t aSlot, uint32_t aScope, VkPipelineStageFlagBits aStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    void cmdEndScope(VkCommandBuffer aCommandBuffer, uint32_t aSlot, uint32_t aScope, VkPipelineStageFlagBits aStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+    /// Command buffers writing to aSlot were submitted as part of frame aFrameValue
+    void slotSubmitted(uint32_t aSlot, uint64_t aFrameValue) {mQueries.slotSubmitted(aSlot, aFrameValue);}
+    /// Read the timestamps of every slot submitted with a frame value of at most aCompletedValue
+    void collect(uint64_t aCompletedValue);
+
+    /// Scope durations of the most recently collected frame in milliseconds, for the scopes it wrote
+    const std::vector<std::pair<std::string, double>>& getLastFrameTimes() const {return(mLastFrameTimes);}
+    /// Durations of the scope's most recent frames in milliseconds, oldest first
+    std::vector<double> getSamples(const std::string& aScope) const;
+    SampleSummary summarize(const std::string& aScope) const {return(summarize_samples(getSamples(aScope)));}
+    const std::vector<std::string>& getScopeNames() const {return(mQueries.getEntryNames());}
+    void clearSamples();
+
+    /// Milliseconds between two timestamps of counters with aValidBits valid bits, allowing for wrap around
+    static double ticks_to_ms(uint64_t aBegin, uint64_t aEnd, uint32_t aValidBits, float aTimestampPeriod);
+
+ protected:
+    FrameQueryPools mQueries; // A begin and end timestamp per scope
+    uint32_t mValidBits = 64;
+    float mTimestampPeriod = 1.0f; // Nanoseconds per tick
+
+    std::vector<SampleWindow> mScopeSamples;
+    std::vector<std::pair<std::string, double>> mLastFrameTimes;
+};
+
+} // end namespace vkutils
+
+#endif
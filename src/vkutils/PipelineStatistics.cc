@@ -0,0 +1,93 @@
+#include "PipelineStatistics.h"
+#include <algorithm>
+
+namespace vkutils{
+
+// Results are written in bit order, which matches PipelineCounterEnum
+const VkQueryPipelineStatisticFlags PipelineStatistics::sStatisticFlags =
+    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT | VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+double PipelineCounters::verticesPerPrimitive() const{
+    const uint64_t primitives = values[PIPELINE_COUNTER_INPUT_ASSEMBLY_PRIMITIVES];
+    if(primitives == 0) return(0.0);
+    return(static_cast<double>(values[PIPELINE_COUNTER_VERTEX_SHADER_INVOCATIONS]) / primitives);
+}
+
+double PipelineCounters::fragmentsPerPixel(uint64_t aPixelCount) const{
+    if(aPixelCount == 0) return(0.0);
+    return(static_cast<double>(values[PIPELINE_COUNTER_FRAGMENT_SHADER_INVOCATIONS]) / aPixelCount);
+}
+
+const char* PipelineStatistics::counter_name(PipelineCounterEnum aCounter){
+    switch(aCounter){
+        case PIPELINE_COUNTER_INPUT_ASSEMBLY_PRIMITIVES: return("ia_primitives");
+        case PIPELINE_COUNTER_VERTEX_SHADER_INVOCATIONS: return("vs_invocations");
+        case PIPELINE_COUNTER_CLIPPING_PRIMITIVES: return("clipping_primitives");
+        case PIPELINE_COUNTER_FRAGMENT_SHADER_INVOCATIONS: return("fs_invocations");
+        default: return("unknown");
+    }
+}
+
+void PipelineStatistics::create(const VulkanDeviceBundle& aDeviceBundle, uint32_t aSlotCount, uint32_t aMaxBatches){
+    destroy();
+    VkQueryPoolCreateInfo poolInfo;{
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.pNext = nullptr;
+        poolInfo.flags = 0;
+        poolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        poolInfo.queryCount = aMaxBatches;
+        poolInfo.pipelineStatistics = sStatisticFlags;
+    }
+    mQueries.create(aDeviceBundle.logicalDevice.handle(), poolInfo, aSlotCount, aMaxBatches);
+}
+
+uint32_t PipelineStatistics::getBatch(const std::string& aName){
+    const uint32_t batch = mQueries.getEntry(aName);
+    if(batch == mBatchSamples.size()) mBatchSamples.emplace_back();
+    return(batch);
+}
+
+void PipelineStatistics::cmdBeginBatch(VkCommandBuffer aCommandBuffer, uint32_t aSlot, uint32_t aBatch){
+    vkCmdBeginQuery(aCommandBuffer, mQueries.getPool(aSlot), aBatch, 0);
+}
+
+void PipelineStatistics::cmdEndBatch(VkCommandBuffer aCommandBuffer, uint32_t aSlot, uint32_t aBatch){
+    vkCmdEndQuery(aCommandBuffer, mQueries.getPool(aSlot), aBatch);
+}
+
+void PipelineStatistics::collect(uint64_t aCompletedValue){
+    const uint32_t queryCount = static_cast<uint32_t>(mBatchSamples.size());
+    const size_t stride = PIPELINE_COUNTER_COUNT + 1;
+    for(uint32_t slot : mQueries.takeFinishedSlots(aCompletedValue)){
+        const uint64_t* results = mQueries.readSlot(slot, queryCount, PIPELINE_COUNTER_COUNT);
+        if(results == nullptr) continue;
+
+        mLastFrameCounters.clear();
+        for(size_t batch = 0; batch < mBatchSamples.size(); ++batch){
+            const uint64_t* values = &results[stride * batch];
+            if(values[PIPELINE_COUNTER_COUNT] == 0) continue;
+            PipelineCounters counters;
+            std::copy(values, values + PIPELINE_COUNTER_COUNT, counters.values.begin());
+            for(size_t counter = 0; counter < PIPELINE_COUNTER_COUNT; ++counter){
+                mBatchSamples[batch][counter].add(static_cast<double>(counters.values[counter]));
+            }
+            mLastFrameCounters.emplace_back(getBatchNames()[batch], counters);
+        }
+    }
+}
+
+std::vector<double> PipelineStatistics::getSamples(const std::string& aBatch, PipelineCounterEnum aCounter) const{
+    const int batch = mQueries.findEntry(aBatch);
+    if(batch < 0 || aCounter >= PIPELINE_COUNTER_COUNT) return(std::vector<double>());
+    return(mBatchSamples[batch][aCounter].getSamples());
+}
+
+void PipelineStatistics::clearSamples(){
+    for(std::array<SampleWindow, PIPELINE_COUNTER_COUNT>& samples : mBatchSamples){
+        for(SampleWindow& counter : samples) counter.clear();
+    }
+    mLastFrameCounters.clear();
+}
+
+} // end namespace vkutils
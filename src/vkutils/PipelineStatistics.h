@@ -0,0 +1,91 @@
+#ifndef PIPELINE_STATISTICS_H_
+#define PIPELINE_STATISTICS_H_
+#include "FrameQueryPools.h"
+#include "VulkanDevices.h"
+#include "utils/SampleSummary.h"
+#include <vulkan/vulkan.h>
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vkutils{
+
+/// Counters collected by PipelineStatistics, in the order Vulkan writes them
+enum PipelineCounterEnum{
+    PIPELINE_COUNTER_INPUT_ASSEMBLY_PRIMITIVES = 0,
+    PIPELINE_COUNTER_VERTEX_SHADER_INVOCATIONS,
+    PIPELINE_COUNTER_CLIPPING_PRIMITIVES,
+    PIPELINE_COUNTER_FRAGMENT_SHADER_INVOCATIONS,
+    PIPELINE_COUNTER_COUNT
+};
+
+/** One frame's counters for a draw batch */
+struct PipelineCounters
+{
+    std::array<uint64_t, PIPELINE_COUNTER_COUNT> values = {};
+
+    uint64_t operator[](PipelineCounterEnum aCounter) const {return(values[aCounter]);}
+
+    /// Vertex shader invocations per assembled primitive. 3 for triangles without any vertex reuse, lower is better.
+    double verticesPerPrimitive() const;
+    /// Fragment shader invocations per pixel of a target with aPixelCount pixels, i.e. the average overdraw
+    double fragmentsPerPixel(uint64_t aPixelCount) const;
+};
+
+/** Counts primitives and shader invocations of named draw batches with pipeline statistics queries, one query
+ * per batch in each slot's FrameQueryPools pool. Requires the pipelineStatisticsQuery device feature.
+*/
+class PipelineStatistics
+{
+ public:
+    PipelineStatistics(){}
+
+    PipelineStatistics(const PipelineStatistics&) = delete;
+    PipelineStatistics& operator=(const PipelineStatistics&) = delete;
+
+    /** Create aSlotCount query pools with room for aMaxBatches batches each. Batches and their samples are kept
+     * if recreated. The caller is responsible for checking the device has pipelineStatisticsQuery enabled.
+    */
+    void create(const VulkanDeviceBundle& aDeviceBundle, uint32_t aSlotCount, uint32_t aMaxBatches = 16);
+    /// See FrameQueryPools::destroy()
+    void destroy() {mQueries.destroy();}
+    bool isValid() const {return(mQueries.isValid());}
+    uint32_t getSlotCount() const {return(mQueries.getSlotCount());}
+
+    /// Id of the batch named aName, registering it if it's new. Throws if no room is left for another batch.
+    uint32_t getBatch(const std::string& aName);
+
+    /// Reset every query of aSlot. Record it before the slot's batches, outside of a render pass.
+    void cmdResetSlot(VkCommandBuffer aCommandBuffer, uint32_t aSlot) {mQueries.cmdResetSlot(aCommandBuffer, aSlot);}
+    /// Batches may not overlap
+    void cmdBeginBatch(VkCommandBuffer aCommandBuffer, uint32_t aSlot, uint32_t aBatch);
+    void cmdEndBatch(VkCommandBuffer aCommandBuffer, uint32_t aSlot, uint32_t aBatch);
+
+    /// Command buffers writing to aSlot were submitted as part of frame aFrameValue
+    void slotSubmitted(uint32_t aSlot, uint64_t aFrameValue) {mQueries.slotSubmitted(aSlot, aFrameValue);}
+    /// Read the counters of every slot submitted with a frame value of at most aCompletedValue
+    void collect(uint64_t aCompletedValue);
+
+    /// Counters of the most recently collected frame, for the batches it recorded
+    const std::vector<std::pair<std::string, PipelineCounters>>& getLastFrameCounters() const {return(mLastFrameCounters);}
+    /// aCounter of the batch's most recent frames, oldest first
+    std::vector<double> getSamples(const std::string& aBatch, PipelineCounterEnum aCounter) const;
+    SampleSummary summarize(const std::string& aBatch, PipelineCounterEnum aCounter) const {return(summarize_samples(getSamples(aBatch, aCounter)));}
+    const std::vector<std::string>& getBatchNames() const {return(mQueries.getEntryNames());}
+    void clearSamples();
+
+    /// Short snake_case name of aCounter, e.g. "vs_invocations"
+    static const char* counter_name(PipelineCounterEnum aCounter);
+    static const VkQueryPipelineStatisticFlags sStatisticFlags;
+
+ protected:
+    FrameQueryPools mQueries; // A query per batch
+
+    std::vector<std::array<SampleWindow, PIPELINE_COUNTER_COUNT>> mBatchSamples;
+    std::vector<std::pair<std::string, PipelineCounters>> mLastFrameCounters;
+};
+
+} // end namespace vkutils
+
+#endif
@@ -0,0 +1,422 @@
+#include "RuntimeShaderCompiler.h"
+#include "utils/common.h"
+#include "utils/MappedFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef VULKANBASE_HAS_SHADERC
+#include <shaderc/shaderc.h>
+#endif
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifndef SHADER_SOURCE_DIR
+#define SHADER_SOURCE_DIR shaders/
+#endif
+
+#if defined(VULKANBASE_HAS_SHADERC) && !defined(VULKANBASE_SHADERC_VERSION)
+#define VULKANBASE_SHADERC_VERSION unknown
+#endif
+
+namespace vkutils{
+
+// Bump when the layout of the key or cache files changes so stale cache files are ignored.
+static const char* const sCacheFormatTag = "VulkanBase.RuntimeShaderCompiler.v2";
+
+static uint64_t fnv1a_64(const void* aData, size_t aSize, uint64_t aSeed = 14695981039346656037ULL){
+    const uint8_t* bytes = static_cast<const uint8_t*>(aData);
+    uint64_t hash = aSeed;
+    for(size_t i = 0; i < aSize; ++i){
+        hash ^= static_cast<uint64_t>(bytes[i]);
+        hash *= 1099511628211ULL;
+    }
+    return(hash);
+}
+
+static uint64_t fnv1a_64(const std::string& aString, uint64_t aSeed){
+    // Hash the terminator too so that adjacent strings can't run together, e.g. "ab"+"c" vs "a"+"bc"
+    return(fnv1a_64(aString.c_str(), aString.size() + 1, aSeed));
+}
+
+static bool read_text_file(const std::string& aPath, std::string& aContentsOut){
+    MappedFile file(aPath);
+    if(!file.isOpen()) return(false);
+    aContentsOut.assign(reinterpret_cast<const char*>(file.data()), file.size());
+    return(true);
+}
+
+static std::string directory_of(const std::string& aPath){
+    size_t slash = aPath.find_last_of("/\\");
+    return(slash == std::string::npos ? std::string(".") : aPath.substr(0, slash));
+}
+
+static void make_directory(const std::string& aPath){
+#ifdef _WIN32
+    _mkdir(aPath.c_str());
+#else
+    mkdir(aPath.c_str(), 0755);
+#endif
+}
+
+static void stamp_file(const std::string& aPath, int64_t& aModifiedOut, int64_t& aSizeOut){
+    aModifiedOut = 0;
+    aSizeOut = -1;
+#ifdef _WIN32
+    struct _stat64 info;
+    if(_stat64(aPath.c_str(), &info) != 0) return;
+    aModifiedOut = static_cast<int64_t>(info.st_mtime);
+#else
+    struct stat info;
+    if(stat(aPath.c_str(), &info) != 0) return;
+  #if defined(__APPLE__)
+    aModifiedOut = static_cast<int64_t>(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+  #elif defined(__linux__)
+    aModifiedOut = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+  #else
+    aModifiedOut = static_cast<int64_t>(info.st_mtime);
+  #endif
+#endif
+    aSizeOut = static_cast<int64_t>(info.st_size);
+}
+
+static double elapsed_milliseconds(const std::chrono::high_resolution_clock::time_point& aStart){
+    return(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - aStart).count());
+}
+
+RuntimeShaderCompiler::RuntimeShaderCompiler(const std::string& aIncludeDir, const std::string& aCacheDir)
+:   mIncludeDir(aIncludeDir), mCacheDir(aCacheDir)
+{
+    if(!mCacheDir.empty()){
+        make_directory(mCacheDir);
+    }
+#ifdef VULKANBASE_HAS_SHADERC
+    mCompiler = shaderc_compiler_initialize();
+#endif
+}
+
+RuntimeShaderCompiler::~RuntimeShaderCompiler(){
+#ifdef VULKANBASE_HAS_SHADERC
+    if(mCompiler != nullptr){
+        shaderc_compiler_release(static_cast<shaderc_compiler_t>(mCompiler));
+    }
+#endif
+}
+
+bool RuntimeShaderCompiler::isAvailable(){
+#ifdef VULKANBASE_HAS_SHADERC
+    return(true);
+#else
+    return(false);
+#endif
+}
+
+std::string RuntimeShaderCompiler::defaultIncludeDir(){
+    return(STRIFY(SHADER_SOURCE_DIR));
+}
+
+std::string RuntimeShaderCompiler::defaultCacheDir(){
+    return(STRIFY(SHADER_DIR) "/cache");
+}
+
+VkShaderStageFlagBits RuntimeShaderCompiler::stageFromFileName(const std::string& aFileName){
+    static const std::vector<std::pair<std::string, VkShaderStageFlagBits>> sExtensionStages = {
+        {".vert", VK_SHADER_STAGE_VERTEX_BIT},
+        {".frag", VK_SHADER_STAGE_FRAGMENT_BIT},
+        {".comp", VK_SHADER_STAGE_COMPUTE_BIT},
+        {".geom", VK_SHADER_STAGE_GEOMETRY_BIT},
+        {".tesc", VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT},
+        {".tese", VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT}
+    };
+    for(const std::pair<std::string, VkShaderStageFlagBits>& extStage : sExtensionStages){
+        const std::string& ext = extStage.first;
+        if(aFileName.size() >= ext.size() && aFileName.compare(aFileName.size() - ext.size(), ext.size(), ext) == 0){
+            return(extStage.second);
+        }
+    }
+    throw std::runtime_error("Unable to infer shader stage from file name '" + aFileName + "'");
+}
+
+std::string RuntimeShaderCompiler::resolveInclude(const std::string& aRequested, const std::string& aRequestingSource) const{
+    std::vector<std::string> candidates = {directory_of(aRequestingSource) + "/" + aRequested, mIncludeDir + "/" + aRequested};
+    for(const std::string& candidate : candidates){
+        std::ifstream probe(candidate);
+        if(probe.good()) return(candidate);
+    }
+    return(std::string());
+}
+
+std::vector<std::string> RuntimeShaderCompiler::findIncludes(const std::string& aSource, const std::string& aSourceName) const{
+    std::vector<std::string> includes;
+    findIncludesRecursive(aSource, aSourceName, includes);
+    return(includes);
+}
+
+void RuntimeShaderCompiler::findIncludesRecursive(const std::string& aSource, const std::string& aSourceName, std::vector<std::string>& aIncludesOut) const{
+    std::istringstream lines(aSource);
+    std::string line;
+    while(std::getline(lines, line)){
+        size_t pos = line.find_first_not_of(" \t");
+        if(pos == std::string::npos || line[pos] != '#') continue;
+        pos = line.find_first_not_of(" \t", pos + 1);
+        if(pos == std::string::npos || line.compare(pos, 7, "include") != 0) continue;
+        pos = line.find_first_of("\"<", pos + 7);
+        if(pos == std::string::npos) continue;
+        size_t end = line.find_first_of(line[pos] == '"' ? "\"" : ">", pos + 1);
+        if(end == std::string::npos) continue;
+
+        std::string resolved = resolveInclude(line.substr(pos + 1, end - pos - 1), aSourceName);
+        if(resolved.empty() || std::find(aIncludesOut.begin(), aIncludesOut.end(), resolved) != aIncludesOut.end()) continue;
+
+        aIncludesOut.emplace_back(resolved);
+        std::string includedSource;
+        if(read_text_file(resolved, includedSource)){
+            findIncludesRecursive(includedSource, resolved, aIncludesOut);
+        }
+    }
+}
+
+uint64_t RuntimeShaderCompiler::computeKey(const std::string& aSource, const std::string& aSourceName, VkShaderStageFlagBits aStage, const DefineList& aDefines) const{
+    return(computeKey(computeRequestKey(aSource, aSourceName, aStage, aDefines), findIncludes(aSource, aSourceName)));
+}
+
+uint64_t RuntimeShaderCompiler::computeRequestKey(const std::string& aSource, const std::string& aSourceName, VkShaderStageFlagBits aStage, const DefineList& aDefines) const{
+    uint64_t key = fnv1a_64(std::string(sCacheFormatTag), 14695981039346656037ULL);
+
+#ifdef VULKANBASE_HAS_SHADERC
+    // The SPIR-V version alone doesn't change with most compiler upgrades, so the build's identity is hashed too
+    unsigned int spvVersion = 0, spvRevision = 0;
+    shaderc_get_spv_version(&spvVersion, &spvRevision);
+    key = fnv1a_64(std::string(STRIFY(VULKANBASE_SHADERC_VERSION)), key);
+    key = fnv1a_64(std::to_string(spvVersion) + "." + std::to_string(spvRevision), key);
+#endif
+
+    key = fnv1a_64(std::to_string(static_cast<uint32_t>(aStage)) + (mOptimize ? "O" : "g"), key);
+    key = fnv1a_64(aSourceName, key);
+    key = fnv1a_64(aSource, key);
+
+    DefineList sortedDefines = aDefines;
+    std::sort(sortedDefines.begin(), sortedDefines.end());
+    for(const std::pair<std::string, std::string>& define : sortedDefines){
+        key = fnv1a_64(define.first, key);
+        key = fnv1a_64(define.second, key);
+    }
+    return(key);
+}
+
+uint64_t RuntimeShaderCompiler::computeKey(uint64_t aRequestKey, const std::vector<std::string>& aIncludes) const{
+    // Edits to included files must produce a new key even though the including source is unchanged.
+    uint64_t key = aRequestKey;
+    for(const std::string& include : aIncludes){
+        std::string includedSource;
+        read_text_file(include, includedSource);
+        key = fnv1a_64(include, key);
+        key = fnv1a_64(includedSource, key);
+    }
+    return(key);
+}
+
+std::vector<uint32_t> RuntimeShaderCompiler::compileFile(const std::string& aSourcePath, const DefineList& aDefines, VkShaderStageFlagBits aStage){
+    std::string source;
+    if(!read_text_file(aSourcePath, source)){
+        throw std::runtime_error("Failed to open shader source '" + aSourcePath + "'!");
+    }
+    if(aStage == 0){
+        aStage = stageFromFileName(aSourcePath);
+    }
+    return(compileSource(source, aSourcePath, aStage, aDefines));
+}
+
+std::vector<uint32_t> RuntimeShaderCompiler::compileSource(const std::string& aSource, const std::string& aSourceName, VkShaderStageFlagBits aStage, const DefineList& aDefines){
+    std::chrono::high_resolution_clock::time_point lookupStart = std::chrono::high_resolution_clock::now();
+    const uint64_t requestKey = computeRequestKey(aSource, aSourceName, aStage, aDefines);
+
+    // Includes are only found and hashed again once one of them changed on disk
+    ResolvedRequest& resolved = mResolvedRequests[requestKey];
+    bool includesChanged = resolved.key == 0;
+    for(size_t i = 0; i < resolved.includes.size() && !includesChanged; ++i){
+        int64_t modified = 0, size = 0;
+        stamp_file(resolved.includes[i].path, modified, size);
+        includesChanged = modified != resolved.includes[i].modified || size != resolved.includes[i].size;
+    }
+    if(includesChanged){
+        std::vector<std::string> includes = findIncludes(aSource, aSourceName);
+        // Stamped before hashing, so an edit made in between is caught by the next request
+        resolved.includes.clear();
+        for(const std::string& include : includes){
+            IncludeStamp stamp = {include, 0, 0};
+            stamp_file(include, stamp.modified, stamp.size);
+            resolved.includes.emplace_back(stamp);
+        }
+        resolved.key = computeKey(requestKey, includes);
+    }
+    const uint64_t key = resolved.key;
+
+    std::unordered_map<uint64_t, std::vector<uint32_t>>::const_iterator cached = mMemoryCache.find(key);
+    if(cached != mMemoryCache.end()){
+        ++mStats.memoryHits;
+        mStats.cacheLookupMilliseconds += elapsed_milliseconds(lookupStart);
+        return(cached->second);
+    }
+
+    std::vector<uint32_t> spirv;
+    if(loadFromDisk(key, spirv)){
+        ++mStats.diskHits;
+        mStats.cacheLookupMilliseconds += elapsed_milliseconds(lookupStart);
+        mMemoryCache[key] = spirv;
+        return(spirv);
+    }
+
+    std::chrono::high_resolution_clock::time_point compileStart = std::chrono::high_resolution_clock::now();
+    spirv = invokeCompiler(aSource, aSourceName, aStage, aDefines);
+    ++mStats.compiles;
+    mStats.compileMilliseconds += elapsed_milliseconds(compileStart);
+
+    storeToDisk(key, spirv);
+    mMemoryCache[key] = spirv;
+    return(spirv);
+}
+
+static std::string cache_file_path(const std::string& aCacheDir, uint64_t aKey){
+    std::ostringstream pathBuilder;
+    pathBuilder << aCacheDir << "/" << std::hex << std::setw(16) << std::setfill('0') << aKey << ".spv";
+    return(pathBuilder.str());
+}
+
+bool RuntimeShaderCompiler::loadFromDisk(uint64_t aKey, std::vector<uint32_t>& aSpirvOut) const{
+    if(mCacheDir.empty()) return(false);
+
+    MappedFile file(cache_file_path(mCacheDir, aKey));
+    if(!file.isOpen() || file.size() < sizeof(uint32_t) || file.size() % sizeof(uint32_t) != 0) return(false);
+
+    const uint32_t* words = reinterpret_cast<const uint32_t*>(file.data());
+    if(words[0] != 0x07230203) return(false); // SPIR-V magic number
+
+    aSpirvOut.assign(words, words + file.size() / sizeof(uint32_t));
+    return(true);
+}
+
+void RuntimeShaderCompiler::storeToDisk(uint64_t aKey, const std::vector<uint32_t>& aSpirv) const{
+    if(mCacheDir.empty()) return;
+
+    // Write to a temporary file first so that a concurrently running instance never maps a partial file.
+    std::string path = cache_file_path(mCacheDir, aKey);
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if(!out.is_open()){
+            std::cerr << "Warning: Unable to write shader cache file '" << tmpPath << "'" << std::endl;
+            return;
+        }
+        out.write(reinterpret_cast<const char*>(aSpirv.data()), aSpirv.size() * sizeof(uint32_t));
+    }
+    remove(path.c_str());
+    if(rename(tmpPath.c_str(), path.c_str()) != 0){
+        remove(tmpPath.c_str());
+    }
+}
+
+#ifdef VULKANBASE_HAS_SHADERC
+
+namespace{
+
+struct IncludeResultData
+{
+    shaderc_include_result result;
+    std::string name;
+    std::string content;
+};
+
+} // end anonymous namespace
+
+std::vector<uint32_t> RuntimeShaderCompiler::invokeCompiler(const std::string& aSource, const std::string& aSourceName, VkShaderStageFlagBits aStage, const DefineList& aDefines){
+    shaderc_shader_kind kind = shaderc_glsl_infer_from_source;
+    switch(aStage){
+        case VK_SHADER_STAGE_VERTEX_BIT: kind = shaderc_glsl_vertex_shader; break;
+        case VK_SHADER_STAGE_FRAGMENT_BIT: kind = shaderc_glsl_fragment_shader; break;
+        case VK_SHADER_STAGE_COMPUTE_BIT: kind = shaderc_glsl_compute_shader; break;
+        case VK_SHADER_STAGE_GEOMETRY_BIT: kind = shaderc_glsl_geometry_shader; break;
+        case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT: kind = shaderc_glsl_tess_control_shader; break;
+        case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT: kind = shaderc_glsl_tess_evaluation_shader; break;
+        default: break;
+    }
+
+    shaderc_compile_options_t options = shaderc_compile_options_initialize();
+    shaderc_compile_options_set_target_env(options, shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_1);
+    if(mOptimize){
+        shaderc_compile_options_set_optimization_level(options, shaderc_optimization_level_performance);
+    }else{
+        shaderc_compile_options_set_optimization_level(options, shaderc_optimization_level_zero);
+        shaderc_compile_options_set_generate_debug_info(options);
+    }
+    for(const std::pair<std::string, std::string>& define : aDefines){
+        shaderc_compile_options_add_macro_definition(options, define.first.c_str(), define.first.size(), define.second.c_str(), define.second.size());
+    }
+
+    auto resolver = [](void* aUserData, const char* aRequested, int, const char* aRequesting, size_t) -> shaderc_include_result* {
+        const RuntimeShaderCompiler* compiler = static_cast<const RuntimeShaderCompiler*>(aUserData);
+        IncludeResultData* data = new IncludeResultData();
+        data->name = compiler->resolveInclude(aRequested, aRequesting);
+        if(data->name.empty() || !read_text_file(data->name, data->content)){
+            // shaderc reports an empty source name as a failed include, using the content as the error message
+            data->name.clear();
+            data->content = "Unable to resolve #include \"" + std::string(aRequested) + "\"";
+        }
+        data->result.source_name = data->name.c_str();
+        data->result.source_name_length = data->name.size();
+        data->result.content = data->content.c_str();
+        data->result.content_length = data->content.size();
+        data->result.user_data = data;
+        return(&data->result);
+    };
+    auto releaser = [](void*, shaderc_include_result* aResult){
+        delete static_cast<IncludeResultData*>(aResult->user_data);
+    };
+    shaderc_compile_options_set_include_callbacks(options, resolver, releaser, this);
+
+    shaderc_compilation_result_t result = shaderc_compile_into_spv(
+        static_cast<shaderc_compiler_t>(mCompiler), aSource.c_str(), aSource.size(), kind, aSourceName.c_str(), "main", options
+    );
+    shaderc_compile_options_release(options);
+
+    if(shaderc_result_get_compilation_status(result) != shaderc_compilation_status_success){
+        std::string message = shaderc_result_get_error_message(result);
+        shaderc_result_release(result);
+        throw std::runtime_error("Failed to compile shader '" + aSourceName + "':\n" + message);
+    }
+
+    const uint32_t* words = reinterpret_cast<const uint32_t*>(shaderc_result_get_bytes(result));
+    std::vector<uint32_t> spirv(words, words + shaderc_result_get_length(result) / sizeof(uint32_t));
+    shaderc_result_release(result);
+    return(spirv);
+}
+
+#else
+
+std::vector<uint32_t> RuntimeShaderCompiler::invokeCompiler(const std::string&, const std::string& aSourceName, VkShaderStageFlagBits, const DefineList&){
+    throw std::runtime_error("Unable to compile shader '" + aSourceName + "' at runtime: VulkanBase was built without shaderc");
+}
+
+#endif
+
+std::string RuntimeShaderCompiler::getReportString() const{
+    std::ostringstream reportBuilder;
+    reportBuilder.setf(std::ios_base::fixed, std::ios_base::floatfield);
+    reportBuilder.precision(3);
+    reportBuilder << mStats.compiles << " compiles (" << mStats.compileMilliseconds << " ms), "
+                  << mStats.memoryHits << " memory hits, " << mStats.diskHits << " disk hits ("
+                  << mStats.cacheLookupMilliseconds << " ms)";
+    return(reportBuilder.str());
+}
+
+} // end namespace vkutils
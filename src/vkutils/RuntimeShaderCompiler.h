@@ -0,0 +1,114 @@
+#ifndef RUNTIME_SHADER_COMPILER_H_
+#define RUNTIME_SHADER_COMPILER_H_
+#include <vulkan/vulkan.h>
+#include <string>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+
+namespace vkutils{
+
+/** Compiles GLSL to SPIR-V at runtime through the shaderc library.
+ * Compiled SPIR-V is cached both in memory and on disk, keyed by a hash of the source, every file it
+ * #includes, the preprocessor defines, and the compiler build (VULKANBASE_SHADERC_VERSION, set by CMake).
+ * Requesting a variant that has been compiled before, in this run or a previous one, is a cache lookup
+ * rather than a compile. Repeat requests only check the modification times and sizes of the included files,
+ * and re-read them when those changed. A file newly shadowing an include, e.g. one created next to the
+ * including source, isn't noticed until clearMemoryCache() is called.
+ *
+ * #include directives are resolved relative to the including file first, then the include directory
+ * (the shaders/ source directory by default), so shared code can live in .glinl files under shaders/.
+ *
+ * When built without shaderc (VULKANBASE_HAS_SHADERC undefined), isAvailable() returns false and compile
+ * requests throw.
+*/
+class RuntimeShaderCompiler
+{
+ public:
+    /// Preprocessor defines as name, value pairs. The order of defines does not affect caching.
+    using DefineList = std::vector<std::pair<std::string, std::string>>;
+
+    struct Stats
+    {
+        size_t compiles = 0;
+        size_t memoryHits = 0;
+        size_t diskHits = 0;
+        double compileMilliseconds = 0.0;
+        double cacheLookupMilliseconds = 0.0;
+    };
+
+    /** Arguments:
+     *   aIncludeDir: Fallback directory for resolving #include directives
+     *   aCacheDir: Directory compiled SPIR-V is cached in. An empty string disables the disk cache.
+    */
+    RuntimeShaderCompiler(const std::string& aIncludeDir = defaultIncludeDir(), const std::string& aCacheDir = defaultCacheDir());
+    ~RuntimeShaderCompiler();
+
+    RuntimeShaderCompiler(const RuntimeShaderCompiler&) = delete;
+    RuntimeShaderCompiler& operator=(const RuntimeShaderCompiler&) = delete;
+
+    /// True if this build can compile GLSL at runtime
+    static bool isAvailable();
+    static std::string defaultIncludeDir();
+    static std::string defaultCacheDir();
+
+    /** Compile the GLSL file at aSourcePath, returning SPIR-V words. The shader stage is inferred from the file extension
+     * (.vert, .frag, .comp, .geom, .tesc, .tese) unless aStage is given. Throws on failure.
+    */
+    std::vector<uint32_t> compileFile(const std::string& aSourcePath, const DefineList& aDefines = DefineList(), VkShaderStageFlagBits aStage = static_cast<VkShaderStageFlagBits>(0));
+
+    /// Compile GLSL source held in memory. aSourceName is used for error messages and resolving relative includes.
+    std::vector<uint32_t> compileSource(const std::string& aSource, const std::string& aSourceName, VkShaderStageFlagBits aStage, const DefineList& aDefines = DefineList());
+
+    /// Cache key of a shader variant. Exposed mostly for testing and debugging.
+    uint64_t computeKey(const std::string& aSource, const std::string& aSourceName, VkShaderStageFlagBits aStage, const DefineList& aDefines) const;
+
+    /// Paths of every file transitively #included by aSource
+    std::vector<std::string> findIncludes(const std::string& aSource, const std::string& aSourceName) const;
+
+    void setOptimize(bool aOptimize) {mOptimize = aOptimize;}
+    void clearMemoryCache() {mMemoryCache.clear(); mResolvedRequests.clear();}
+
+    const Stats& getStats() const {return(mStats);}
+    std::string getReportString() const;
+
+    static VkShaderStageFlagBits stageFromFileName(const std::string& aFileName);
+
+ protected:
+    std::string resolveInclude(const std::string& aRequested, const std::string& aRequestingSource) const;
+    void findIncludesRecursive(const std::string& aSource, const std::string& aSourceName, std::vector<std::string>& aIncludesOut) const;
+
+    struct IncludeStamp
+    {
+        std::string path;
+        int64_t modified; // Nanoseconds where the platform reports them, otherwise seconds
+        int64_t size;
+    };
+    /// Variant key and the includes it was computed from, per request
+    struct ResolvedRequest
+    {
+        uint64_t key = 0;
+        std::vector<IncludeStamp> includes;
+    };
+
+    /// Hash of everything identifying a variant except the files it includes
+    uint64_t computeRequestKey(const std::string& aSource, const std::string& aSourceName, VkShaderStageFlagBits aStage, const DefineList& aDefines) const;
+    uint64_t computeKey(uint64_t aRequestKey, const std::vector<std::string>& aIncludes) const;
+
+    bool loadFromDisk(uint64_t aKey, std::vector<uint32_t>& aSpirvOut) const;
+    void storeToDisk(uint64_t aKey, const std::vector<uint32_t>& aSpirv) const;
+    std::vector<uint32_t> invokeCompiler(const std::string& aSource, const std::string& aSourceName, VkShaderStageFlagBits aStage, const DefineList& aDefines);
+
+    std::string mIncludeDir;
+    std::string mCacheDir;
+    bool mOptimize = true;
+    void* mCompiler = nullptr; // shaderc_compiler_t when available
+
+    std::unordered_map<uint64_t, std::vector<uint32_t>> mMemoryCache;
+    std::unordered_map<uint64_t, ResolvedRequest> mResolvedRequests; // Keyed by request key
+    Stats mStats;
+};
+
+} // end namespace vkutils
+
+#endif
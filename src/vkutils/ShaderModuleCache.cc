@@ -0,0 +1,132 @@
+#include "ShaderModuleCache.h"
+#include "vkutils.h"
+#include "utils/common.h"
+#include "utils/MappedFile.h"
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace vkutils{
+
+ShaderModuleCache::~ShaderModuleCache(){
+    clear();
+}
+
+void ShaderModuleCache::setDevice(const VkDevice& aDevice){
+    if(mDevice == aDevice) return;
+    if(!mModules.empty()){
+        throw std::runtime_error("ShaderModuleCache::setDevice() Error: Cannot change device while modules are cached!");
+    }
+    mDevice = aDevice;
+}
+
+VkShaderModule ShaderModuleCache::acquireFromFile(const std::string& aFilePath){
+    MappedFile file(aFilePath);
+    if(!file.isOpen()){
+        perror(aFilePath.c_str());
+        std::cerr << "Failed to open shader file '" << aFilePath << "'!" << std::endl;
+        return(VK_NULL_HANDLE);
+    }
+
+    VkShaderModule resultModule = acquireFromMemory(reinterpret_cast<const uint32_t*>(file.data()), file.size());
+    if(resultModule == VK_NULL_HANDLE){
+        std::cerr << "Failed to create shader module from '" << aFilePath << "'!" << std::endl;
+    }
+    return(resultModule);
+}
+
+VkShaderModule ShaderModuleCache::acquireFromMemory(const uint32_t* aCode, size_t aCodeSize){
+    if(mDevice == VK_NULL_HANDLE){
+        throw std::runtime_error("ShaderModuleCache Error: No device has been set!");
+    }
+    if(aCode == nullptr || aCodeSize == 0 || aCodeSize % sizeof(uint32_t) != 0){
+        std::cerr << "ShaderModuleCache: Rejecting invalid SPIR-V of " << aCodeSize << " bytes" << std::endl;
+        return(VK_NULL_HANDLE);
+    }
+
+    ContentKey key(hashContents(reinterpret_cast<const uint8_t*>(aCode), aCodeSize), aCodeSize);
+    std::pair<ModuleMap::iterator, ModuleMap::iterator> matches = mModules.equal_range(key);
+    for(ModuleMap::iterator found = matches.first; found != matches.second; ++found){
+        if(std::memcmp(found->second.code.data(), aCode, aCodeSize) != 0) continue;
+        ++found->second.refCount;
+        ++mStats.cacheHits;
+        mStats.bytesAvoided += aCodeSize;
+        return(found->second.module);
+    }
+
+    VkShaderModule module = create_shader_module(mDevice, aCode, aCodeSize, true);
+    if(module == VK_NULL_HANDLE) return(VK_NULL_HANDLE);
+
+    ModuleMap::iterator inserted = mModules.emplace(key, CachedModule());
+    CachedModule& entry = inserted->second;
+    entry.module = module;
+    entry.refCount = 1;
+    entry.code.assign(aCode, aCode + aCodeSize / sizeof(uint32_t));
+    try{
+        entry.reflection = reflect_spirv(aCode, aCodeSize);
+        entry.reflected = true;
+    }catch(const std::runtime_error& e){
+        std::cerr << "Warning: Shader module will not be reflected: " << e.what() << std::endl;
+    }
+    mModuleKeys[module] = inserted;
+    ++mStats.modulesCreated;
+    mStats.bytesLoaded += aCodeSize;
+    return(module);
+}
+
+VkShaderModule ShaderModuleCache::acquireEmbedded(const std::string& aShaderName){
+    const EmbeddedShader* shader = find_embedded_shader(aShaderName);
+    if(shader == nullptr){
+        std::cerr << "Warning: Shader '" << aShaderName << "' is not embedded. Loading it from disk instead..." << std::endl;
+        return(acquireFromFile(STRIFY(SHADER_DIR) "/" + aShaderName + ".spv"));
+    }
+    return(acquireFromMemory(shader->code, shader->size));
+}
+
+const ShaderReflection* ShaderModuleCache::getReflection(VkShaderModule aModule) const{
+    std::unordered_map<VkShaderModule, ModuleMap::iterator>::const_iterator keyIter = mModuleKeys.find(aModule);
+    if(keyIter == mModuleKeys.end() || !keyIter->second->second.reflected) return(nullptr);
+    return(&keyIter->second->second.reflection);
+}
+
+void ShaderModuleCache::release(VkShaderModule aModule){
+    std::unordered_map<VkShaderModule, ModuleMap::iterator>::iterator keyIter = mModuleKeys.find(aModule);
+    if(keyIter == mModuleKeys.end()){
+        std::cerr << "Warning: ShaderModuleCache::release() called with a module not owned by the cache" << std::endl;
+        return;
+    }
+
+    ModuleMap::iterator entry = keyIter->second;
+    if(--entry->second.refCount == 0){
+        vkDestroyShaderModule(mDevice, entry->second.module, nullptr);
+        mModules.erase(entry);
+        mModuleKeys.erase(keyIter);
+    }
+}
+
+void ShaderModuleCache::clear(){
+    for(std::pair<const ContentKey, CachedModule>& entry : mModules){
+        vkDestroyShaderModule(mDevice, entry.second.module, nullptr);
+    }
+    mModules.clear();
+    mModuleKeys.clear();
+}
+
+std::string ShaderModuleCache::getReportString() const{
+    std::ostringstream reportBuilder;
+    reportBuilder << mStats.modulesCreated << " modules created (" << mStats.bytesLoaded << " bytes), "
+                  << mStats.cacheHits << " cache hits (" << mStats.bytesAvoided << " bytes avoided)";
+    return(reportBuilder.str());
+}
+
+uint64_t ShaderModuleCache::hashContents(const uint8_t* aData, size_t aSize){
+    uint64_t hash = 14695981039346656037ULL;
+    for(size_t i = 0; i < aSize; ++i){
+        hash ^= static_cast<uint64_t>(aData[i]);
+        hash *= 1099511628211ULL;
+    }
+    return(hash);
+}
+
+} // end namespace vkutils
@@ -0,0 +1,92 @@
+#ifndef SHADER_MODULE_CACHE_H_
+#define SHADER_MODULE_CACHE_H_
+#include "SpirvReflection.h"
+#include <vulkan/vulkan.h>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vkutils{
+
+/** Cache of shader modules keyed by a hash of their SPIR-V contents. 
+ * Every unique SPIR-V blob is turned into exactly one VkShaderModule, which is shared by all
+ * callers requesting the same code. Modules are reference counted: each acquire*() must be paired
+ * with a release() of the returned module, and the module is destroyed when its count hits zero. 
+ * Files are memory mapped and hashed in place, so loading never copies the code into a temporary buffer.
+ * Each cached module keeps one copy of its code, which a matching hash is compared against before it
+ * counts as a hit, so a hash collision creates a separate module instead of sharing the wrong one.
+ * Each module is reflected once when created, see getReflection().
+*/
+class ShaderModuleCache
+{
+ public:
+    struct Stats
+    {
+        size_t modulesCreated = 0;
+        size_t cacheHits = 0;
+        size_t bytesLoaded = 0;   // SPIR-V bytes handed to vkCreateShaderModule
+        size_t bytesAvoided = 0;  // SPIR-V bytes served by an existing module instead
+    };
+
+    ShaderModuleCache(){}
+    ShaderModuleCache(const VkDevice& aDevice) : mDevice(aDevice) {}
+    ~ShaderModuleCache();
+
+    ShaderModuleCache(const ShaderModuleCache&) = delete;
+    ShaderModuleCache& operator=(const ShaderModuleCache&) = delete;
+
+    /// Set the device modules are created on. Must be called before any modules are acquired.
+    void setDevice(const VkDevice& aDevice);
+    const VkDevice& getDevice() const {return(mDevice);}
+
+    /// Acquire a module for the compiled SPIR-V file at aFilePath. Returns VK_NULL_HANDLE on failure.
+    VkShaderModule acquireFromFile(const std::string& aFilePath);
+    /// Acquire a module for SPIR-V already in memory. aCodeSize is in bytes.
+    VkShaderModule acquireFromMemory(const uint32_t* aCode, size_t aCodeSize);
+    /// Acquire a module for an embedded shader by name, e.g. "standard.vert". Falls back to SHADER_DIR if it was not embedded.
+    VkShaderModule acquireEmbedded(const std::string& aShaderName);
+
+    /// Release one reference to aModule. The module is destroyed once it is no longer referenced.
+    void release(VkShaderModule aModule);
+
+    /// True if aModule was created by, and is still owned by, this cache
+    bool contains(VkShaderModule aModule) const {return(mModuleKeys.count(aModule) > 0);}
+    size_t size() const {return(mModules.size());}
+
+    /// Reflection of the SPIR-V aModule was created from. Returns nullptr if aModule is not cached or could not be reflected.
+    const ShaderReflection* getReflection(VkShaderModule aModule) const;
+
+    /// Destroy all modules regardless of their reference count.
+    void clear();
+
+    const Stats& getStats() const {return(mStats);}
+    std::string getReportString() const;
+
+    /// 64-bit FNV-1a hash of aSize bytes starting at aData
+    static uint64_t hashContents(const uint8_t* aData, size_t aSize);
+
+ protected:
+    // Contents hash and size in bytes
+    using ContentKey = std::pair<uint64_t, size_t>;
+
+    struct CachedModule
+    {
+        VkShaderModule module = VK_NULL_HANDLE;
+        uint32_t refCount = 0;
+        std::vector<uint32_t> code;
+        bool reflected = false;
+        ShaderReflection reflection;
+    };
+
+    VkDevice mDevice = VK_NULL_HANDLE;
+    using ModuleMap = std::multimap<ContentKey, CachedModule>; // Colliding contents share a key
+    ModuleMap mModules;
+    std::unordered_map<VkShaderModule, ModuleMap::iterator> mModuleKeys;
+    Stats mStats;
+};
+
+} // end namespace vkutils
+
+#endif
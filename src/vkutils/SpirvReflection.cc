@@ -0,0 +1,568 @@
+#include "SpirvReflection.h"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace vkutils{
+
+namespace{
+
+// Subset of the SPIR-V specification needed for reflection
+const uint32_t sSpirvMagic = 0x07230203;
+const uint32_t sHeaderWordCount = 5;
+
+enum SpvOp : uint32_t {
+    OpName = 5,
+    OpEntryPoint = 15,
+    OpTypeBool = 20,
+    OpTypeInt = 21,
+    OpTypeFloat = 22,
+    OpTypeVector = 23,
+    OpTypeMatrix = 24,
+    OpTypeImage = 25,
+    OpTypeSampler = 26,
+    OpTypeSampledImage = 27,
+    OpTypeArray = 28,
+    OpTypeRuntimeArray = 29,
+    OpTypeStruct = 30,
+    OpTypePointer = 32,
+    OpConstant = 43,
+    OpVariable = 59,
+    OpDecorate = 71,
+    OpMemberDecorate = 72
+};
+
+enum SpvDecoration : uint32_t {
+    DecorationBlock = 2,
+    DecorationBufferBlock = 3,
+    DecorationArrayStride = 6,
+    DecorationMatrixStride = 7,
+    DecorationBuiltIn = 11,
+    DecorationLocation = 30,
+    DecorationBinding = 33,
+    DecorationDescriptorSet = 34,
+    DecorationOffset = 35
+};
+
+enum SpvStorageClass : uint32_t {
+    StorageClassUniformConstant = 0,
+    StorageClassInput = 1,
+    StorageClassUniform = 2,
+    StorageClassPushConstant = 9,
+    StorageClassStorageBuffer = 12
+};
+
+const uint32_t sDimBuffer = 5;
+const uint32_t sDimSubpassData = 6;
+
+struct TypeInfo
+{
+    uint32_t op = 0;
+    std::vector<uint32_t> operands; // Instruction operands following the result id
+};
+
+struct IdDecorations
+{
+    bool block = false;
+    bool bufferBlock = false;
+    bool builtIn = false;
+    bool hasLocation = false;
+    bool hasBinding = false;
+    uint32_t location = 0;
+    uint32_t binding = 0;
+    uint32_t set = 0;
+    uint32_t arrayStride = 0;
+    std::map<uint32_t, uint32_t> memberOffsets;
+    std::map<uint32_t, uint32_t> memberMatrixStrides;
+};
+
+struct Variable
+{
+    uint32_t id;
+    uint32_t pointerType;
+    uint32_t storageClass;
+};
+
+std::string read_literal_string(const uint32_t* aWords, size_t aWordCount){
+    std::string result;
+    const char* chars = reinterpret_cast<const char*>(aWords);
+    for(size_t i = 0; i < aWordCount * sizeof(uint32_t) && chars[i] != '\0'; ++i){
+        result.push_back(chars[i]);
+    }
+    return(result);
+}
+
+VkShaderStageFlagBits stage_from_execution_model(uint32_t aModel){
+    switch(aModel){
+        case 0: return(VK_SHADER_STAGE_VERTEX_BIT);
+        case 1: return(VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT);
+        case 2: return(VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT);
+        case 3: return(VK_SHADER_STAGE_GEOMETRY_BIT);
+        case 4: return(VK_SHADER_STAGE_FRAGMENT_BIT);
+        case 5: return(VK_SHADER_STAGE_COMPUTE_BIT);
+        default: return(static_cast<VkShaderStageFlagBits>(0));
+    }
+}
+
+class SpirvParser
+{
+ public:
+    SpirvParser(const uint32_t* aCode, size_t aWordCount) : mCode(aCode), mWordCount(aWordCount) {}
+
+    ShaderReflection parse();
+
+ private:
+    const TypeInfo& getType(uint32_t aId) const;
+    uint32_t getConstant(uint32_t aId) const;
+    uint32_t sizeOfType(uint32_t aTypeId) const;
+    VkFormat formatOfType(uint32_t aTypeId, uint32_t& aSizeOut) const;
+    void reflectDescriptor(const Variable& aVariable, ShaderReflection& aReflection) const;
+    void reflectPushConstant(const Variable& aVariable, ShaderReflection& aReflection) const;
+    void reflectVertexInput(const Variable& aVariable, ShaderReflection& aReflection) const;
+
+    const uint32_t* mCode;
+    size_t mWordCount;
+
+    std::unordered_map<uint32_t, TypeInfo> mTypes;
+    std::unordered_map<uint32_t, uint32_t> mConstants;
+    std::unordered_map<uint32_t, std::string> mNames;
+    std::unordered_map<uint32_t, IdDecorations> mDecorations;
+    std::vector<Variable> mVariables;
+};
+
+ShaderReflection SpirvParser::parse(){
+    ShaderReflection reflection;
+    bool foundEntryPoint = false;
+
+    size_t pos = sHeaderWordCount;
+    while(pos < mWordCount){
+        uint32_t opcode = mCode[pos] & 0xFFFFU;
+        uint32_t wordCount = mCode[pos] >> 16;
+        if(wordCount == 0 || pos + wordCount > mWordCount){
+            throw std::runtime_error("Malformed SPIR-V instruction at word " + std::to_string(pos));
+        }
+        const uint32_t* operands = mCode + pos + 1;
+        size_t operandCount = wordCount - 1;
+
+        switch(opcode){
+            case OpName:
+                if(operandCount >= 2) mNames[operands[0]] = read_literal_string(operands + 1, operandCount - 1);
+                break;
+            case OpEntryPoint:
+                // Only the first entry point is reflected
+                if(!foundEntryPoint && operandCount >= 3){
+                    reflection.stage = stage_from_execution_model(operands[0]);
+                    reflection.entryPoint = read_literal_string(operands + 2, operandCount - 2);
+                    foundEntryPoint = true;
+                }
+                break;
+            case OpTypeBool: case OpTypeInt: case OpTypeFloat: case OpTypeVector: case OpTypeMatrix:
+            case OpTypeImage: case OpTypeSampler: case OpTypeSampledImage: case OpTypeArray:
+            case OpTypeRuntimeArray: case OpTypeStruct: case OpTypePointer:
+                if(operandCount >= 1){
+                    TypeInfo& type = mTypes[operands[0]];
+                    type.op = opcode;
+                    type.operands.assign(operands + 1, operands + operandCount);
+                }
+                break;
+            case OpConstant:
+                if(operandCount >= 3) mConstants[operands[1]] = operands[2];
+                break;
+            case OpVariable:
+                if(operandCount >= 3) mVariables.push_back(Variable{operands[1], operands[0], operands[2]});
+                break;
+            case OpDecorate:
+                if(operandCount >= 2){
+                    IdDecorations& decorations = mDecorations[operands[0]];
+                    uint32_t value = operandCount >= 3 ? operands[2] : 0;
+                    switch(operands[1]){
+                        case DecorationBlock: decorations.block = true; break;
+                        case DecorationBufferBlock: decorations.bufferBlock = true; break;
+                        case DecorationBuiltIn: decorations.builtIn = true; break;
+                        case DecorationArrayStride: decorations.arrayStride = value; break;
+                        case DecorationLocation: decorations.location = value; decorations.hasLocation = true; break;
+                        case DecorationBinding: decorations.binding = value; decorations.hasBinding = true; break;
+                        case DecorationDescriptorSet: decorations.set = value; break;
+                        default: break;
+                    }
+                }
+                break;
+            case OpMemberDecorate:
+                if(operandCount >= 4){
+                    IdDecorations& decorations = mDecorations[operands[0]];
+                    if(operands[2] == DecorationOffset) decorations.memberOffsets[operands[1]] = operands[3];
+                    if(operands[2] == DecorationMatrixStride) decorations.memberMatrixStrides[operands[1]] = operands[3];
+                }
+                break;
+            default:
+                break;
+        }
+        pos += wordCount;
+    }
+
+    for(const Variable& variable : mVariables){
+        switch(variable.storageClass){
+            case StorageClassUniformConstant:
+            case StorageClassUniform:
+            case StorageClassStorageBuffer:
+                reflectDescriptor(variable, reflection);
+                break;
+            case StorageClassPushConstant:
+                reflectPushConstant(variable, reflection);
+                break;
+            case StorageClassInput:
+                if(reflection.stage == VK_SHADER_STAGE_VERTEX_BIT) reflectVertexInput(variable, reflection);
+                break;
+            default:
+                break;
+        }
+    }
+
+    auto bindingLess = [](const ReflectedDescriptor& lhs, const ReflectedDescriptor& rhs) -> bool {
+        return(lhs.set < rhs.set || (lhs.set == rhs.set && lhs.binding < rhs.binding));
+    };
+    std::sort(reflection.descriptors.begin(), reflection.descriptors.end(), bindingLess);
+    auto locationLess = [](const ReflectedVertexInput& lhs, const ReflectedVertexInput& rhs) -> bool {return(lhs.location < rhs.location);};
+    std::sort(reflection.vertexInputs.begin(), reflection.vertexInputs.end(), locationLess);
+
+    return(reflection);
+}
+
+const TypeInfo& SpirvParser::getType(uint32_t aId) const{
+    std::unordered_map<uint32_t, TypeInfo>::const_iterator found = mTypes.find(aId);
+    if(found == mTypes.end()){
+        throw std::runtime_error("SPIR-V references undeclared type id " + std::to_string(aId));
+    }
+    return(found->second);
+}
+
+uint32_t SpirvParser::getConstant(uint32_t aId) const{
+    std::unordered_map<uint32_t, uint32_t>::const_iterator found = mConstants.find(aId);
+    // Array lengths from specialization constants are unknown until pipeline creation. Treat them as a single element.
+    return(found == mConstants.end() ? 1U : found->second);
+}
+
+uint32_t SpirvParser::sizeOfType(uint32_t aTypeId) const{
+    const TypeInfo& type = getType(aTypeId);
+    switch(type.op){
+        case OpTypeBool:
+            return(4U);
+        case OpTypeInt:
+        case OpTypeFloat:
+            return(type.operands[0] / 8U);
+        case OpTypeVector:
+            return(sizeOfType(type.operands[0]) * type.operands[1]);
+        case OpTypeMatrix:
+            return(sizeOfType(type.operands[0]) * type.operands[1]);
+        case OpTypeArray: {
+            auto decorations = mDecorations.find(aTypeId);
+            uint32_t stride = decorations != mDecorations.end() && decorations->second.arrayStride != 0 ? decorations->second.arrayStride : sizeOfType(type.operands[0]);
+            return(stride * getConstant(type.operands[1]));
+        }
+        case OpTypeRuntimeArray:
+            return(0U);
+        case OpTypeStruct: {
+            auto decorations = mDecorations.find(aTypeId);
+            uint32_t size = 0;
+            for(uint32_t member = 0; member < type.operands.size(); ++member){
+                uint32_t offset = 0;
+                uint32_t memberSize = sizeOfType(type.operands[member]);
+                if(decorations != mDecorations.end()){
+                    auto memberOffset = decorations->second.memberOffsets.find(member);
+                    if(memberOffset != decorations->second.memberOffsets.end()) offset = memberOffset->second;
+                    // Matrix columns are padded out to the matrix stride in std140/std430 blocks
+                    auto matrixStride = decorations->second.memberMatrixStrides.find(member);
+                    const TypeInfo& memberType = getType(type.operands[member]);
+                    if(matrixStride != decorations->second.memberMatrixStrides.end() && memberType.op == OpTypeMatrix){
+                        memberSize = matrixStride->second * memberType.operands[1];
+                    }
+                }else{
+                    offset = size;
+                }
+                size = std::max(size, offset + memberSize);
+            }
+            return(size);
+        }
+        default:
+            return(0U);
+    }
+}
+
+VkFormat SpirvParser::formatOfType(uint32_t aTypeId, uint32_t& aSizeOut) const{
+    const TypeInfo& type = getType(aTypeId);
+    uint32_t componentCount = 1;
+    const TypeInfo* component = &type;
+    if(type.op == OpTypeVector){
+        component = &getType(type.operands[0]);
+        componentCount = type.operands[1];
+    }
+    aSizeOut = sizeOfType(aTypeId);
+
+    if(componentCount < 1 || componentCount > 4) return(VK_FORMAT_UNDEFINED);
+    uint32_t width = component->op == OpTypeBool ? 32U : component->operands[0];
+    if(component->op == OpTypeFloat && width == 32){
+        static const VkFormat sFormats[] = {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT};
+        return(sFormats[componentCount - 1]);
+    }else if(component->op == OpTypeFloat && width == 64){
+        static const VkFormat sFormats[] = {VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT};
+        return(sFormats[componentCount - 1]);
+    }else if(component->op == OpTypeFloat && width == 16){
+        static const VkFormat sFormats[] = {VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT};
+        return(sFormats[componentCount - 1]);
+    }else if(component->op == OpTypeInt && width == 32 && component->operands[1] != 0){
+        static const VkFormat sFormats[] = {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT};
+        return(sFormats[componentCount - 1]);
+    }else if(component->op == OpTypeInt && width == 32){
+        static const VkFormat sFormats[] = {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT};
+        return(sFormats[componentCount - 1]);
+    }
+    return(VK_FORMAT_UNDEFINED);
+}
+
+void SpirvParser::reflectDescriptor(const Variable& aVariable, ShaderReflection& aReflection) const{
+    auto varDecorations = mDecorations.find(aVariable.id);
+    if(varDecorations == mDecorations.end() || !varDecorations->second.hasBinding) return;
+
+    ReflectedDescriptor descriptor;
+    descriptor.set = varDecorations->second.set;
+    descriptor.binding = varDecorations->second.binding;
+    auto name = mNames.find(aVariable.id);
+    if(name != mNames.end()) descriptor.name = name->second;
+
+    // Unwrap the pointer and any array to find the resource type
+    uint32_t typeId = getType(aVariable.pointerType).operands[1];
+    const TypeInfo* type = &getType(typeId);
+    if(type->op == OpTypeArray){
+        descriptor.count = getConstant(type->operands[1]);
+        typeId = type->operands[0];
+        type = &getType(typeId);
+    }else if(type->op == OpTypeRuntimeArray){
+        descriptor.count = 0;
+        typeId = type->operands[0];
+        type = &getType(typeId);
+    }
+
+    auto typeDecorations = mDecorations.find(typeId);
+    bool isBlock = typeDecorations != mDecorations.end() && typeDecorations->second.block;
+    bool isBufferBlock = typeDecorations != mDecorations.end() && typeDecorations->second.bufferBlock;
+
+    if(type->op == OpTypeStruct){
+        if(aVariable.storageClass == StorageClassStorageBuffer || isBufferBlock){
+            descriptor.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        }else if(isBlock){
+            descriptor.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        }else{
+            return;
+        }
+        descriptor.blockSize = sizeOfType(typeId);
+        if(descriptor.name.empty()){
+            auto typeName = mNames.find(typeId);
+            if(typeName != mNames.end()) descriptor.name = typeName->second;
+        }
+    }else if(type->op == OpTypeSampledImage){
+        const TypeInfo& image = getType(type->operands[0]);
+        descriptor.type = image.operands[1] == sDimBuffer ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    }else if(type->op == OpTypeImage){
+        // Operands: sampled type, dim, depth, arrayed, multisampled, sampled, format
+        uint32_t dim = type->operands[1];
+        bool storage = type->operands[5] == 2;
+        if(dim == sDimSubpassData){
+            descriptor.type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+        }else if(dim == sDimBuffer){
+            descriptor.type = storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+        }else{
+            descriptor.type = storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        }
+    }else if(type->op == OpTypeSampler){
+        descriptor.type = VK_DESCRIPTOR_TYPE_SAMPLER;
+    }else{
+        return;
+    }
+
+    aReflection.descriptors.emplace_back(descriptor);
+}
+
+void SpirvParser::reflectPushConstant(const Variable& aVariable, ShaderReflection& aReflection) const{
+    uint32_t typeId = getType(aVariable.pointerType).operands[1];
+    uint32_t size = sizeOfType(typeId);
+
+    // The range starts at the first member actually present in the block
+    uint32_t offset = 0;
+    auto decorations = mDecorations.find(typeId);
+    if(decorations != mDecorations.end() && !decorations->second.memberOffsets.empty()){
+        offset = size;
+        for(const std::pair<const uint32_t, uint32_t>& memberOffset : decorations->second.memberOffsets){
+            offset = std::min(offset, memberOffset.second);
+        }
+    }
+    if(size <= offset) return;
+
+    aReflection.pushConstants.emplace_back(VkPushConstantRange{
+        /* stageFlags = */ static_cast<VkShaderStageFlags>(aReflection.stage),
+        /* offset = */ offset,
+        /* size = */ size - offset
+    });
+}
+
+void SpirvParser::reflectVertexInput(const Variable& aVariable, ShaderReflection& aReflection) const{
+    auto decorations = mDecorations.find(aVariable.id);
+    if(decorations == mDecorations.end() || decorations->second.builtIn || !decorations->second.hasLocation) return;
+
+    // Arrays and matrices take one location per element and column
+    uint32_t typeId = getType(aVariable.pointerType).operands[1];
+    uint32_t elementCount = 1;
+    if(getType(typeId).op == OpTypeArray){
+        elementCount = getConstant(getType(typeId).operands[1]);
+        typeId = getType(typeId).operands[0];
+    }
+    uint32_t columnCount = 1;
+    if(getType(typeId).op == OpTypeMatrix){
+        columnCount = getType(typeId).operands[1];
+        typeId = getType(typeId).operands[0];
+    }
+
+    ReflectedVertexInput column;
+    column.format = formatOfType(typeId, column.size);
+    // Three and four component 64-bit vectors take two locations
+    const uint32_t locationsPerColumn = column.size > 16 ? 2U : 1U;
+    auto name = mNames.find(aVariable.id);
+    for(uint32_t element = 0; element < elementCount; ++element){
+        for(uint32_t col = 0; col < columnCount; ++col){
+            ReflectedVertexInput input = column;
+            input.location = decorations->second.location + (element * columnCount + col) * locationsPerColumn;
+            if(name != mNames.end()) input.name = name->second;
+            if(elementCount > 1) input.name += "[" + std::to_string(element) + "]";
+            if(columnCount > 1) input.name += "[" + std::to_string(col) + "]";
+            aReflection.vertexInputs.emplace_back(input);
+        }
+    }
+}
+
+} // end anonymous namespace
+
+const ReflectedDescriptor* ShaderReflection::findDescriptor(uint32_t aSet, uint32_t aBinding) const{
+    for(const ReflectedDescriptor& descriptor : descriptors){
+        if(descriptor.set == aSet && descriptor.binding == aBinding) return(&descriptor);
+    }
+    return(nullptr);
+}
+
+ShaderReflection reflect_spirv(const uint32_t* aCode, size_t aCodeSize){
+    if(aCode == nullptr || aCodeSize % sizeof(uint32_t) != 0 || aCodeSize / sizeof(uint32_t) < sHeaderWordCount || aCode[0] != sSpirvMagic){
+        throw std::runtime_error("Unable to reflect shader: Code is not valid SPIR-V");
+    }
+    SpirvParser parser(aCode, aCodeSize / sizeof(uint32_t));
+    return(parser.parse());
+}
+
+std::vector<VkDescriptorSetLayoutBinding> merge_descriptor_bindings(const std::vector<const ShaderReflection*>& aStages, uint32_t aSet){
+    std::map<uint32_t, VkDescriptorSetLayoutBinding> merged;
+    for(const ShaderReflection* stage : aStages){
+        for(const ReflectedDescriptor& descriptor : stage->descriptors){
+            if(descriptor.set != aSet) continue;
+            auto existing = merged.find(descriptor.binding);
+            if(existing == merged.end()){
+                merged[descriptor.binding] = VkDescriptorSetLayoutBinding{
+                    /* binding = */ descriptor.binding,
+                    /* descriptorType = */ descriptor.type,
+                    /* descriptorCount = */ descriptor.count,
+                    /* stageFlags = */ static_cast<VkShaderStageFlags>(stage->stage),
+                    /* pImmutableSamplers = */ nullptr
+                };
+            }else if(existing->second.descriptorType != descriptor.type){
+                throw std::runtime_error("Shader stages disagree on the descriptor type of set " + std::to_string(aSet) + " binding " + std::to_string(descriptor.binding));
+            }else{
+                existing->second.stageFlags |= stage->stage;
+                existing->second.descriptorCount = std::max(existing->second.descriptorCount, descriptor.count);
+            }
+        }
+    }
+
+    std::vector<VkDescriptorSetLayoutBinding> bindings;
+    bindings.reserve(merged.size());
+    for(const std::pair<const uint32_t, VkDescriptorSetLayoutBinding>& binding : merged){
+        bindings.emplace_back(binding.second);
+    }
+    return(bindings);
+}
+
+VkShaderStageFlags descriptor_stage_flags(const std::vector<const ShaderReflection*>& aStages, uint32_t aSet, uint32_t aBinding){
+    VkShaderStageFlags flags = 0;
+    for(const ShaderReflection* stage : aStages){
+        if(stage->findDescriptor(aSet, aBinding) != nullptr) flags |= stage->stage;
+    }
+    return(flags);
+}
+
+std::vector<VkPushConstantRange> merge_push_constant_ranges(const std::vector<const ShaderReflection*>& aStages){
+    // Stages sharing an identical range are merged into one range with combined stage flags
+    std::vector<VkPushConstantRange> ranges;
+    for(const ShaderReflection* stage : aStages){
+        for(const VkPushConstantRange& range : stage->pushConstants){
+            auto sameRange = [&range](const VkPushConstantRange& other) -> bool {return(other.offset == range.offset && other.size == range.size);};
+            std::vector<VkPushConstantRange>::iterator existing = std::find_if(ranges.begin(), ranges.end(), sameRange);
+            if(existing != ranges.end()){
+                existing->stageFlags |= range.stageFlags;
+            }else{
+                ranges.emplace_back(range);
+            }
+        }
+    }
+    return(ranges);
+}
+
+std::vector<VkPushConstantRange> split_push_constant_ranges(const std::vector<VkPushConstantRange>& aRanges){
+    std::vector<uint32_t> bounds;
+    for(const VkPushConstantRange& range : aRanges){
+        bounds.push_back(range.offset);
+        bounds.push_back(range.offset + range.size);
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+    std::vector<VkPushConstantRange> intervals;
+    for(size_t i = 1; i < bounds.size(); ++i){
+        VkShaderStageFlags stages = 0;
+        for(const VkPushConstantRange& range : aRanges){
+            if(range.offset <= bounds[i - 1] && range.offset + range.size >= bounds[i]) stages |= range.stageFlags;
+        }
+        if(stages == 0) continue;
+        // Neighbors covered by the same stages are pushed together
+        if(!intervals.empty() && intervals.back().stageFlags == stages && intervals.back().offset + intervals.back().size == bounds[i - 1]){
+            intervals.back().size += bounds[i] - bounds[i - 1];
+        }else{
+            intervals.push_back(VkPushConstantRange{stages, bounds[i - 1], bounds[i] - bounds[i - 1]});
+        }
+    }
+    return(intervals);
+}
+
+bool derive_vertex_input(
+    const ShaderReflection& aVertexStage, uint32_t aBinding,
+    VkVertexInputBindingDescription& aBindingOut, std::vector<VkVertexInputAttributeDescription>& aAttributesOut
+){
+    if(aVertexStage.vertexInputs.empty()) return(false);
+
+    aAttributesOut.clear();
+    uint32_t offset = 0;
+    for(const ReflectedVertexInput& input : aVertexStage.vertexInputs){
+        if(input.format == VK_FORMAT_UNDEFINED){
+            throw std::runtime_error("Unable to derive vertex input: Input '" + input.name + "' at location " + std::to_string(input.location) + " has no supported vertex format");
+        }
+        aAttributesOut.emplace_back(VkVertexInputAttributeDescription{
+            /* location = */ input.location,
+            /* binding = */ aBinding,
+            /* format = */ input.format,
+            /* offset = */ offset
+        });
+        offset += input.size;
+    }
+
+    aBindingOut.binding = aBinding;
+    aBindingOut.stride = offset;
+    aBindingOut.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    return(true);
+}
+
+} // end namespace vkutils
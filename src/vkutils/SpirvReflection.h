@@ -0,0 +1,71 @@
+#ifndef SPIRV_REFLECTION_H_
+#define SPIRV_REFLECTION_H_
+#include <vulkan/vulkan.h>
+#include <string>
+#include <vector>
+
+namespace vkutils{
+
+struct ReflectedDescriptor
+{
+    uint32_t set = 0;
+    uint32_t binding = 0;
+    VkDescriptorType type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    uint32_t count = 1;      // Array length. Zero for runtime sized arrays.
+    uint32_t blockSize = 0;  // Size in bytes of uniform and storage blocks. Zero for other descriptor types.
+    std::string name;
+};
+
+/// One per attribute location. Matrix and array inputs are split into one entry per column and element, e.g. "inModel[2]".
+struct ReflectedVertexInput
+{
+    uint32_t location = 0;
+    VkFormat format = VK_FORMAT_UNDEFINED; // Undefined for types with no vertex format, such as 64-bit integers
+    uint32_t size = 0; // Size in bytes of one element of the format
+    std::string name;
+};
+
+/** Resources used by a single shader stage, as declared in its SPIR-V.
+ * Only the information needed to build descriptor set layouts, pipeline layouts, and vertex input is extracted.
+*/
+struct ShaderReflection
+{
+    VkShaderStageFlagBits stage = static_cast<VkShaderStageFlagBits>(0);
+    std::string entryPoint;
+    std::vector<ReflectedDescriptor> descriptors;
+    std::vector<ReflectedVertexInput> vertexInputs; // Sorted by location. Only populated for vertex shaders.
+    std::vector<VkPushConstantRange> pushConstants;
+
+    const ReflectedDescriptor* findDescriptor(uint32_t aSet, uint32_t aBinding) const;
+};
+
+/// Parse SPIR-V code of aCodeSize bytes. Throws if the code is not valid SPIR-V.
+ShaderReflection reflect_spirv(const uint32_t* aCode, size_t aCodeSize);
+
+/// Descriptor set layout bindings for set aSet used by any of the given stages. Stage flags are the exact set of stages using each binding.
+std::vector<VkDescriptorSetLayoutBinding> merge_descriptor_bindings(const std::vector<const ShaderReflection*>& aStages, uint32_t aSet);
+
+/// Stage flags of every stage in aStages that uses descriptor (aSet, aBinding). Zero if no stage uses it.
+VkShaderStageFlags descriptor_stage_flags(const std::vector<const ShaderReflection*>& aStages, uint32_t aSet, uint32_t aBinding);
+
+/// Push constant ranges of all stages combined, suitable for VkPipelineLayoutCreateInfo
+std::vector<VkPushConstantRange> merge_push_constant_ranges(const std::vector<const ShaderReflection*>& aStages);
+
+/** Split layout ranges into non-overlapping intervals, sorted by offset, each with the stage flags of every range
+ * covering it. vkCmdPushConstants must name every stage whose range overlaps the pushed bytes, and only stages
+ * whose range covers all of them, so overlapping ranges of different stages are pushed interval by interval.
+*/
+std::vector<VkPushConstantRange> split_push_constant_ranges(const std::vector<VkPushConstantRange>& aRanges);
+
+/** Derive vertex input for tightly packed, interleaved attributes in a single buffer bound at aBinding.
+ * Attributes are laid out in order of location. Returns false if aVertexStage has no vertex inputs, and
+ * throws if an input has no vertex format.
+*/
+bool derive_vertex_input(
+    const ShaderReflection& aVertexStage, uint32_t aBinding,
+    VkVertexInputBindingDescription& aBindingOut, std::vector<VkVertexInputAttributeDescription>& aAttributesOut
+);
+
+} // end namespace vkutils
+
+#endif
@@ -0,0 +1,109 @@
+#include "TimelineSemaphore.h"
+#include <stdexcept>
+
+namespace vkutils{
+
+/// Look up a device function by its core name, falling back to its KHR extension name
+template<typename FunctionPtr>
+static FunctionPtr load_device_function(VkDevice aDevice, const char* aCoreName, const char* aKhrName){
+    PFN_vkVoidFunction function = vkGetDeviceProcAddr(aDevice, aCoreName);
+    if(function == nullptr) function = vkGetDeviceProcAddr(aDevice, aKhrName);
+    return(reinterpret_cast<FunctionPtr>(function));
+}
+
+TimelineSemaphore::~TimelineSemaphore(){
+    destroy();
+}
+
+void TimelineSemaphore::create(const VkDevice& aDevice, uint64_t aInitialValue){
+    destroy();
+
+    mWaitSemaphores = load_device_function<PFN_vkWaitSemaphores>(aDevice, "vkWaitSemaphores", "vkWaitSemaphoresKHR");
+    mGetCounterValue = load_device_function<PFN_vkGetSemaphoreCounterValue>(aDevice, "vkGetSemaphoreCounterValue", "vkGetSemaphoreCounterValueKHR");
+    mSignalSemaphore = load_device_function<PFN_vkSignalSemaphore>(aDevice, "vkSignalSemaphore", "vkSignalSemaphoreKHR");
+    if(mWaitSemaphores == nullptr || mGetCounterValue == nullptr || mSignalSemaphore == nullptr){
+        throw std::runtime_error("TimelineSemaphore Error: Timeline semaphore functions are not available on this device!");
+    }
+
+    VkSemaphoreTypeCreateInfo typeInfo;{
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        typeInfo.pNext = nullptr;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue = aInitialValue;
+    }
+    VkSemaphoreCreateInfo createInfo = {VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, &typeInfo, 0};
+    if(vkCreateSemaphore(aDevice, &createInfo, nullptr, &mSemaphore) != VK_SUCCESS){
+        mSemaphore = VK_NULL_HANDLE;
+        throw std::runtime_error("Failed to create timeline semaphore!");
+    }
+    mDevice = aDevice;
+}
+
+void TimelineSemaphore::destroy(){
+    if(mSemaphore != VK_NULL_HANDLE){
+        vkDestroySemaphore(mDevice, mSemaphore, nullptr);
+        mSemaphore = VK_NULL_HANDLE;
+    }
+}
+
+uint64_t TimelineSemaphore::getCompletedValue() const{
+    uint64_t value = 0;
+    if(mGetCounterValue(mDevice, mSemaphore, &value) != VK_SUCCESS){
+        throw std::runtime_error("Failed to read timeline semaphore value!");
+    }
+    return(value);
+}
+
+bool TimelineSemaphore::wait(uint64_t aValue, uint64_t aTimeoutNs) const{
+    VkSemaphoreWaitInfo waitInfo;{
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.pNext = nullptr;
+        waitInfo.flags = 0;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &mSemaphore;
+        waitInfo.pValues = &aValue;
+    }
+    VkResult result = mWaitSemaphores(mDevice, &waitInfo, aTimeoutNs);
+    if(result == VK_TIMEOUT) return(false);
+    if(result != VK_SUCCESS){
+        throw std::runtime_error("Failed to wait on timeline semaphore!");
+    }
+    return(true);
+}
+
+void TimelineSemaphore::signal(uint64_t aValue){
+    VkSemaphoreSignalInfo signalInfo = {VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO, nullptr, mSemaphore, aValue};
+    if(mSignalSemaphore(mDevice, &signalInfo) != VK_SUCCESS){
+        throw std::runtime_error("Failed to signal timeline semaphore!");
+    }
+}
+
+void DeferredTimelineQueue::enqueue(uint64_t aValue, std::function<void()> aCallback){
+    if(aCallback) mPending.emplace_back(aValue, std::move(aCallback));
+}
+
+size_t DeferredTimelineQueue::collect(uint64_t aCompletedValue){
+    // Move ready callbacks out first so callbacks may safely enqueue more work
+    std::vector<std::function<void()>> ready;
+    size_t kept = 0;
+    for(size_t i = 0; i < mPending.size(); ++i){
+        if(mPending[i].first <= aCompletedValue){
+            ready.push_back(std::move(mPending[i].second));
+        }else{
+            if(kept != i) mPending[kept] = std::move(mPending[i]);
+            ++kept;
+        }
+    }
+    mPending.resize(kept);
+
+    for(std::function<void()>& callback : ready){
+        callback();
+    }
+    return(ready.size());
+}
+
+void DeferredTimelineQueue::flush(){
+    collect(std::numeric_limits<uint64_t>::max());
+}
+
+} // end namespace vkutils
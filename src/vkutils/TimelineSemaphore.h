@@ -0,0 +1,74 @@
+#ifndef TIMELINE_SEMAPHORE_H_
+#define TIMELINE_SEMAPHORE_H_
+#include <vulkan/vulkan.h>
+#include <functional>
+#include <limits>
+#include <vector>
+#include <utility>
+
+namespace vkutils{
+
+/** Semaphore holding a monotonically increasing 64-bit counter (Vulkan 1.2, or VK_KHR_timeline_semaphore).
+ * Queue submissions signal it to increasing values, and the host can poll or wait for any value without
+ * needing a fence per submission. Requires the timelineSemaphore device feature to be enabled.
+*/
+class TimelineSemaphore
+{
+ public:
+    TimelineSemaphore(){}
+    ~TimelineSemaphore();
+
+    TimelineSemaphore(const TimelineSemaphore&) = delete;
+    TimelineSemaphore& operator=(const TimelineSemaphore&) = delete;
+
+    void create(const VkDevice& aDevice, uint64_t aInitialValue = 0);
+    void destroy();
+
+    bool isValid() const {return(mSemaphore != VK_NULL_HANDLE);}
+    VkSemaphore handle() const {return(mSemaphore);}
+
+    /// Highest value signaled so far
+    uint64_t getCompletedValue() const;
+    bool isComplete(uint64_t aValue) const {return(getCompletedValue() >= aValue);}
+
+    /// Block until aValue has been signaled. Returns false if aTimeoutNs elapses first.
+    bool wait(uint64_t aValue, uint64_t aTimeoutNs = std::numeric_limits<uint64_t>::max()) const;
+
+    /// Signal aValue from the host
+    void signal(uint64_t aValue);
+
+ protected:
+    VkDevice mDevice = VK_NULL_HANDLE;
+    VkSemaphore mSemaphore = VK_NULL_HANDLE;
+
+    // Loaded at creation so the same code works with the Vulkan 1.2 and KHR entry points
+    PFN_vkWaitSemaphores mWaitSemaphores = nullptr;
+    PFN_vkGetSemaphoreCounterValue mGetCounterValue = nullptr;
+    PFN_vkSignalSemaphore mSignalSemaphore = nullptr;
+};
+
+/** Work deferred until a timeline value completes, e.g. destroying resources still referenced by
+ * submitted command buffers, or reading back results once the GPU has produced them.
+*/
+class DeferredTimelineQueue
+{
+ public:
+    void enqueue(uint64_t aValue, std::function<void()> aCallback);
+
+    /// Run and drop every callback whose value is at most aCompletedValue, in the order they were enqueued.
+    /// Returns the number of callbacks run.
+    size_t collect(uint64_t aCompletedValue);
+
+    /// Run every pending callback regardless of value, e.g. once the device is idle
+    void flush();
+
+    size_t size() const {return(mPending.size());}
+    bool empty() const {return(mPending.empty());}
+
+ protected:
+    std::vector<std::pair<uint64_t, std::function<void()>>> mPending;
+};
+
+} // end namespace vkutils
+
+#endif
@@ -1,5 +1,4 @@
 #include "VulkanDevices.h"
-#include <set>
 #include <algorithm>
 
 QueueFamily::QueueFamily(const VkQueueFamilyProperties& aFamily, uint32_t aIndex) 
@@ -8,13 +7,32 @@ QueueFamily::QueueFamily(const VkQueueFamilyProperties& aFamily, uint32_t aIndex
   mFlags(aFamily.queueFlags),
   mMinImageTransferGranularity(aFamily.minImageTransferGranularity),
   mTimeStampValidBits(aFamily.timestampValidBits),
-  mGraphics(aFamily.queueFlags | VK_QUEUE_GRAPHICS_BIT),
-  mCompute(aFamily.queueFlags | VK_QUEUE_COMPUTE_BIT),
-  mTransfer(aFamily.queueFlags | VK_QUEUE_TRANSFER_BIT),
-  mSparseBinding(aFamily.queueFlags | VK_QUEUE_SPARSE_BINDING_BIT),
-  mProtected(aFamily.queueFlags | VK_QUEUE_PROTECTED_BIT)
+  mGraphics((aFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0),
+  mCompute((aFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) != 0),
+  mTransfer((aFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) != 0),
+  mSparseBinding((aFamily.queueFlags & VK_QUEUE_SPARSE_BINDING_BIT) != 0),
+  mProtected((aFamily.queueFlags & VK_QUEUE_PROTECTED_BIT) != 0)
 {}
 
+VkQueue QueueAllocator::acquire(QueueRoleEnum aRole){
+    const std::vector<VkQueue>& queues = mQueues[aRole];
+    if(queues.empty()) return(VK_NULL_HANDLE);
+    VkQueue queue = queues[mNextQueue[aRole] % queues.size()];
+    mNextQueue[aRole] = (mNextQueue[aRole] + 1) % queues.size();
+    return(queue);
+}
+
+VkQueue QueueAllocator::getQueue(QueueRoleEnum aRole, uint32_t aIndex) const{
+    if(aIndex >= mQueues[aRole].size()) return(VK_NULL_HANDLE);
+    return(mQueues[aRole][aIndex]);
+}
+
+bool QueueAllocator::isDedicated(QueueRoleEnum aRole) const{
+    if(!mFamilies[aRole]) return(false);
+    if(!mFamilies[QUEUE_ROLE_GRAPHICS]) return(true);
+    return(*mFamilies[aRole] != *mFamilies[QUEUE_ROLE_GRAPHICS]);
+}
+
 VulkanPhysicalDevice::VulkanPhysicalDevice(VkPhysicalDevice aDevice) : mHandle(aDevice) {
     vkGetPhysicalDeviceProperties(aDevice, &mProperites);
     vkGetPhysicalDeviceFeatures(aDevice, &mFeatures);
@@ -79,42 +97,156 @@ opt::optional<uint32_t> VulkanPhysicalDevice::getPresentableQueueIndex(const VkS
     return(opt::optional<uint32_t>());
 }
 
-VulkanDevice VulkanPhysicalDevice::createDevice(VkQueueFlags aQueues, const std::vector<const char*>& aExtensions, VkSurfaceKHR aSurface) const{
-    std::set<uint32_t> queueFamilyIndices;
-    if(aQueues | VK_QUEUE_GRAPHICS_BIT && mGraphicsIdx) queueFamilyIndices.emplace(*mGraphicsIdx);
-    if(aQueues | VK_QUEUE_COMPUTE_BIT && mComputeIdx) queueFamilyIndices.emplace(*mComputeIdx);
-    if(aQueues | VK_QUEUE_TRANSFER_BIT && mTransferIdx) queueFamilyIndices.emplace(*mTransferIdx);
-    if(aQueues | VK_QUEUE_PROTECTED_BIT && mProtectedIdx) queueFamilyIndices.emplace(*mProtectedIdx);
-    if(aQueues | VK_QUEUE_SPARSE_BINDING_BIT && mSparseBindIdx) queueFamilyIndices.emplace(*mSparseBindIdx);
-    
+bool VulkanPhysicalDevice::hasExtension(const std::string& aExtensionName) const{
+    for(const VkExtensionProperties& extension : mAvailableExtensions){
+        if(aExtensionName == extension.extensionName) return(true);
+    }
+    return(false);
+}
+
+VkPhysicalDeviceDescriptorIndexingFeaturesEXT VulkanPhysicalDevice::queryDescriptorIndexingFeatures() const{
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures = {};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    if(!hasExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) return(indexingFeatures);
+
+    VkPhysicalDeviceFeatures2 features = {};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &indexingFeatures;
+    vkGetPhysicalDeviceFeatures2(mHandle, &features);
+    indexingFeatures.pNext = nullptr;
+    return(indexingFeatures);
+}
+
+VkPhysicalDeviceDescriptorIndexingPropertiesEXT VulkanPhysicalDevice::queryDescriptorIndexingProperties() const{
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties = {};
+    indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+    if(!hasExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) return(indexingProperties);
+
+    VkPhysicalDeviceProperties2 properties = {};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &indexingProperties;
+    vkGetPhysicalDeviceProperties2(mHandle, &properties);
+    indexingProperties.pNext = nullptr;
+    return(indexingProperties);
+}
+
+template<typename Predicate>
+static opt::optional<uint32_t> find_family(const std::vector<QueueFamily>& aFamilies, Predicate aPredicate){
+    for(const QueueFamily& family : aFamilies){
+        if(family.mCount > 0 && aPredicate(family)) return(opt::optional<uint32_t>(family.mIndex));
+    }
+    return(opt::optional<uint32_t>());
+}
+
+QueueAssignment VulkanPhysicalDevice::assignQueues(const std::vector<QueueFamily>& aFamilies, VkQueueFlags aQueues, const QueueSelectionPolicy& aPolicy, opt::optional<uint32_t> aPresentFamily){
+    QueueAssignment assignment;
+    opt::optional<uint32_t>& graphics = assignment.roles[QUEUE_ROLE_GRAPHICS].family;
+    opt::optional<uint32_t>& compute = assignment.roles[QUEUE_ROLE_COMPUTE].family;
+    opt::optional<uint32_t>& transfer = assignment.roles[QUEUE_ROLE_TRANSFER].family;
+
+    if(aQueues & VK_QUEUE_GRAPHICS_BIT){
+        // Rendering on the presenting family avoids transferring swapchain image ownership between families
+        if(aPresentFamily && *aPresentFamily < aFamilies.size() && aFamilies[*aPresentFamily].mGraphics){
+            graphics = aPresentFamily;
+        }else{
+            graphics = find_family(aFamilies, [](const QueueFamily& aFamily){return(aFamily.mGraphics);});
+        }
+    }
+
+    if(aQueues & VK_QUEUE_COMPUTE_BIT){
+        if(aPolicy.preferDedicatedCompute){
+            compute = find_family(aFamilies, [](const QueueFamily& aFamily){return(aFamily.isDedicatedCompute());});
+        }
+        if(!compute && graphics && aFamilies[*graphics].mCompute){
+            compute = graphics;
+        }
+        if(!compute){
+            compute = find_family(aFamilies, [](const QueueFamily& aFamily){return(aFamily.mCompute);});
+        }
+    }
+
+    if(aQueues & VK_QUEUE_TRANSFER_BIT){
+        if(aPolicy.preferDedicatedTransfer){
+            transfer = find_family(aFamilies, [](const QueueFamily& aFamily){return(aFamily.isDedicatedTransfer());});
+        }
+        // Graphics and compute families support transfers whether or not they report the transfer bit
+        if(!transfer) transfer = graphics;
+        if(!transfer) transfer = compute;
+        if(!transfer){
+            transfer = find_family(aFamilies, [](const QueueFamily& aFamily){return(aFamily.mTransfer);});
+        }
+    }
+
+    // Hand out queues of each family in role order. Once a family runs out, later roles share its queues.
+    std::map<uint32_t, uint32_t> usedCounts;
+    for(uint32_t role = 0; role < QUEUE_ROLE_COUNT; ++role){
+        QueueAssignment::Role& assigned = assignment.roles[role];
+        if(!assigned.family) continue;
+
+        const uint32_t familyCount = aFamilies[*assigned.family].mCount;
+        const uint32_t wanted = std::max(aPolicy.queueCounts[role], 1U);
+        uint32_t& used = usedCounts[*assigned.family];
+        std::vector<float>& priorities = assignment.familyPriorities[*assigned.family];
+
+        if(used < familyCount){
+            assigned.firstQueue = used;
+            assigned.queueCount = std::min(wanted, familyCount - used);
+            used += assigned.queueCount;
+            priorities.insert(priorities.end(), assigned.queueCount, std::min(std::max(aPolicy.priorities[role], 0.0f), 1.0f));
+        }else{
+            assigned.firstQueue = 0;
+            assigned.queueCount = std::min(wanted, used);
+        }
+    }
+
+    if(aPresentFamily){
+        assignment.presentFamily = aPresentFamily;
+        std::vector<float>& priorities = assignment.familyPriorities[*aPresentFamily];
+        if(priorities.empty()) priorities.push_back(1.0f);
+    }
+
+    return(assignment);
+}
+
+VulkanDevice VulkanPhysicalDevice::createDevice(VkQueueFlags aQueues, const std::vector<const char*>& aExtensions, VkSurfaceKHR aSurface, const void* aFeatureChain, const QueueSelectionPolicy& aPolicy, const VkPhysicalDeviceFeatures* aEnabledFeatures) const{
     opt::optional<uint32_t> presentationIdx;
     if(aSurface != VK_NULL_HANDLE){
         presentationIdx = getPresentableQueueIndex(aSurface); 
-        if(presentationIdx){
-            queueFamilyIndices.emplace(*presentationIdx);
-        }else{
+        if(!presentationIdx){
             throw std::runtime_error("Unable to get presentation queue during device creation!");
         }
     }
 
-    float priorities = 1.0f;
-    std::vector<VkDeviceQueueCreateInfo> queueCreateInfos(queueFamilyIndices.size());
-    std::set<uint32_t>::const_iterator famIter = queueFamilyIndices.begin();
-    size_t i = 0;
-    while(famIter != queueFamilyIndices.end()){
-        queueCreateInfos[i].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-        queueCreateInfos[i].pNext = nullptr;
-        queueCreateInfos[i].queueCount = 1;
-        queueCreateInfos[i].queueFamilyIndex = *famIter;
-        queueCreateInfos[i].pQueuePriorities = &priorities;
-        ++famIter; ++i;
+    QueueAssignment assignment = assignQueues(mQueueFamilies, aQueues, aPolicy, presentationIdx);
+
+    // Sparse binding and protected queues are not handed out by the allocator. One queue of their family is enough.
+    if((aQueues & VK_QUEUE_PROTECTED_BIT) && mProtectedIdx && assignment.familyPriorities[*mProtectedIdx].empty()){
+        assignment.familyPriorities[*mProtectedIdx].push_back(1.0f);
+    }
+    if((aQueues & VK_QUEUE_SPARSE_BINDING_BIT) && mSparseBindIdx && assignment.familyPriorities[*mSparseBindIdx].empty()){
+        assignment.familyPriorities[*mSparseBindIdx].push_back(1.0f);
+    }
+
+    std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+    queueCreateInfos.reserve(assignment.familyPriorities.size());
+    for(const std::pair<const uint32_t, std::vector<float>>& family : assignment.familyPriorities){
+        VkDeviceQueueCreateInfo queueInfo;
+        {
+            queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            queueInfo.pNext = nullptr;
+            queueInfo.flags = 0;
+            queueInfo.queueFamilyIndex = family.first;
+            queueInfo.queueCount = static_cast<uint32_t>(family.second.size());
+            queueInfo.pQueuePriorities = family.second.data();
+        }
+        queueCreateInfos.push_back(queueInfo);
     }
 
     VkDeviceCreateInfo createInfo;
     {
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-        createInfo.pNext = nullptr;
-        createInfo.pEnabledFeatures = {};
+        createInfo.pNext = aFeatureChain;
+        createInfo.pEnabledFeatures = aEnabledFeatures;
         createInfo.flags = 0;
         createInfo.ppEnabledLayerNames = nullptr;
         createInfo.enabledLayerCount = 0;
@@ -131,12 +263,31 @@ VulkanDevice VulkanPhysicalDevice::createDevice(VkQueueFlags aQueues, const std:
 
     VulkanDevice device = VulkanDevice(deviceHandle);
 
-    if(mGraphicsIdx) vkGetDeviceQueue(deviceHandle, *mGraphicsIdx, 0, &device.mGraphicsQueue);
-    if(mComputeIdx) vkGetDeviceQueue(deviceHandle, *mComputeIdx, 0, &device.mComputeQueue);
-    if(mTransferIdx) vkGetDeviceQueue(deviceHandle, *mTransferIdx, 0, &device.mTransferQueue);
-    if(presentationIdx) vkGetDeviceQueue(deviceHandle, *presentationIdx, 0, &device.mPresentationQueue);
-    if(mProtectedIdx) vkGetDeviceQueue(deviceHandle, *mProtectedIdx, 0, &device.mProtectedQueue);
-    if(mSparseBindIdx) vkGetDeviceQueue(deviceHandle, *mSparseBindIdx, 0, &device.mSparseBindingQueue);
+    QueueAllocator& allocator = device.mQueueAllocator;
+    for(uint32_t role = 0; role < QUEUE_ROLE_COUNT; ++role){
+        const QueueAssignment::Role& assigned = assignment.roles[role];
+        if(!assigned.family) continue;
+        allocator.mFamilies[role] = assigned.family;
+        allocator.mQueues[role].resize(assigned.queueCount, VK_NULL_HANDLE);
+        for(uint32_t i = 0; i < assigned.queueCount; ++i){
+            vkGetDeviceQueue(deviceHandle, *assigned.family, assigned.firstQueue + i, &allocator.mQueues[role][i]);
+        }
+    }
+    if(presentationIdx){
+        allocator.mPresentFamily = presentationIdx;
+        if(allocator.mFamilies[QUEUE_ROLE_GRAPHICS] && *allocator.mFamilies[QUEUE_ROLE_GRAPHICS] == *presentationIdx){
+            allocator.mPresentQueue = allocator.getQueue(QUEUE_ROLE_GRAPHICS);
+        }else{
+            vkGetDeviceQueue(deviceHandle, *presentationIdx, 0, &allocator.mPresentQueue);
+        }
+    }
+
+    device.mGraphicsQueue = allocator.getQueue(QUEUE_ROLE_GRAPHICS);
+    device.mComputeQueue = allocator.getQueue(QUEUE_ROLE_COMPUTE);
+    device.mTransferQueue = allocator.getQueue(QUEUE_ROLE_TRANSFER);
+    device.mPresentationQueue = allocator.getPresentQueue();
+    if((aQueues & VK_QUEUE_PROTECTED_BIT) && mProtectedIdx) vkGetDeviceQueue(deviceHandle, *mProtectedIdx, 0, &device.mProtectedQueue);
+    if((aQueues & VK_QUEUE_SPARSE_BINDING_BIT) && mSparseBindIdx) vkGetDeviceQueue(deviceHandle, *mSparseBindIdx, 0, &device.mSparseBindingQueue);
 
     return(device);
 }
@@ -3,6 +3,8 @@
 #include <vulkan/vulkan.h>
 #include "utils/optional.h"
 #include <vector>
+#include <string>
+#include <map>
 #include <stdexcept>
 #include <limits>
 
@@ -14,6 +16,10 @@ class QueueFamily
 
     inline bool hasCoreQueueSupport() const {return(mGraphics && mCompute && mTransfer);}
     inline bool hasAllQueueSupport() const {return(mGraphics && mCompute && mTransfer && mSparseBinding && mProtected);}
+    /// Compute family without graphics support, typically backed by separate hardware queues
+    inline bool isDedicatedCompute() const {return(mCompute && !mGraphics);}
+    /// Transfer-only family, typically backed by a DMA engine
+    inline bool isDedicatedTransfer() const {return(mTransfer && !mGraphics && !mCompute);}
 
     const uint32_t mIndex = std::numeric_limits<uint32_t>::max();
     const uint32_t mCount = 0;
@@ -42,6 +48,72 @@ struct VulkanDeviceHandlePair
    friend bool operator!=(const VulkanDeviceHandlePair& lhs, const VulkanDeviceHandlePair& rhs){return(!operator==(lhs, rhs));}
 };
 
+enum QueueRoleEnum{
+    QUEUE_ROLE_GRAPHICS = 0,
+    QUEUE_ROLE_COMPUTE,
+    QUEUE_ROLE_TRANSFER,
+    QUEUE_ROLE_COUNT
+};
+
+/** Controls how createDevice() picks a queue family for each role and how many queues of it to create.
+ * Dedicated compute-only and transfer-only families run in parallel with graphics work on most discrete
+ * GPUs, so they are preferred when present. Requested counts are clamped to what each family offers, and
+ * roles sharing a family share its queues once they run out.
+*/
+struct QueueSelectionPolicy
+{
+    bool preferDedicatedCompute = true;
+    bool preferDedicatedTransfer = true;
+    uint32_t queueCounts[QUEUE_ROLE_COUNT] = {1, 1, 1};
+    float priorities[QUEUE_ROLE_COUNT] = {1.0f, 0.5f, 0.5f};
+};
+
+/// Queue family and range of queues chosen for each role, along with the queues to create per family
+struct QueueAssignment
+{
+    struct Role
+    {
+        opt::optional<uint32_t> family;
+        uint32_t firstQueue = 0;
+        uint32_t queueCount = 0;
+    };
+
+    Role roles[QUEUE_ROLE_COUNT];
+    opt::optional<uint32_t> presentFamily;
+    /// Priority of every queue to create, keyed by family index
+    std::map<uint32_t, std::vector<float>> familyPriorities;
+};
+
+/** Queues created for each role of a device.
+ * acquire() hands out the queues of a role round-robin, so independent submitters such as upload threads
+ * spread across every queue available to them. Submission to a single VkQueue must still be externally
+ * synchronized, and acquire() itself is not thread safe, so acquire queues up front for each worker.
+*/
+class QueueAllocator
+{
+ public:
+    VkQueue acquire(QueueRoleEnum aRole);
+
+    VkQueue getQueue(QueueRoleEnum aRole, uint32_t aIndex = 0) const;
+    uint32_t getQueueCount(QueueRoleEnum aRole) const {return(static_cast<uint32_t>(mQueues[aRole].size()));}
+    opt::optional<uint32_t> getFamilyIndex(QueueRoleEnum aRole) const {return(mFamilies[aRole]);}
+
+    VkQueue getPresentQueue() const {return(mPresentQueue);}
+    opt::optional<uint32_t> getPresentFamilyIndex() const {return(mPresentFamily);}
+
+    /// True if aRole has queues from a different family than graphics, so its work can overlap graphics work
+    bool isDedicated(QueueRoleEnum aRole) const;
+
+ protected:
+    friend class VulkanPhysicalDevice;
+
+    std::vector<VkQueue> mQueues[QUEUE_ROLE_COUNT];
+    opt::optional<uint32_t> mFamilies[QUEUE_ROLE_COUNT];
+    uint32_t mNextQueue[QUEUE_ROLE_COUNT] = {0, 0, 0};
+    VkQueue mPresentQueue = VK_NULL_HANDLE;
+    opt::optional<uint32_t> mPresentFamily;
+};
+
 class VulkanDevice
 {
  public:
@@ -58,6 +130,9 @@ class VulkanDevice
     VkQueue getProtectedQueue() const {return(mProtectedQueue);}
     VkQueue getPresentationQueue() const {return(mPresentationQueue);}
 
+    QueueAllocator& getQueueAllocator() {return(mQueueAllocator);}
+    const QueueAllocator& getQueueAllocator() const {return(mQueueAllocator);}
+
     operator VkDevice() const {return(mHandle);}
 
  protected:
@@ -73,6 +148,8 @@ class VulkanDevice
     VkQueue mSparseBindingQueue = VK_NULL_HANDLE;
     VkQueue mProtectedQueue = VK_NULL_HANDLE;
     VkQueue mPresentationQueue = VK_NULL_HANDLE;
+
+    QueueAllocator mQueueAllocator;
 };
 
 struct SwapChainSupportInfo;
@@ -89,17 +166,42 @@ class VulkanPhysicalDevice
 
    opt::optional<uint32_t> getPresentableQueueIndex(const VkSurfaceKHR aSurface) const;
    
+   bool hasExtension(const std::string& aExtensionName) const;
+
+   /// Descriptor indexing support, queried through vkGetPhysicalDeviceFeatures2(). Every field is false if unsupported.
+   VkPhysicalDeviceDescriptorIndexingFeaturesEXT queryDescriptorIndexingFeatures() const;
+   VkPhysicalDeviceDescriptorIndexingPropertiesEXT queryDescriptorIndexingProperties() const;
+
+   /// Pick queue families and queue ranges for the roles in aQueues out of aFamilies according to aPolicy
+   static QueueAssignment assignQueues(
+      const std::vector<QueueFamily>& aFamilies, VkQueueFlags aQueues,
+      const QueueSelectionPolicy& aPolicy, opt::optional<uint32_t> aPresentFamily = opt::optional<uint32_t>()
+   );
+
+   /** Create a logical device.
+    * aFeatureChain is an optional pNext chain of feature structures (e.g. VkPhysicalDeviceDescriptorIndexingFeaturesEXT)
+    * to enable, and aEnabledFeatures optional core features for devices where the chain can't hold VkPhysicalDeviceFeatures2.
+    * They must only request features the device reports as supported. 
+    * Queues are created as chosen by assignQueues() and made available through the device's QueueAllocator.
+   */
    VulkanDevice createDevice(
       VkQueueFlags aQueues,
       const std::vector<const char*>& aExtensions = std::vector<const char*>(),
-      VkSurfaceKHR aSurface = VK_NULL_HANDLE
+      VkSurfaceKHR aSurface = VK_NULL_HANDLE,
+      const void* aFeatureChain = nullptr,
+      const QueueSelectionPolicy& aPolicy = QueueSelectionPolicy(),
+      const VkPhysicalDeviceFeatures* aEnabledFeatures = nullptr
    ) const;
 
    VulkanDevice createCoreDevice() const { return(createDevice(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT)); }
 
-   VulkanDevice createPresentableCoreDevice(VkSurfaceKHR aSurface, const std::vector<const char*>& aExtensions = std::vector<const char*>()) const {
+   VulkanDevice createPresentableCoreDevice(
+      VkSurfaceKHR aSurface, const std::vector<const char*>& aExtensions = std::vector<const char*>(),
+      const void* aFeatureChain = nullptr, const QueueSelectionPolicy& aPolicy = QueueSelectionPolicy(),
+      const VkPhysicalDeviceFeatures* aEnabledFeatures = nullptr
+   ) const {
       if(aSurface == VK_NULL_HANDLE) throw std::runtime_error("Attempted to create presentable core device with invalid surface handle!");
-      return(createDevice(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT, aExtensions, aSurface));
+      return(createDevice(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT, aExtensions, aSurface, aFeatureChain, aPolicy, aEnabledFeatures));
    }
 
    VkPhysicalDeviceProperties mProperites;
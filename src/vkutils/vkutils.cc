@@ -1,6 +1,6 @@
 #include "vkutils.h"
+#include "utils/MappedFile.h"
 #include <iostream>
-#include <fstream>
 #include <algorithm>
 #include <cassert>
 #include <iterator>
@@ -85,30 +85,37 @@ void find_layer_matches(
 }
 
 VkShaderModule load_shader_module(const VkDevice& aDevice, const std::string& aFilePath){
-    std::ifstream shaderFile(aFilePath, std::ios::in | std::ios::binary | std::ios::ate);
-    if(!shaderFile.is_open()){
+    // Map the file rather than reading it into a temporary buffer. The driver copies the code during module creation.
+    MappedFile shaderFile(aFilePath);
+    if(!shaderFile.isOpen()){
         perror(aFilePath.c_str());
         throw std::runtime_error("Failed to open shader file" + aFilePath + "!");
     }
-    size_t fileSize = static_cast<size_t>(shaderFile.tellg());
-    std::vector<uint8_t> byteCode(fileSize);
-    shaderFile.seekg(std::ios::beg);
-    shaderFile.read(reinterpret_cast<char*>(byteCode.data()), fileSize);
-    shaderFile.close();
+    if(shaderFile.size() == 0 || shaderFile.size() % sizeof(uint32_t) != 0){
+        throw std::runtime_error("Shader file '" + aFilePath + "' is empty or not a whole number of SPIR-V words!");
+    }
 
-    VkShaderModule resultModule = create_shader_module(aDevice, byteCode, true);
+    VkShaderModule resultModule = create_shader_module(aDevice, reinterpret_cast<const uint32_t*>(shaderFile.data()), shaderFile.size(), true);
     if(resultModule == VK_NULL_HANDLE){
         std::cerr << "Failed to create shader module from '" << aFilePath << "'!" << std::endl;
     }
     return(resultModule);
 }
 VkShaderModule create_shader_module(const VkDevice& aDevice, const std::vector<uint8_t>& aByteCode, bool silent){
+    return(create_shader_module(aDevice, reinterpret_cast<const uint32_t*>(aByteCode.data()), aByteCode.size(), silent));
+}
+VkShaderModule create_shader_module(const VkDevice& aDevice, const uint32_t* aCode, size_t aCodeSize, bool silent){
+    // A zero codeSize or one that isn't a multiple of 4 is invalid usage, so don't hand it to the driver
+    if(aCode == nullptr || aCodeSize == 0 || aCodeSize % sizeof(uint32_t) != 0){
+        std::cerr << "Failed to build shader from byte code: " << aCodeSize << " bytes is not valid SPIR-V!" << std::endl;
+        return(VK_NULL_HANDLE);
+    }
     VkShaderModuleCreateInfo createInfo;{
         createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
         createInfo.pNext = nullptr;
         createInfo.flags = 0;
-        createInfo.codeSize = aByteCode.size();
-        createInfo.pCode = reinterpret_cast<const uint32_t*>(aByteCode.data());
+        createInfo.codeSize = aCodeSize;
+        createInfo.pCode = aCode;
     }
 
     VkShaderModule resultModule = VK_NULL_HANDLE;
@@ -5,6 +5,8 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <type_traits>
+#include <stdexcept>
 #include "VulkanDevices.h"
 
 namespace vkutils{
@@ -30,12 +32,83 @@ std::vector<T> duplicate_extend_vector(const std::vector<T>& aVector, size_t ext
 
 VkShaderModule load_shader_module(const VkDevice& aDevice, const std::string& aFilePath);
 VkShaderModule create_shader_module(const VkDevice& aDevice, const std::vector<uint8_t>& aByteCode, bool silent = false);
+VkShaderModule create_shader_module(const VkDevice& aDevice, const uint32_t* aCode, size_t aCodeSize, bool silent = false);
+
+/// SPIR-V compiled and embedded into the executable at build time. See cmake/EmbedSpirv.cmake
+struct EmbeddedShader
+{
+    const char* name; // Shader source file name, e.g. "standard.vert"
+    const uint32_t* code;
+    size_t size; // Size of code in bytes
+};
+
+/// Find the embedded SPIR-V for a shader by its source file name. Returns nullptr if the shader was not embedded.
+const EmbeddedShader* find_embedded_shader(const std::string& aShaderName);
+
+/// Names of all shaders embedded into the executable.
+std::vector<std::string> list_embedded_shaders();
+
+/** Create a shader module from the embedded SPIR-V of the named shader, e.g. "standard.vert".
+ * No file I/O takes place unless the shader was not embedded, in which case the compiled
+ * shader is loaded from SHADER_DIR as a fallback. 
+*/
+VkShaderModule load_embedded_shader_module(const VkDevice& aDevice, const std::string& aShaderName);
+
+/** Typed container for the specialization constants of a single shader stage.
+ * Constants are packed into an internal byte buffer and described by a map entry per
+ * constant id, so the driver can fold them into the pipeline at creation time instead
+ * of reading equivalent values from a uniform buffer every invocation.
+ */
+class SpecializationConstants
+{
+ public:
+    SpecializationConstants(){}
+
+    /// Set the value of the constant with 'constant_id = aConstantId'. Setting an existing id replaces its value.
+    template<typename T>
+    SpecializationConstants& set(uint32_t aConstantId, const T& aValue);
+
+    /** Build constants from a plain (ideally constexpr) struct and map entries describing where each
+     * constant lives inside of it.
+     *
+     * Example:
+     *   struct LightingConsts { uint32_t lightCount; VkBool32 useFog; };
+     *   constexpr LightingConsts sLighting = {4, VK_TRUE};
+     *   auto consts = SpecializationConstants::fromStruct(sLighting, {
+     *       {0, offsetof(LightingConsts, lightCount), sizeof(uint32_t)},
+     *       {1, offsetof(LightingConsts, useFog), sizeof(VkBool32)}
+     *   });
+    */
+    template<typename StructT>
+    static SpecializationConstants fromStruct(const StructT& aStruct, const std::vector<VkSpecializationMapEntry>& aEntries);
+
+    bool empty() const {return(mEntries.empty());}
+    size_t size() const {return(mEntries.size());}
+
+    /// Returns a VkSpecializationInfo pointing into this object. It is only valid while this object is unmodified and alive.
+    VkSpecializationInfo getInfo() const;
+
+    /// Hash of the constant ids and values. Used to key pipeline variants.
+    size_t hash() const;
+
+    friend bool operator==(const SpecializationConstants& lhs, const SpecializationConstants& rhs);
+    friend bool operator!=(const SpecializationConstants& lhs, const SpecializationConstants& rhs) {return(!(lhs == rhs));}
+
+ protected:
+    void setBytes(uint32_t aConstantId, const uint8_t* aBytes, size_t aSize);
+
+    std::vector<VkSpecializationMapEntry> mEntries;
+    std::vector<uint8_t> mData;
+};
 
 struct VulkanSwapchainBundle
 {
-    VkSwapchainKHR swapchain;
+    VkSwapchainKHR swapchain = VK_NULL_HANDLE;
     VkSurfaceFormatKHR surface_format;
     VkPresentModeKHR presentation_mode;
+    /// Layout images are left in after rendering, ready for presentation or, when headless, for copying out
+    VkImageLayout final_layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    VkImageUsageFlags image_usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
     VkExtent2D extent = {0xFFFFFFFF, 0xFFFFFFFF};
     uint32_t requested_image_count = 0;
     uint32_t image_count = 0;
@@ -181,5 +254,26 @@ std::vector<T>& vkutils::duplicate_extend_vector(std::vector<T>& aVector, size_t
     return(aVector);
 }
 
+template<typename T>
+vkutils::SpecializationConstants& vkutils::SpecializationConstants::set(uint32_t aConstantId, const T& aValue){
+    static_assert(std::is_trivially_copyable<T>::value, "Specialization constants must be trivially copyable");
+    setBytes(aConstantId, reinterpret_cast<const uint8_t*>(&aValue), sizeof(T));
+    return(*this);
+}
+
+template<typename StructT>
+vkutils::SpecializationConstants vkutils::SpecializationConstants::fromStruct(const StructT& aStruct, const std::vector<VkSpecializationMapEntry>& aEntries){
+    static_assert(std::is_trivially_copyable<StructT>::value, "Specialization constant structs must be trivially copyable");
+    const uint8_t* structBytes = reinterpret_cast<const uint8_t*>(&aStruct);
+    SpecializationConstants result;
+    for(const VkSpecializationMapEntry& entry : aEntries){
+        if(entry.offset + entry.size > sizeof(StructT)){
+            throw std::runtime_error("Specialization map entry for constant " + std::to_string(entry.constantID) + " lies outside of the source struct!");
+        }
+        result.setBytes(entry.constantID, structBytes + entry.offset, entry.size);
+    }
+    return(result);
+}
+
 
 #endif
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "vkutils.h"
+#include "utils/common.h"
+#include <iostream>
+
+#ifdef VULKANBASE_EMBED_SHADERS
+// Generated at configure time. Includes a header per shader and defines 'sEmbeddedShaders', terminated by a null entry.
+#include "EmbeddedShaderRegistry.inl"
+#else
+static const vkutils::EmbeddedShader sEmbeddedShaders[] = {
+    {nullptr, nullptr, 0}
+};
+#endif
+
+namespace vkutils{
+
+const EmbeddedShader* find_embedded_shader(const std::string& aShaderName){
+    for(const EmbeddedShader* shader = sEmbeddedShaders; shader->name != nullptr; ++shader){
+        if(aShaderName == shader->name){
+            return(shader);
+        }
+    }
+    return(nullptr);
+}
+
+std::vector<std::string> list_embedded_shaders(){
+    std::vector<std::string> names;
+    for(const EmbeddedShader* shader = sEmbeddedShaders; shader->name != nullptr; ++shader){
+        names.emplace_back(shader->name);
+    }
+    return(names);
+}
+
+VkShaderModule load_embedded_shader_module(const VkDevice& aDevice, const std::string& aShaderName){
+    const EmbeddedShader* shader = find_embedded_shader(aShaderName);
+    if(shader == nullptr){
+        std::cerr << "Warning: Shader '" << aShaderName << "' is not embedded. Loading it from disk instead..." << std::endl;
+        return(load_shader_module(aDevice, STRIFY(SHADER_DIR) "/" + aShaderName + ".spv"));
+    }
+
+    VkShaderModule resultModule = create_shader_module(aDevice, shader->code, shader->size, true);
+    if(resultModule == VK_NULL_HANDLE){
+        std::cerr << "Failed to create shader module from embedded shader '" << aShaderName << "'!" << std::endl;
+    }
+    return(resultModule);
+}
+
+} // end namespace vkutils
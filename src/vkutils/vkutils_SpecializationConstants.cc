@@ -0,0 +1,78 @@
+#include "vkutils.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace vkutils
+{
+
+void SpecializationConstants::setBytes(uint32_t aConstantId, const uint8_t* aBytes, size_t aSize){
+    auto idMatch = [aConstantId](const VkSpecializationMapEntry& entry) -> bool {return(entry.constantID == aConstantId);};
+    std::vector<VkSpecializationMapEntry>::iterator existing = std::find_if(mEntries.begin(), mEntries.end(), idMatch);
+
+    if(existing != mEntries.end() && existing->size == aSize){
+        memcpy(mData.data() + existing->offset, aBytes, aSize);
+        return;
+    }else if(existing != mEntries.end()){
+        // Size changed. Drop the old entry and repack the remaining data so no stale bytes are left behind.
+        std::vector<VkSpecializationMapEntry> oldEntries;
+        oldEntries.swap(mEntries);
+        std::vector<uint8_t> oldData;
+        oldData.swap(mData);
+        for(const VkSpecializationMapEntry& entry : oldEntries){
+            if(entry.constantID != aConstantId){
+                setBytes(entry.constantID, oldData.data() + entry.offset, entry.size);
+            }
+        }
+    }
+
+    VkSpecializationMapEntry entry;
+    {
+        entry.constantID = aConstantId;
+        entry.offset = static_cast<uint32_t>(mData.size());
+        entry.size = aSize;
+    }
+    mData.insert(mData.end(), aBytes, aBytes + aSize);
+    mEntries.emplace_back(entry);
+}
+
+VkSpecializationInfo SpecializationConstants::getInfo() const{
+    VkSpecializationInfo info;
+    {
+        info.mapEntryCount = static_cast<uint32_t>(mEntries.size());
+        info.pMapEntries = mEntries.data();
+        info.dataSize = mData.size();
+        info.pData = mData.data();
+    }
+    return(info);
+}
+
+size_t SpecializationConstants::hash() const{
+    // Order independent of insertion so that two sets holding the same constants produce the same key.
+    std::vector<VkSpecializationMapEntry> sorted = mEntries;
+    auto idLess = [](const VkSpecializationMapEntry& lhs, const VkSpecializationMapEntry& rhs) -> bool {return(lhs.constantID < rhs.constantID);};
+    std::sort(sorted.begin(), sorted.end(), idLess);
+
+    size_t seed = sorted.size();
+    auto combine = [&seed](size_t aValue){ seed ^= aValue + 0x9e3779b9 + (seed << 6) + (seed >> 2); };
+    for(const VkSpecializationMapEntry& entry : sorted){
+        combine(std::hash<uint32_t>()(entry.constantID));
+        for(size_t i = 0; i < entry.size; ++i){
+            combine(std::hash<uint8_t>()(mData[entry.offset + i]));
+        }
+    }
+    return(seed);
+}
+
+bool operator==(const SpecializationConstants& lhs, const SpecializationConstants& rhs){
+    if(lhs.mEntries.size() != rhs.mEntries.size()) return(false);
+    for(const VkSpecializationMapEntry& lhsEntry : lhs.mEntries){
+        auto idMatch = [&lhsEntry](const VkSpecializationMapEntry& entry) -> bool {return(entry.constantID == lhsEntry.constantID);};
+        auto rhsEntry = std::find_if(rhs.mEntries.begin(), rhs.mEntries.end(), idMatch);
+        if(rhsEntry == rhs.mEntries.end() || rhsEntry->size != lhsEntry.size) return(false);
+        if(memcmp(lhs.mData.data() + lhsEntry.offset, rhs.mData.data() + rhsEntry->offset, lhsEntry.size) != 0) return(false);
+    }
+    return(true);
+}
+
+} // end namespace vkutils
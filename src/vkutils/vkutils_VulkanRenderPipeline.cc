@@ -198,7 +198,7 @@ void BasicVulkanRenderPipeline::prepareRenderPass(GraphicsPipelineConstructionSe
         aCtorSetInOut.mRenderpassCtorSet.mColorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         aCtorSetInOut.mRenderpassCtorSet.mColorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         aCtorSetInOut.mRenderpassCtorSet.mColorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        aCtorSetInOut.mRenderpassCtorSet.mColorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        aCtorSetInOut.mRenderpassCtorSet.mColorAttachment.finalLayout = aCtorSetInOut.mSwapchainBundle->final_layout;
     }
 
     {
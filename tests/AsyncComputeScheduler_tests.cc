@@ -0,0 +1,42 @@
+#include "catch.hpp"
+#include "vkutils/AsyncComputeScheduler.h"
+#include <stdexcept>
+
+TEST_CASE("AsyncComputeScheduler Tests"){
+    using vkutils::AsyncComputeScheduler;
+    auto noop = [](VkCommandBuffer, uint32_t){};
+
+    SECTION("Wait stages are the union of every pass's consumers"){
+        AsyncComputeScheduler scheduler;
+        REQUIRE(scheduler.getWaitStages() == 0);
+        scheduler.addPass("cull", noop, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+        scheduler.addPass("particles", noop, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+        REQUIRE(scheduler.getPassCount() == 2);
+        REQUIRE(scheduler.getWaitStages() == (VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT));
+    }
+
+    SECTION("Adding a pass with an existing name replaces it"){
+        AsyncComputeScheduler scheduler;
+        scheduler.addPass("post", noop, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
+        scheduler.addPass("post", noop, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        REQUIRE(scheduler.getPassCount() == 1);
+        REQUIRE(scheduler.getWaitStages() == VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+        scheduler.removePass("post");
+        REQUIRE_FALSE(scheduler.hasPass("post"));
+        REQUIRE(scheduler.getPassCount() == 0);
+    }
+
+    SECTION("Passes must name a record function and consumer stages"){
+        AsyncComputeScheduler scheduler;
+        REQUIRE_THROWS_AS(scheduler.addPass("empty", AsyncComputeScheduler::RecordFunction(), VK_PIPELINE_STAGE_VERTEX_SHADER_BIT), std::runtime_error);
+        REQUIRE_THROWS_AS(scheduler.addPass("nostage", noop, 0), std::runtime_error);
+    }
+
+    SECTION("Nothing is submitted without passes"){
+        AsyncComputeScheduler scheduler;
+        REQUIRE(scheduler.submit(0) == VK_NULL_HANDLE);
+        scheduler.addPass("cull", noop, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+        REQUIRE_THROWS_AS(scheduler.submit(0), std::runtime_error);
+    }
+}
@@ -0,0 +1,58 @@
+#include "catch.hpp"
+#include "utils/BenchmarkReport.h"
+#include "utils/TransferCounters.h"
+#include <string>
+
+TEST_CASE("BenchmarkReport Tests"){
+    SECTION("Strings are escaped for JSON"){
+        REQUIRE(json_string("plain") == "\"plain\"");
+        REQUIRE(json_string("a \"b\"\\c\n") == "\"a \\\"b\\\"\\\\c\\n\"");
+        REQUIRE(json_string(std::string(1, '\x01')) == "\"\\u0001\"");
+    }
+
+    SECTION("Summaries are written as JSON objects"){
+        SampleSummary summary = summarize_samples({1.0, 2.0, 3.0});
+        REQUIRE(summary.toJson(1) == "{\"count\": 3, \"min\": 1.0, \"mean\": 2.0, \"p50\": 2.0, \"p95\": 2.9, \"p99\": 3.0, \"max\": 3.0}");
+    }
+
+    SECTION("Metrics and properties keep their insertion order"){
+        BenchmarkReport report;
+        report.setProperty("device", "Test GPU");
+        report.setProperty("headless", true);
+        report.setProperty("width", 854.0);
+        report.setProperty("headless", false);
+
+        report.addSample("cpu_frame_ms", 2.0);
+        report.addSamples("gpu_latency_ms", {4.0, 6.0});
+        report.addSample("cpu_frame_ms", 4.0);
+
+        REQUIRE(report.getMetricNames() == std::vector<std::string>({"cpu_frame_ms", "gpu_latency_ms"}));
+        REQUIRE(report.summarize("cpu_frame_ms").count == 2);
+        REQUIRE(report.summarize("cpu_frame_ms").mean == Approx(3.0));
+        REQUIRE(report.summarize("missing").count == 0);
+
+        const std::string json = report.toJson();
+        REQUIRE(json.find("\"device\": \"Test GPU\"") != std::string::npos);
+        REQUIRE(json.find("\"headless\": false") != std::string::npos);
+        REQUIRE(json.find("\"headless\": true") == std::string::npos);
+        REQUIRE(json.find("\"width\": 854") != std::string::npos);
+        REQUIRE(json.find("\"cpu_frame_ms\"") < json.find("\"gpu_latency_ms\""));
+    }
+
+    SECTION("An empty report is still valid JSON"){
+        BenchmarkReport report;
+        REQUIRE(report.toJson() == "{\n  \"properties\": {},\n  \"metrics\": {}\n}\n");
+    }
+
+    SECTION("Transfer counters difference into per-frame costs"){
+        TransferCounters before = get_transfer_counters();
+        count_device_upload(256);
+        count_device_upload(64);
+        count_device_allocation(4096);
+        TransferCounters frame = get_transfer_counters() - before;
+        REQUIRE(frame.uploadBytes == 320);
+        REQUIRE(frame.uploadCount == 2);
+        REQUIRE(frame.allocationCount == 1);
+        REQUIRE(frame.allocationBytes == 4096);
+    }
+}
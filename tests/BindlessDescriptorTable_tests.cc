@@ -0,0 +1,40 @@
+#include "catch.hpp"
+#include "vkutils/BindlessDescriptorTable.h"
+#include <stdexcept>
+
+TEST_CASE("BindlessDescriptorTable Tests"){
+    using vkutils::SlotAllocator;
+
+    SECTION("Slots are handed out in order until full"){
+        SlotAllocator slots(3);
+        REQUIRE(slots.acquire() == 0);
+        REQUIRE(slots.acquire() == 1);
+        REQUIRE(slots.acquire() == 2);
+        REQUIRE(slots.acquire() == SlotAllocator::sInvalidSlot);
+        REQUIRE(slots.getUsedCount() == 3);
+    }
+
+    SECTION("Released slots are reused first"){
+        SlotAllocator slots(8);
+        slots.acquire(); slots.acquire(); slots.acquire();
+        slots.release(1);
+        REQUIRE(slots.getUsedCount() == 2);
+        REQUIRE(slots.acquire() == 1);
+        REQUIRE(slots.acquire() == 3);
+        REQUIRE(slots.getHighWater() == 4);
+    }
+
+    SECTION("Releasing a free slot throws"){
+        SlotAllocator slots(4);
+        uint32_t slot = slots.acquire();
+        slots.release(slot);
+        REQUIRE_THROWS_AS(slots.release(slot), std::runtime_error);
+        REQUIRE_THROWS_AS(slots.release(3), std::runtime_error);
+    }
+
+    SECTION("Writing to a table that was never created throws"){
+        vkutils::BindlessDescriptorTable table;
+        REQUIRE_FALSE(table.isValid());
+        REQUIRE_THROWS_AS(table.addStorageBuffer(VkDescriptorBufferInfo{}), std::runtime_error);
+    }
+}
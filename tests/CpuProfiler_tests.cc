@@ -0,0 +1,122 @@
+#include "catch.hpp"
+#include "utils/CpuProfiler.h"
+#include "utils/common.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+static std::string trace_json(){
+    std::ostringstream out;
+    CpuProfiler::get().writeChromeTrace(out);
+    return(out.str());
+}
+
+static size_t count_of(const std::string& aText, const std::string& aNeedle){
+    size_t count = 0;
+    for(size_t pos = aText.find(aNeedle); pos != std::string::npos; pos = aText.find(aNeedle, pos + 1)) ++count;
+    return(count);
+}
+
+TEST_CASE("CpuProfiler Tests"){
+    CpuProfiler& profiler = CpuProfiler::get();
+    profiler.clear();
+
+    SECTION("Nothing is recorded while disabled"){
+        profiler.setEnabled(false);
+        { CpuProfileZone zone("disabled_zone"); }
+        REQUIRE(count_of(trace_json(), "disabled_zone") == 0);
+    }
+
+    SECTION("Nested zones are written as matching begin and end events"){
+        profiler.setEnabled(true);
+        {
+            CpuProfileZone outer("outer_zone");
+            CpuProfileZone inner("inner_zone");
+        }
+        profiler.setEnabled(false);
+        const std::string json = trace_json();
+        REQUIRE(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") == 0);
+        REQUIRE(count_of(json, "\"ph\":\"B\"") == 2);
+        REQUIRE(count_of(json, "\"ph\":\"E\"") == 2);
+        // Inner ends before outer
+        REQUIRE(json.find("\"name\":\"outer_zone\",\"ph\":\"B\"") < json.find("\"name\":\"inner_zone\",\"ph\":\"B\""));
+        REQUIRE(json.find("\"name\":\"inner_zone\",\"ph\":\"E\"") < json.find("\"name\":\"outer_zone\",\"ph\":\"E\""));
+
+        profiler.clear();
+        REQUIRE(count_of(trace_json(), "outer_zone") == 0);
+    }
+
+    SECTION("A zone that began is ended even if the profiler is disabled meanwhile"){
+        profiler.setEnabled(true);
+        {
+            CpuProfileZone zone("disabled_meanwhile");
+            profiler.setEnabled(false);
+        }
+        profiler.setEnabled(true);
+        { CpuProfileZone zone("after_zone"); }
+        profiler.setEnabled(false);
+        const std::string json = trace_json();
+        REQUIRE(count_of(json, "\"name\":\"disabled_meanwhile\",\"ph\":\"E\"") == 1);
+        // Recorded when the zone closed, rather than added at export for a zone left open
+        REQUIRE(json.find("\"name\":\"disabled_meanwhile\",\"ph\":\"E\"") < json.find("\"name\":\"after_zone\",\"ph\":\"B\""));
+    }
+
+    SECTION("Zones still open are ended in the trace"){
+        profiler.setEnabled(true);
+        profiler.beginZone("open_zone");
+        const std::string json = trace_json();
+        profiler.endZone("open_zone");
+        profiler.setEnabled(false);
+        REQUIRE(count_of(json, "\"name\":\"open_zone\",\"ph\":\"B\"") == 1);
+        REQUIRE(count_of(json, "\"name\":\"open_zone\",\"ph\":\"E\"") == 1);
+    }
+
+    SECTION("Each thread gets its own ring, and a wrapped ring only exports whole zones"){
+        profiler.setEnabled(true);
+        profiler.setRingCapacity(5);
+        std::thread worker([](){
+            CpuProfiler::get().setThreadName("Worker \"1\"");
+            CpuProfiler::get().beginZone("worker_outer");
+            for(int i = 0; i < 10; ++i){
+                CpuProfileZone zone("worker_zone");
+            }
+            CpuProfiler::get().endZone("worker_outer");
+        });
+        worker.join();
+        profiler.setRingCapacity(1U << 16);
+        profiler.setEnabled(false);
+
+        const std::string json = trace_json();
+        REQUIRE(profiler.getOverwrittenCount() >= 17);
+        REQUIRE(count_of(json, "{\"name\":\"thread_name\",\"ph\":\"M\"") >= 1);
+        REQUIRE(json.find("\"args\":{\"name\":\"Worker \\\"1\\\"\"}") != std::string::npos);
+        // The outer begin was overwritten, so its end is dropped instead of being left unmatched
+        REQUIRE(count_of(json, "worker_outer") == 0);
+        REQUIRE(count_of(json, "\"name\":\"worker_zone\",\"ph\":\"B\"") == count_of(json, "\"name\":\"worker_zone\",\"ph\":\"E\""));
+        REQUIRE(count_of(json, "\"name\":\"worker_zone\",\"ph\":\"B\"") == 2);
+    }
+
+    SECTION("Frames over the spike threshold write a limited number of traces"){
+        const std::string prefix = std::string(STRIFY(TESTS_DIR)) + "cpu_trace_test_";
+        profiler.setEnabled(true);
+        profiler.setSpikeCapture(20.0, prefix, 1);
+        { CpuProfileZone zone("spike_zone"); }
+
+        REQUIRE_FALSE(profiler.frameFinished(10.0));
+        REQUIRE(profiler.frameFinished(30.0));
+        REQUIRE_FALSE(profiler.frameFinished(40.0));
+        REQUIRE(profiler.getSpikeCaptureCount() == 1);
+        profiler.waitForSpikeCapture();
+        profiler.setSpikeCapture(0.0, "");
+        profiler.setEnabled(false);
+
+        const std::string path = std::string(STRIFY(TESTS_DIR)) + "cpu_trace_test_0.json";
+        std::ifstream in(path);
+        std::stringstream contents;
+        contents << in.rdbuf();
+        REQUIRE(count_of(contents.str(), "spike_zone") == 2);
+        std::remove(path.c_str());
+    }
+}
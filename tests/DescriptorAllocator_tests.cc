@@ -0,0 +1,145 @@
+#include "catch.hpp"
+#include "vkutils/DescriptorAllocator.h"
+#include "VulkanSetupBaseApp.h"
+#include <cstdint>
+#include <stdexcept>
+
+TEST_CASE("DescriptorAllocator Tests"){
+    using vkutils::DescriptorBinding;
+    using vkutils::DescriptorSetCache;
+
+    const VkBuffer bufferA = (VkBuffer)(uintptr_t)(0x1000);
+    const VkBuffer bufferB = (VkBuffer)(uintptr_t)(0x2000);
+    const VkDescriptorSetLayout layout = (VkDescriptorSetLayout)(uintptr_t)(0x3000);
+
+    SECTION("Bindings compare by the resources they reference"){
+        DescriptorBinding first = DescriptorBinding::buffer(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, {bufferA, 0, 64});
+        DescriptorBinding same = DescriptorBinding::buffer(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, {bufferA, 0, 64});
+        DescriptorBinding otherBuffer = DescriptorBinding::buffer(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, {bufferB, 0, 64});
+        DescriptorBinding otherRange = DescriptorBinding::buffer(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, {bufferA, 64, 64});
+
+        REQUIRE(first == same);
+        REQUIRE(first != otherBuffer);
+        REQUIRE(first != otherRange);
+        REQUIRE_FALSE(first.isImage());
+    }
+
+    SECTION("Set keys hash by layout and bindings"){
+        std::vector<DescriptorBinding> bindings = {
+            DescriptorBinding::buffer(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, {bufferA, 0, 128}),
+            DescriptorBinding::buffer(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, {bufferA, 256, 4})
+        };
+        size_t key = DescriptorSetCache::hashKey(layout, bindings);
+        REQUIRE(key == DescriptorSetCache::hashKey(layout, bindings));
+        REQUIRE(key != DescriptorSetCache::hashKey((VkDescriptorSetLayout)(uintptr_t)(0x4000), bindings));
+
+        bindings[1].bufferInfo.buffer = bufferB;
+        REQUIRE(key != DescriptorSetCache::hashKey(layout, bindings));
+    }
+
+    SECTION("Fitting a layout raises the pool mix to its descriptor counts"){
+        using PoolRatios = vkutils::DescriptorAllocator::PoolRatios;
+        const std::vector<VkDescriptorSetLayoutBinding> bindings = {
+            {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 40, VK_SHADER_STAGE_VERTEX_BIT, nullptr},
+            {1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 10, VK_SHADER_STAGE_VERTEX_BIT, nullptr},
+            {2, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr}
+        };
+        const PoolRatios counts = vkutils::DescriptorAllocator::layout_counts(bindings);
+        REQUIRE(counts.size() == 2);
+        REQUIRE(counts[0].second == Approx(50.0));
+
+        vkutils::DescriptorAllocator allocator;
+        allocator.fitLayout(bindings);
+        auto ratioOf = [&allocator](VkDescriptorType aType) -> float {
+            for(const std::pair<VkDescriptorType, float>& ratio : allocator.getRatios()){
+                if(ratio.first == aType) return(ratio.second);
+            }
+            return(0.0f);
+        };
+        REQUIRE(ratioOf(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) == Approx(50.0));
+        REQUIRE(ratioOf(VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT) == Approx(1.0));
+        // Types the layout doesn't use keep their default share
+        REQUIRE(ratioOf(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER) == Approx(1.0));
+
+        // Fitting never shrinks the mix
+        allocator.fitLayout(PoolRatios{{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3.0f}});
+        REQUIRE(ratioOf(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) == Approx(50.0));
+    }
+
+    SECTION("Forgetting a layout the cache never saw does nothing"){
+        DescriptorSetCache cache;
+        cache.forgetLayout(layout);
+        REQUIRE(cache.size() == 0);
+        REQUIRE(cache.getPoolCount() == 0);
+    }
+
+    SECTION("Allocating without a device throws"){
+        vkutils::DescriptorAllocator allocator;
+        REQUIRE(allocator.getPoolCount() == 0);
+        REQUIRE_THROWS_AS(allocator.allocate(layout), std::runtime_error);
+    }
+}
+
+class DescriptorTestApp : public VulkanSetupBaseApp
+{
+ public:
+    using VulkanSetupBaseApp::mDeviceBundle;
+};
+
+TEST_CASE("DescriptorSetCache Device Tests"){
+    using vkutils::DescriptorBinding;
+    using vkutils::DescriptorSetCache;
+
+    DescriptorTestApp app;
+    app.init();
+    VkDevice device = app.mDeviceBundle.logicalDevice.handle();
+
+    SECTION("Forgetting a layout returns its pool memory"){
+        const VkDescriptorSetLayoutBinding layoutBinding = {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr};
+        VkDescriptorSetLayoutCreateInfo layoutInfo = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, nullptr, 0, 1, &layoutBinding};
+        VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+        REQUIRE(vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &layout) == VK_SUCCESS);
+
+        DescriptorSetCache cache(device);
+        const std::vector<DescriptorBinding> bindings = {
+            DescriptorBinding::buffer(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, {(VkBuffer)(uintptr_t)(0x1000), 0, 64})
+        };
+        // Sets are allocated but never bound, so the fake buffer is never read
+        size_t poolCount = 0;
+        for(int cycle = 0; cycle < 64; ++cycle){
+            std::vector<DescriptorBinding> cycleBindings = bindings;
+            cycleBindings[0].bufferInfo.offset = 64 * cycle;
+            cache.getOrCreate(layout, cycleBindings);
+            cache.getOrCreate(layout, bindings);
+            if(cycle == 0) poolCount = cache.getPoolCount();
+            REQUIRE(cache.size() == 2);
+            REQUIRE(cache.getPoolCount() == poolCount);
+            cache.forgetLayout(layout);
+            REQUIRE(cache.size() == 0);
+            REQUIRE(cache.getPoolCount() == 0);
+        }
+        cache.clear();
+        vkDestroyDescriptorSetLayout(device, layout, nullptr);
+    }
+}
+
+TEST_CASE("DescriptorUpdateTemplate Tests"){
+    using vkutils::DescriptorPayload;
+
+    SECTION("Entries are packed in binding order"){
+        const std::vector<VkDescriptorSetLayoutBinding> bindings = {
+            {3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+            {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr},
+            {1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr}
+        };
+        std::vector<VkDescriptorUpdateTemplateEntry> entries = vkutils::DescriptorUpdateTemplate::buildEntries(bindings);
+        REQUIRE(entries.size() == 3);
+        REQUIRE(entries[0].dstBinding == 0);
+        REQUIRE(entries[0].offset == 0);
+        REQUIRE(entries[1].offset == sizeof(DescriptorPayload));
+        REQUIRE(entries[2].dstBinding == 3);
+        REQUIRE(entries[2].descriptorCount == 4);
+        REQUIRE(entries[2].offset == 2 * sizeof(DescriptorPayload));
+        REQUIRE(entries[2].stride == sizeof(DescriptorPayload));
+    }
+}
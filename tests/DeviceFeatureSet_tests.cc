@@ -0,0 +1,95 @@
+#include "catch.hpp"
+#include "vkutils/DeviceFeatureSet.h"
+
+static size_t chain_length(const void* aChain){
+    size_t length = 0;
+    for(const VkBaseInStructure* node = static_cast<const VkBaseInStructure*>(aChain); node != nullptr; node = node->pNext){
+        ++length;
+    }
+    return(length);
+}
+
+TEST_CASE("DeviceFeatureSet Tests"){
+    using vkutils::DeviceFeatureSet;
+
+    SECTION("Intersection keeps only available features and counts the rest"){
+        DeviceFeatureSet requested(VK_API_VERSION_1_2);
+        requested.core().multiDrawIndirect = VK_TRUE;
+        requested.core().samplerAnisotropy = VK_TRUE;
+        requested.vulkan12().timelineSemaphore = VK_TRUE;
+        requested.vulkan13().synchronization2 = VK_TRUE;
+
+        DeviceFeatureSet available(VK_API_VERSION_1_2);
+        available.core().samplerAnisotropy = VK_TRUE;
+        available.core().geometryShader = VK_TRUE;
+        available.vulkan12().timelineSemaphore = VK_TRUE;
+
+        size_t dropped = 0;
+        DeviceFeatureSet enabled = DeviceFeatureSet::intersect(requested, available, &dropped);
+        REQUIRE(dropped == 2);
+        REQUIRE(enabled.count() == 2);
+        REQUIRE(enabled.core().samplerAnisotropy);
+        REQUIRE(enabled.vulkan12().timelineSemaphore);
+        REQUIRE_FALSE(enabled.core().multiDrawIndirect);
+        REQUIRE_FALSE(enabled.core().geometryShader);
+        REQUIRE_FALSE(enabled.vulkan13().synchronization2);
+    }
+
+    SECTION("Merge enables the union"){
+        DeviceFeatureSet a;
+        a.core().wideLines = VK_TRUE;
+        DeviceFeatureSet b;
+        b.core().largePoints = VK_TRUE;
+        b.vulkan11().multiview = VK_TRUE;
+        a.merge(b);
+        REQUIRE(a.count() == 3);
+    }
+
+    SECTION("Vulkan 1.2 chains the aggregate structs without extensions"){
+        DeviceFeatureSet features(VK_API_VERSION_1_2);
+        features.setExtensionSupport(true, true);
+        features.vulkan12().timelineSemaphore = VK_TRUE;
+        features.vulkan12().runtimeDescriptorArray = VK_TRUE;
+        REQUIRE(features.getRequiredExtensions().empty());
+        REQUIRE(chain_length(features.getChain()) == 3);
+
+        DeviceFeatureSet features13(VK_API_VERSION_1_3);
+        REQUIRE(chain_length(features13.getChain()) == 4);
+    }
+
+    SECTION("Vulkan 1.1 maps 1.2 features onto extension structs"){
+        DeviceFeatureSet features(VK_API_VERSION_1_1);
+        features.setExtensionSupport(true, true);
+        REQUIRE(features.getRequiredExtensions().empty());
+        REQUIRE(chain_length(features.getChain()) == 2);
+
+        features.vulkan12().timelineSemaphore = VK_TRUE;
+        features.vulkan12().descriptorBindingPartiallyBound = VK_TRUE;
+        REQUIRE(features.getRequiredExtensions().size() == 2);
+        REQUIRE(chain_length(features.getChain()) == 4);
+
+        // Extensions the device lacks are never chained or required
+        features.setExtensionSupport(false, true);
+        REQUIRE(features.getRequiredExtensions().size() == 1);
+        REQUIRE(chain_length(features.getChain()) == 3);
+    }
+
+    SECTION("Vulkan 1.0 passes core features outside the chain"){
+        DeviceFeatureSet features(VK_API_VERSION_1_0);
+        features.core().samplerAnisotropy = VK_TRUE;
+        REQUIRE(features.getChain() == nullptr);
+        REQUIRE(features.getEnabledFeatures() == &features.core());
+
+        DeviceFeatureSet features11(VK_API_VERSION_1_1);
+        REQUIRE(features11.getEnabledFeatures() == nullptr);
+        REQUIRE(static_cast<const VkBaseInStructure*>(features11.getChain())->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2);
+    }
+
+    SECTION("Copies own their chain"){
+        DeviceFeatureSet original(VK_API_VERSION_1_3);
+        original.getChain();
+        DeviceFeatureSet copy = original;
+        const VkBaseInStructure* head = static_cast<const VkBaseInStructure*>(copy.getChain());
+        REQUIRE(head->pNext == static_cast<const void*>(&copy.vulkan11()));
+    }
+}
@@ -0,0 +1,23 @@
+#include "catch.hpp"
+#include "vkutils/vkutils.h"
+
+TEST_CASE("Embedded Shader Tests"){
+
+    SECTION("Lookup of embedded SPIR-V"){
+        const vkutils::EmbeddedShader* shader = vkutils::find_embedded_shader("standard.vert");
+        if(vkutils::list_embedded_shaders().empty()){
+            REQUIRE(shader == nullptr);
+            return;
+        }
+
+        REQUIRE(shader != nullptr);
+        REQUIRE(shader->size > 0);
+        REQUIRE(shader->size % sizeof(uint32_t) == 0);
+        REQUIRE(shader->code[0] == 0x07230203); // SPIR-V magic number
+    }
+
+    SECTION("Unknown shaders are not found"){
+        REQUIRE(vkutils::find_embedded_shader("not_a_shader.frag") == nullptr);
+        REQUIRE(vkutils::find_embedded_shader("standard.vert.spv") == nullptr);
+    }
+}
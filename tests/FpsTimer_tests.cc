@@ -0,0 +1,92 @@
+#include "catch.hpp"
+#include "utils/FpsTimer.h"
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+TEST_CASE("LogHistogram Tests"){
+    SECTION("Small values get exact buckets"){
+        REQUIRE(LogHistogram::bucket_index(0) == 0);
+        REQUIRE(LogHistogram::bucket_index(31) == 31);
+        REQUIRE(LogHistogram::bucket_lower_bound(31) == 31);
+        REQUIRE(LogHistogram::bucket_upper_bound(31) == 32);
+    }
+
+    SECTION("Larger values fall in buckets within 6.25% of their value"){
+        const uint64_t values[] = {32, 33, 63, 64, 1000, 16667, 33333, 1000000, 123456789};
+        for(uint64_t value : values){
+            size_t bucket = LogHistogram::bucket_index(value);
+            REQUIRE(LogHistogram::bucket_lower_bound(bucket) <= value);
+            REQUIRE(LogHistogram::bucket_upper_bound(bucket) > value);
+            REQUIRE(LogHistogram::bucket_upper_bound(bucket) - LogHistogram::bucket_lower_bound(bucket) <= value / 16 + 1);
+        }
+        // Buckets are contiguous
+        for(size_t i = 0; i + 1 < LogHistogram::sBucketCount; ++i){
+            REQUIRE(LogHistogram::bucket_upper_bound(i) == LogHistogram::bucket_lower_bound(i + 1));
+        }
+    }
+
+    SECTION("Percentiles come from the bucket holding the ranked sample"){
+        LogHistogram histogram;
+        REQUIRE(histogram.getPercentile(50.0) == 0.0);
+        for(int i = 0; i < 99; ++i) histogram.record(10000);
+        histogram.record(100000);
+        REQUIRE(histogram.getTotalCount() == 100);
+        REQUIRE(histogram.getPercentile(50.0) == Approx(10000).epsilon(0.07));
+        REQUIRE(histogram.getPercentile(99.0) == Approx(10000).epsilon(0.07));
+        REQUIRE(histogram.getPercentile(100.0) == Approx(100000).epsilon(0.07));
+        histogram.clear();
+        REQUIRE(histogram.getTotalCount() == 0);
+    }
+}
+
+TEST_CASE("FpsTimer Tests"){
+    SECTION("Spikes show up in high percentiles and the hitch count"){
+        FpsTimer timer(0, 50.0);
+        for(int i = 0; i < 999; ++i) timer.addFrameTime(milliseconds(16));
+        timer.addFrameTime(milliseconds(100));
+
+        REQUIRE(timer.getFrameNumber() == 1000);
+        REQUIRE(timer.getPercentile(50.0) == Approx(16.0).epsilon(0.07));
+        REQUIRE(timer.getPercentile(99.0) == Approx(16.0).epsilon(0.07));
+        REQUIRE(timer.getPercentile(100.0) == Approx(100.0).epsilon(0.07));
+        REQUIRE(timer.getHitchCount() == 1);
+        REQUIRE(timer.getMinFrameTime() == Approx(16.0));
+        REQUIRE(timer.getMaxFrameTime() == Approx(100.0));
+        REQUIRE(timer.currentFrameTime() == Approx((999 * 16000.0 + 100000.0) / 1000.0));
+    }
+
+    SECTION("The ring keeps the most recent frames in order"){
+        FpsTimer timer(4);
+        for(int i = 1; i <= 6; ++i){
+            timer.addFrameTime(milliseconds(i));
+        }
+        REQUIRE(timer.isBufferFull());
+        REQUIRE(timer.getRecentFrameTimes() == std::vector<double>({3.0, 4.0, 5.0, 6.0}));
+
+        std::ostringstream csv;
+        timer.writeCsv(csv);
+        REQUIRE(csv.str() == "frame,frame_time_ms\n2,3\n3,4\n4,5\n5,6\n");
+
+        timer.reset();
+        REQUIRE(timer.getFrameNumber() == 0);
+        REQUIRE(timer.getRecentFrameTimes().empty());
+        REQUIRE(timer.getHitchCount() == 0);
+        REQUIRE(timer.getHistogram().getTotalCount() == 0);
+    }
+
+    SECTION("JSON export lists the statistics and non-empty buckets"){
+        FpsTimer timer(0, 20.0);
+        timer.addFrameTime(microseconds(10));
+        timer.addFrameTime(milliseconds(25));
+        const std::string json = timer.toJson();
+        REQUIRE(json.find("\"frames\": 2") != std::string::npos);
+        REQUIRE(json.find("\"hitches\": 1") != std::string::npos);
+        REQUIRE(json.find("[10, 11, 1]") != std::string::npos);
+        REQUIRE(json.find("\"p99_9_ms\"") != std::string::npos);
+    }
+}
@@ -0,0 +1,119 @@
+#include "catch.hpp"
+#include "vkutils/FrameCaptureSink.h"
+#include "utils/common.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static std::string read_file(const std::string& aPath){
+    std::string contents;
+    FILE* in = fopen(aPath.c_str(), "rb");
+    if(in == nullptr) return(contents);
+    char buffer[4096];
+    size_t count = 0;
+    while((count = fread(buffer, 1, sizeof(buffer), in)) > 0){
+        contents.append(buffer, count);
+    }
+    fclose(in);
+    return(contents);
+}
+
+static vkutils::ReadbackFrame make_frame(const std::vector<uint8_t>& aPixels, uint32_t aWidth, uint32_t aHeight, uint64_t aValue){
+    vkutils::ReadbackFrame frame;
+    frame.frameValue = aValue;
+    frame.extent = {aWidth, aHeight};
+    frame.format = VK_FORMAT_B8G8R8A8_UNORM;
+    frame.rowPitch = aWidth * 4;
+    frame.data = aPixels.data();
+    frame.size = aPixels.size();
+    return(frame);
+}
+
+TEST_CASE("FrameCaptureSink Tests"){
+    using vkutils::FrameCaptureSink;
+
+    // 2x1 frame: a red texel then a blue texel, stored as BGRA
+    const std::vector<uint8_t> pixels = {0, 0, 255, 255, 255, 0, 0, 255};
+
+    SECTION("Color conversion"){
+        uint8_t rgb[6];
+        REQUIRE(FrameCaptureSink::convert_to_rgb8(VK_FORMAT_B8G8R8A8_UNORM, pixels.data(), 2, rgb));
+        REQUIRE(rgb[0] == 255); REQUIRE(rgb[1] == 0); REQUIRE(rgb[2] == 0);
+        REQUIRE(rgb[3] == 0); REQUIRE(rgb[4] == 0); REQUIRE(rgb[5] == 255);
+
+        const uint32_t packed = (0x3FFu << 20) | 0x100u; // A2R10G10B10: full red, quarter blue
+        REQUIRE(FrameCaptureSink::convert_to_rgb8(VK_FORMAT_A2R10G10B10_UNORM_PACK32, reinterpret_cast<const uint8_t*>(&packed), 1, rgb));
+        REQUIRE(rgb[0] == 255); REQUIRE(rgb[1] == 0); REQUIRE(rgb[2] == 64);
+
+        REQUIRE_FALSE(FrameCaptureSink::convert_to_rgb8(VK_FORMAT_UNDEFINED, pixels.data(), 1, rgb));
+
+        const uint8_t grey[6] = {0, 0, 0, 255, 255, 255};
+        uint8_t y[2], u[2], v[2];
+        FrameCaptureSink::rgb8_to_yuv444(grey, 2, y, u, v);
+        REQUIRE(y[0] == 16); REQUIRE(y[1] == 235);
+        REQUIRE(u[0] == 128); REQUIRE(v[1] == 128);
+    }
+
+    SECTION("Y4M streams have one header and a frame marker per frame"){
+        const std::string path = std::string(STRIFY(TESTS_DIR)) + "capture_test.y4m";
+        vkutils::FrameCaptureConfig config;
+        config.path = path;
+        config.fps = 30;
+        config.overflow = vkutils::CAPTURE_OVERFLOW_BLOCK;
+
+        FrameCaptureSink sink;
+        sink.open(config);
+        for(uint64_t i = 1; i <= 3; ++i){
+            REQUIRE(sink.push(make_frame(pixels, 2, 1, i)));
+        }
+        // Frames of a different size don't fit the stream
+        REQUIRE_FALSE(sink.push(make_frame(std::vector<uint8_t>(16, 0), 4, 1, 4)));
+        sink.close();
+        REQUIRE(sink.getWrittenFrameCount() == 3);
+        REQUIRE(sink.getDroppedFrameCount() == 1);
+
+        const std::string header = "YUV4MPEG2 W2 H1 F30:1 Ip A1:1 C444\n";
+        const std::string contents = read_file(path);
+        REQUIRE(contents.size() == header.size() + 3 * (6 + 2 * 3));
+        REQUIRE(contents.compare(0, header.size(), header) == 0);
+        REQUIRE(contents.compare(header.size(), 6, "FRAME\n") == 0);
+        std::remove(path.c_str());
+    }
+
+    SECTION("PPM patterns write one numbered file per frame"){
+        const std::string pattern = std::string(STRIFY(TESTS_DIR)) + "capture_test_%02d.ppm";
+        vkutils::FrameCaptureConfig config;
+        config.format = vkutils::CAPTURE_FORMAT_PPM;
+        config.path = pattern;
+        config.overflow = vkutils::CAPTURE_OVERFLOW_BLOCK;
+
+        FrameCaptureSink sink;
+        sink.open(config);
+        REQUIRE(sink.push(make_frame(pixels, 2, 1, 1)));
+        REQUIRE(sink.push(make_frame(pixels, 2, 1, 2)));
+        sink.close();
+        REQUIRE(sink.getWrittenFrameCount() == 2);
+
+        for(int i = 0; i < 2; ++i){
+            const std::string path = std::string(STRIFY(TESTS_DIR)) + "capture_test_0" + std::to_string(i) + ".ppm";
+            const std::string contents = read_file(path);
+            REQUIRE(contents == std::string("P6\n2 1\n255\n") + std::string("\xFF\x00\x00\x00\x00\xFF", 6));
+            std::remove(path.c_str());
+        }
+    }
+
+    SECTION("Pushing to a closed sink drops the frame"){
+        FrameCaptureSink sink;
+        REQUIRE_FALSE(sink.isOpen());
+        REQUIRE_FALSE(sink.push(make_frame(pixels, 2, 1, 1)));
+        REQUIRE(sink.getDroppedFrameCount() == 1);
+    }
+
+    SECTION("Unwritable paths are rejected"){
+        vkutils::FrameCaptureConfig config;
+        config.path = std::string(STRIFY(TESTS_DIR)) + "missing_directory/capture.y4m";
+        FrameCaptureSink sink;
+        REQUIRE_THROWS(sink.open(config));
+        REQUIRE_FALSE(sink.isOpen());
+    }
+}
@@ -0,0 +1,66 @@
+#include "catch.hpp"
+#include "utils/FrameLatencyTracker.h"
+#include "utils/SampleSummary.h"
+#include "VulkanSetupBaseApp.h"
+
+TEST_CASE("SampleSummary Tests"){
+    SECTION("Empty input summarizes to zeros"){
+        SampleSummary summary = summarize_samples({});
+        REQUIRE(summary.count == 0);
+        REQUIRE(summary.max == 0.0);
+    }
+
+    SECTION("Percentiles interpolate between ranks"){
+        std::vector<double> samples;
+        for(int i = 100; i >= 0; --i) samples.push_back(i);
+        SampleSummary summary = summarize_samples(samples);
+        REQUIRE(summary.count == 101);
+        REQUIRE(summary.min == 0.0);
+        REQUIRE(summary.max == 100.0);
+        REQUIRE(summary.mean == Approx(50.0));
+        REQUIRE(summary.p50 == Approx(50.0));
+        REQUIRE(summary.p95 == Approx(95.0));
+        REQUIRE(summary.p99 == Approx(99.0));
+        REQUIRE(sorted_percentile({1.0, 2.0}, 50.0) == Approx(1.5));
+    }
+}
+
+TEST_CASE("FrameLatencyTracker Tests"){
+    using clock = FrameLatencyTracker::clock;
+    const clock::time_point start = clock::now();
+
+    SECTION("Completing a frame value completes every earlier frame"){
+        FrameLatencyTracker tracker;
+        tracker.frameStarted(1, start);
+        tracker.frameStarted(2, start + std::chrono::milliseconds(5));
+        tracker.frameStarted(3, start + std::chrono::milliseconds(10));
+
+        tracker.framesCompleted(2, start + std::chrono::milliseconds(20));
+        REQUIRE(tracker.getSamples() == std::vector<double>({20.0, 15.0}));
+
+        tracker.discardPending();
+        tracker.framesCompleted(3, start + std::chrono::milliseconds(30));
+        REQUIRE(tracker.getSampleCount() == 2);
+    }
+
+    SECTION("Only the most recent samples are kept, oldest first"){
+        FrameLatencyTracker tracker(2);
+        for(uint64_t frame = 1; frame <= 3; ++frame){
+            tracker.frameStarted(frame, start);
+            tracker.framesCompleted(frame, start + std::chrono::milliseconds(frame));
+        }
+        REQUIRE(tracker.getSamples() == std::vector<double>({2.0, 3.0}));
+    }
+}
+
+TEST_CASE("FramePacingConfig Tests"){
+    FramePacingConfig low = FramePacingConfig::fromLatencyMode(LATENCY_MODE_LOW);
+    FramePacingConfig balanced = FramePacingConfig::fromLatencyMode(LATENCY_MODE_BALANCED);
+    FramePacingConfig throughput = FramePacingConfig::fromLatencyMode(LATENCY_MODE_THROUGHPUT);
+
+    REQUIRE(low.framesInFlight < balanced.framesInFlight);
+    REQUIRE(balanced.framesInFlight < throughput.framesInFlight);
+    REQUIRE(low.extraSwapchainImages <= balanced.extraSwapchainImages);
+    REQUIRE(balanced.extraSwapchainImages <= throughput.extraSwapchainImages);
+    REQUIRE(balanced.framesInFlight == FramePacingConfig().framesInFlight);
+}
@@ -0,0 +1,39 @@
+#include "catch.hpp"
+#include "utils/FrameLimiter.h"
+
+TEST_CASE("FrameLimiter Tests"){
+    using clock = FrameLimiter::clock;
+
+    SECTION("Disabled limiter does not block"){
+        FrameLimiter limiter;
+        REQUIRE_FALSE(limiter.isEnabled());
+        limiter.wait();
+        limiter.wait();
+        REQUIRE(limiter.getPacingErrorSummary().count == 0);
+    }
+
+    SECTION("Frames are spaced by at least the target frame time"){
+        FrameLimiter limiter;
+        limiter.setTargetFrameTime(std::chrono::milliseconds(2));
+        REQUIRE(limiter.isEnabled());
+
+        const int frames = 20;
+        clock::time_point start = clock::now();
+        for(int i = 0; i <= frames; ++i){
+            limiter.wait();
+        }
+        clock::duration elapsed = clock::now() - start;
+        REQUIRE(elapsed >= frames * std::chrono::milliseconds(2));
+
+        SampleSummary errors = limiter.getPacingErrorSummary();
+        REQUIRE(errors.count == frames);
+        REQUIRE(errors.min >= 0.0);
+    }
+
+    SECTION("Target fps converts to frame time"){
+        FrameLimiter limiter(50.0);
+        REQUIRE(limiter.getTargetFrameTime() == std::chrono::milliseconds(20));
+        limiter.setTargetFps(0.0);
+        REQUIRE_FALSE(limiter.isEnabled());
+    }
+}
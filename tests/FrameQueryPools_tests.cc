@@ -0,0 +1,37 @@
+#include "catch.hpp"
+#include "vkutils/FrameQueryPools.h"
+
+TEST_CASE("FrameQueryPools Tests"){
+    using vkutils::FrameQueryPools;
+
+    SECTION("Entries are registered once by name"){
+        FrameQueryPools queries;
+        REQUIRE(queries.findEntry("frame") == -1);
+        REQUIRE(queries.getEntry("frame") == 0);
+        REQUIRE(queries.getEntry("scene") == 1);
+        REQUIRE(queries.getEntry("frame") == 0);
+        REQUIRE(queries.findEntry("scene") == 1);
+        REQUIRE(queries.getEntryNames() == std::vector<std::string>({"frame", "scene"}));
+    }
+
+    SECTION("Creation needs slots and room for the registered entries"){
+        VkQueryPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = 2;
+
+        FrameQueryPools queries;
+        REQUIRE_THROWS(queries.create(VK_NULL_HANDLE, poolInfo, 0, 1));
+        REQUIRE_THROWS(queries.create(VK_NULL_HANDLE, poolInfo, 2, 0));
+        queries.getEntry("frame");
+        queries.getEntry("scene");
+        REQUIRE_THROWS(queries.create(VK_NULL_HANDLE, poolInfo, 2, 1));
+        REQUIRE_FALSE(queries.isValid());
+    }
+
+    SECTION("Nothing is finished or readable without pools"){
+        FrameQueryPools queries;
+        REQUIRE(queries.takeFinishedSlots(10).empty());
+        REQUIRE(queries.readSlot(0, 0, 1) == nullptr);
+    }
+}
@@ -0,0 +1,37 @@
+#include "catch.hpp"
+#include "vkutils/FrameReadback.h"
+
+TEST_CASE("FrameReadback Tests"){
+    using vkutils::FrameReadback;
+
+    SECTION("Texel sizes cover the common color formats"){
+        REQUIRE(FrameReadback::texel_size(VK_FORMAT_B8G8R8A8_UNORM) == 4);
+        REQUIRE(FrameReadback::texel_size(VK_FORMAT_R8G8B8A8_SRGB) == 4);
+        REQUIRE(FrameReadback::texel_size(VK_FORMAT_A2B10G10R10_UNORM_PACK32) == 4);
+        REQUIRE(FrameReadback::texel_size(VK_FORMAT_R16G16B16A16_SFLOAT) == 8);
+        REQUIRE(FrameReadback::texel_size(VK_FORMAT_R32G32B32A32_SFLOAT) == 16);
+        REQUIRE(FrameReadback::texel_size(VK_FORMAT_UNDEFINED) == 0);
+    }
+
+    SECTION("An uncreated readback drops nothing and records nothing"){
+        FrameReadback readback;
+        REQUIRE_FALSE(readback.isValid());
+        REQUIRE(readback.recordCopy(VK_NULL_HANDLE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 1) == VK_NULL_HANDLE);
+        readback.cancelCopy(VK_NULL_HANDLE);
+        readback.collect(1);
+        readback.waitIdle();
+        REQUIRE(readback.getDeliveredFrameCount() == 0);
+        REQUIRE(readback.getDroppedFrameCount() == 0);
+        readback.destroy();
+        REQUIRE(readback.getSlotCount() == 0);
+    }
+
+    SECTION("Unsupported formats and empty rings are rejected"){
+        FrameReadback readback;
+        VulkanDeviceBundle bundle;
+        REQUIRE_THROWS(readback.create(bundle, 0, {64, 64}, VK_FORMAT_UNDEFINED, 2));
+        REQUIRE_THROWS(readback.create(bundle, 0, {64, 64}, VK_FORMAT_B8G8R8A8_UNORM, 0));
+        REQUIRE_THROWS(readback.create(bundle, 0, {0, 64}, VK_FORMAT_B8G8R8A8_UNORM, 2));
+        REQUIRE_FALSE(readback.isValid());
+    }
+}
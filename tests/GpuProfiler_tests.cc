@@ -0,0 +1,52 @@
+#include "catch.hpp"
+#include "vkutils/GpuProfiler.h"
+
+static VulkanDeviceBundle make_bundle(uint32_t aTimestampBits, float aTimestampPeriod){
+    VulkanDeviceBundle bundle;
+    VkQueueFamilyProperties props = {};
+    props.queueFlags = VK_QUEUE_GRAPHICS_BIT;
+    props.queueCount = 1;
+    props.timestampValidBits = aTimestampBits;
+    bundle.physicalDevice.mQueueFamilies.emplace_back(props, 0);
+    bundle.physicalDevice.mProperites = {};
+    bundle.physicalDevice.mProperites.limits.timestampPeriod = aTimestampPeriod;
+    return(bundle);
+}
+
+TEST_CASE("GpuProfiler Tests"){
+    using vkutils::GpuProfiler;
+
+    SECTION("Ticks convert to milliseconds through the timestamp period"){
+        REQUIRE(GpuProfiler::ticks_to_ms(1000, 2001000, 64, 1.0f) == Approx(2.0));
+        REQUIRE(GpuProfiler::ticks_to_ms(0, 1000000, 64, 0.5f) == Approx(0.5));
+        // A 32-bit counter wrapping between the two timestamps
+        REQUIRE(GpuProfiler::ticks_to_ms(0xFFFFFF00u, 0x00000100u, 32, 1.0f) == Approx(0x200 / 1e6));
+    }
+
+    SECTION("Support requires timestamp bits and a timestamp period"){
+        REQUIRE(GpuProfiler::is_supported(make_bundle(64, 1.0f), 0));
+        REQUIRE_FALSE(GpuProfiler::is_supported(make_bundle(0, 1.0f), 0));
+        REQUIRE_FALSE(GpuProfiler::is_supported(make_bundle(64, 0.0f), 0));
+        REQUIRE_FALSE(GpuProfiler::is_supported(make_bundle(64, 1.0f), 1));
+    }
+
+    SECTION("Scopes are registered once by name"){
+        GpuProfiler profiler;
+        REQUIRE(profiler.getScope("frame") == 0);
+        REQUIRE(profiler.getScope("render_pass") == 1);
+        REQUIRE(profiler.getScope("frame") == 0);
+        REQUIRE(profiler.getScopeNames() == std::vector<std::string>({"frame", "render_pass"}));
+        REQUIRE(profiler.getSamples("frame").empty());
+        REQUIRE(profiler.getSamples("missing").empty());
+        REQUIRE(profiler.summarize("frame").count == 0);
+    }
+
+    SECTION("Creation fails without timestamp support and collecting without pools does nothing"){
+        GpuProfiler profiler;
+        REQUIRE_THROWS(profiler.create(make_bundle(0, 1.0f), 0, 2));
+        REQUIRE_THROWS(profiler.create(make_bundle(64, 1.0f), 0, 0));
+        REQUIRE_FALSE(profiler.isValid());
+        profiler.collect(10);
+        REQUIRE(profiler.getLastFrameTimes().empty());
+    }
+}
@@ -0,0 +1,40 @@
+#include "catch.hpp"
+#include "utils/MappedFile.h"
+#include "utils/common.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+TEST_CASE("MappedFile Tests"){
+    const std::string path = std::string(STRIFY(TESTS_DIR)) + "mapped_file_test.bin";
+    const char contents[] = "SPIR-V stand-in contents";
+
+    FILE* out = fopen(path.c_str(), "wb");
+    REQUIRE(out != nullptr);
+    fwrite(contents, 1, sizeof(contents), out);
+    fclose(out);
+
+    SECTION("Mapping an existing file"){
+        MappedFile file(path);
+        REQUIRE(file.isOpen());
+        REQUIRE(file.size() == sizeof(contents));
+        REQUIRE(memcmp(file.data(), contents, sizeof(contents)) == 0);
+
+        MappedFile moved(std::move(file));
+        REQUIRE_FALSE(file.isOpen());
+        REQUIRE(moved.isOpen());
+        REQUIRE(memcmp(moved.data(), contents, sizeof(contents)) == 0);
+
+        moved.close();
+        REQUIRE_FALSE(moved.isOpen());
+        REQUIRE(moved.data() == nullptr);
+    }
+
+    SECTION("Mapping a missing file fails"){
+        MappedFile file;
+        REQUIRE_FALSE(file.open(path + ".missing"));
+        REQUIRE_FALSE(file.isOpen());
+    }
+
+    remove(path.c_str());
+}
@@ -0,0 +1,46 @@
+#include "catch.hpp"
+#include "vkutils/PipelineStatistics.h"
+
+TEST_CASE("PipelineStatistics Tests"){
+    using namespace vkutils;
+
+    SECTION("Counters derive vertex reuse and overdraw"){
+        PipelineCounters counters;
+        REQUIRE(counters.verticesPerPrimitive() == Approx(0.0));
+        REQUIRE(counters.fragmentsPerPixel(100) == Approx(0.0));
+
+        counters.values = {{200, 150, 180, 250}};
+        REQUIRE(counters[PIPELINE_COUNTER_INPUT_ASSEMBLY_PRIMITIVES] == 200);
+        REQUIRE(counters[PIPELINE_COUNTER_FRAGMENT_SHADER_INVOCATIONS] == 250);
+        REQUIRE(counters.verticesPerPrimitive() == Approx(0.75));
+        REQUIRE(counters.fragmentsPerPixel(100) == Approx(2.5));
+        REQUIRE(counters.fragmentsPerPixel(0) == Approx(0.0));
+    }
+
+    SECTION("Statistic flags cover one bit per counter"){
+        VkQueryPipelineStatisticFlags flags = PipelineStatistics::sStatisticFlags;
+        int bits = 0;
+        for(; flags != 0; flags &= flags - 1) ++bits;
+        REQUIRE(bits == PIPELINE_COUNTER_COUNT);
+        REQUIRE(std::string(PipelineStatistics::counter_name(PIPELINE_COUNTER_VERTEX_SHADER_INVOCATIONS)) == "vs_invocations");
+    }
+
+    SECTION("Batches are registered once by name"){
+        PipelineStatistics statistics;
+        REQUIRE(statistics.getBatch("scene") == 0);
+        REQUIRE(statistics.getBatch("overlay") == 1);
+        REQUIRE(statistics.getBatch("scene") == 0);
+        REQUIRE(statistics.getBatchNames() == std::vector<std::string>({"scene", "overlay"}));
+        REQUIRE(statistics.getSamples("scene", PIPELINE_COUNTER_FRAGMENT_SHADER_INVOCATIONS).empty());
+        REQUIRE(statistics.getSamples("missing", PIPELINE_COUNTER_FRAGMENT_SHADER_INVOCATIONS).empty());
+        REQUIRE(statistics.summarize("scene", PIPELINE_COUNTER_CLIPPING_PRIMITIVES).count == 0);
+    }
+
+    SECTION("Creation needs slots and collecting without pools does nothing"){
+        PipelineStatistics statistics;
+        REQUIRE_THROWS(statistics.create(VulkanDeviceBundle(), 0));
+        REQUIRE_FALSE(statistics.isValid());
+        statistics.collect(10);
+        REQUIRE(statistics.getLastFrameCounters().empty());
+    }
+}
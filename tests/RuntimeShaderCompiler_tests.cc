@@ -0,0 +1,82 @@
+#include "catch.hpp"
+#include "vkutils/RuntimeShaderCompiler.h"
+#include "utils/common.h"
+#include <cstdio>
+#include <string>
+
+static void write_test_file(const std::string& aPath, const std::string& aContents){
+    FILE* out = fopen(aPath.c_str(), "wb");
+    REQUIRE(out != nullptr);
+    fwrite(aContents.data(), 1, aContents.size(), out);
+    fclose(out);
+}
+
+TEST_CASE("RuntimeShaderCompiler Tests"){
+    using vkutils::RuntimeShaderCompiler;
+
+    const std::string testsDir = STRIFY(TESTS_DIR);
+    const std::string includePath = testsDir + "runtime_compiler_test.glinl";
+    const std::string sourceName = testsDir + "runtime_compiler_test.frag";
+    const std::string source =
+        "#version 450 core\n"
+        "#include \"runtime_compiler_test.glinl\"\n"
+        "layout(location = 0) out vec4 fragColor;\n"
+        "void main(){ fragColor = vec4(SHADE); }\n";
+
+    write_test_file(includePath, "#define SHADE 0.5\n");
+
+    // Empty cache directory disables the disk cache so tests leave nothing behind
+    RuntimeShaderCompiler compiler(testsDir, "");
+
+    SECTION("Includes are found and feed the cache key"){
+        std::vector<std::string> includes = compiler.findIncludes(source, sourceName);
+        REQUIRE(includes.size() == 1);
+
+        uint64_t before = compiler.computeKey(source, sourceName, VK_SHADER_STAGE_FRAGMENT_BIT, {});
+        REQUIRE(before == compiler.computeKey(source, sourceName, VK_SHADER_STAGE_FRAGMENT_BIT, {}));
+
+        write_test_file(includePath, "#define SHADE 0.75\n");
+        REQUIRE(before != compiler.computeKey(source, sourceName, VK_SHADER_STAGE_FRAGMENT_BIT, {}));
+    }
+
+    SECTION("Defines select distinct variants regardless of order"){
+        RuntimeShaderCompiler::DefineList defines = {{"USE_FOG", "1"}, {"LIGHT_COUNT", "4"}};
+        RuntimeShaderCompiler::DefineList reordered = {{"LIGHT_COUNT", "4"}, {"USE_FOG", "1"}};
+        RuntimeShaderCompiler::DefineList changed = {{"LIGHT_COUNT", "8"}, {"USE_FOG", "1"}};
+
+        uint64_t key = compiler.computeKey(source, sourceName, VK_SHADER_STAGE_FRAGMENT_BIT, defines);
+        REQUIRE(key == compiler.computeKey(source, sourceName, VK_SHADER_STAGE_FRAGMENT_BIT, reordered));
+        REQUIRE(key != compiler.computeKey(source, sourceName, VK_SHADER_STAGE_FRAGMENT_BIT, changed));
+        REQUIRE(key != compiler.computeKey(source, sourceName, VK_SHADER_STAGE_FRAGMENT_BIT, {}));
+        REQUIRE(key != compiler.computeKey(source, sourceName, VK_SHADER_STAGE_VERTEX_BIT, defines));
+    }
+
+    SECTION("Stage inference from file names"){
+        REQUIRE(RuntimeShaderCompiler::stageFromFileName("standard.vert") == VK_SHADER_STAGE_VERTEX_BIT);
+        REQUIRE(RuntimeShaderCompiler::stageFromFileName("shaders/fallback.frag") == VK_SHADER_STAGE_FRAGMENT_BIT);
+        REQUIRE_THROWS(RuntimeShaderCompiler::stageFromFileName("common.glinl"));
+    }
+
+    SECTION("Repeated compiles are served from the cache"){
+        if(!RuntimeShaderCompiler::isAvailable()){
+            REQUIRE_THROWS(compiler.compileSource(source, sourceName, VK_SHADER_STAGE_FRAGMENT_BIT));
+        }else{
+            std::vector<uint32_t> first = compiler.compileSource(source, sourceName, VK_SHADER_STAGE_FRAGMENT_BIT);
+            std::vector<uint32_t> second = compiler.compileSource(source, sourceName, VK_SHADER_STAGE_FRAGMENT_BIT);
+            REQUIRE(!first.empty());
+            REQUIRE(first[0] == 0x07230203);
+            REQUIRE(first == second);
+            REQUIRE(compiler.getStats().compiles == 1);
+            REQUIRE(compiler.getStats().memoryHits == 1);
+
+            // Memory hits only check the include's timestamp and size, so an edit must still be seen
+            write_test_file(includePath, "#define SHADE 0.25\n");
+            compiler.compileSource(source, sourceName, VK_SHADER_STAGE_FRAGMENT_BIT);
+            REQUIRE(compiler.getStats().compiles == 2);
+            compiler.compileSource(source, sourceName, VK_SHADER_STAGE_FRAGMENT_BIT);
+            REQUIRE(compiler.getStats().memoryHits == 2);
+        }
+    }
+
+    remove(includePath.c_str());
+}
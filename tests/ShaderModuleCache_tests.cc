@@ -0,0 +1,54 @@
+#include "catch.hpp"
+#include "vkutils/ShaderModuleCache.h"
+#include "utils/common.h"
+#include <cstdio>
+#include <cstdint>
+#include <string>
+
+TEST_CASE("ShaderModuleCache Tests"){
+    using vkutils::ShaderModuleCache;
+
+    SECTION("Contents hash is 64-bit FNV-1a"){
+        const uint8_t a[] = {'a'};
+        const uint8_t foobar[] = {'f', 'o', 'o', 'b', 'a', 'r'};
+        REQUIRE(ShaderModuleCache::hashContents(nullptr, 0) == 14695981039346656037ULL);
+        REQUIRE(ShaderModuleCache::hashContents(a, sizeof(a)) == 0xaf63dc4c8601ec8cULL);
+        REQUIRE(ShaderModuleCache::hashContents(foobar, sizeof(foobar)) == 0x85944171f73967e8ULL);
+    }
+
+    SECTION("Keys depend on contents only"){
+        const uint32_t first[] = {0x07230203, 0x00010000, 1, 2};
+        const uint32_t copy[] = {0x07230203, 0x00010000, 1, 2};
+        const uint32_t other[] = {0x07230203, 0x00010000, 1, 3};
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(first);
+        REQUIRE(ShaderModuleCache::hashContents(bytes, sizeof(first)) == ShaderModuleCache::hashContents(reinterpret_cast<const uint8_t*>(copy), sizeof(copy)));
+        REQUIRE(ShaderModuleCache::hashContents(bytes, sizeof(first)) != ShaderModuleCache::hashContents(reinterpret_cast<const uint8_t*>(other), sizeof(other)));
+        REQUIRE(ShaderModuleCache::hashContents(bytes, sizeof(first)) != ShaderModuleCache::hashContents(bytes, sizeof(first) - 4));
+    }
+
+    SECTION("Acquiring without a device throws"){
+        ShaderModuleCache cache;
+        const uint32_t code[] = {0x07230203};
+        REQUIRE_THROWS(cache.acquireFromMemory(code, sizeof(code)));
+    }
+
+    SECTION("Empty and partial word SPIR-V is rejected before reaching the driver"){
+        // Never dereferenced, since invalid code is rejected first
+        ShaderModuleCache cache(reinterpret_cast<VkDevice>(uintptr_t(0x1000)));
+        const uint32_t code[] = {0x07230203, 0x00010000};
+        REQUIRE(cache.acquireFromMemory(nullptr, 0) == VK_NULL_HANDLE);
+        REQUIRE(cache.acquireFromMemory(code, 0) == VK_NULL_HANDLE);
+        REQUIRE(cache.acquireFromMemory(code, 6) == VK_NULL_HANDLE);
+
+        const std::string path = std::string(STRIFY(TESTS_DIR)) + "empty_shader_test.spv";
+        FILE* out = fopen(path.c_str(), "wb");
+        REQUIRE(out != nullptr);
+        fclose(out);
+        REQUIRE(cache.acquireFromFile(path) == VK_NULL_HANDLE);
+        remove(path.c_str());
+
+        REQUIRE(cache.size() == 0);
+        REQUIRE(cache.getStats().modulesCreated == 0);
+        REQUIRE(cache.getStats().cacheHits == 0);
+    }
+}
@@ -0,0 +1,64 @@
+#include "catch.hpp"
+#include "vkutils/vkutils.h"
+#include <cstddef>
+#include <cstring>
+
+struct LightingConstants {
+    uint32_t lightCount;
+    VkBool32 useFog;
+    float fogDensity;
+};
+
+TEST_CASE("SpecializationConstants Tests"){
+    using vkutils::SpecializationConstants;
+
+    SECTION("Packing individual constants"){
+        SpecializationConstants consts;
+        REQUIRE(consts.empty());
+
+        consts.set<uint32_t>(0, 4U).set<float>(3, 0.5f);
+        REQUIRE(consts.size() == 2);
+
+        VkSpecializationInfo info = consts.getInfo();
+        REQUIRE(info.mapEntryCount == 2);
+        REQUIRE(info.dataSize == sizeof(uint32_t) + sizeof(float));
+        REQUIRE(info.pMapEntries[1].constantID == 3);
+        REQUIRE(info.pMapEntries[1].offset == sizeof(uint32_t));
+
+        float packedFloat = 0.0f;
+        memcpy(&packedFloat, reinterpret_cast<const uint8_t*>(info.pData) + info.pMapEntries[1].offset, sizeof(float));
+        REQUIRE(packedFloat == 0.5f);
+    }
+
+    SECTION("Replacing a constant with a different size repacks the data"){
+        SpecializationConstants consts;
+        consts.set<uint32_t>(0, 1U).set<uint32_t>(1, 2U);
+        consts.set<uint64_t>(0, 7ULL);
+
+        VkSpecializationInfo info = consts.getInfo();
+        REQUIRE(info.mapEntryCount == 2);
+        REQUIRE(info.dataSize == sizeof(uint32_t) + sizeof(uint64_t));
+    }
+
+    SECTION("Building from a struct and variant keys"){
+        constexpr LightingConstants sLighting = {4, VK_TRUE, 0.25f};
+        const std::vector<VkSpecializationMapEntry> entries = {
+            {0, offsetof(LightingConstants, lightCount), sizeof(uint32_t)},
+            {1, offsetof(LightingConstants, useFog), sizeof(VkBool32)},
+            {2, offsetof(LightingConstants, fogDensity), sizeof(float)}
+        };
+        SpecializationConstants fromStruct = SpecializationConstants::fromStruct(sLighting, entries);
+
+        SpecializationConstants manual;
+        manual.set<float>(2, 0.25f).set<VkBool32>(1, VK_TRUE).set<uint32_t>(0, 4U);
+
+        REQUIRE(fromStruct == manual);
+        REQUIRE(fromStruct.hash() == manual.hash());
+
+        manual.set<uint32_t>(0, 8U);
+        REQUIRE(fromStruct != manual);
+        REQUIRE(fromStruct.hash() != manual.hash());
+
+        REQUIRE_THROWS(SpecializationConstants::fromStruct(sLighting, {{0, sizeof(LightingConstants), sizeof(uint32_t)}}));
+    }
+}
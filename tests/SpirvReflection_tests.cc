@@ -0,0 +1,243 @@
+#include "catch.hpp"
+#include "vkutils/SpirvReflection.h"
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+
+static void sEmit(std::vector<uint32_t>& aCode, uint32_t aOpcode, std::initializer_list<uint32_t> aOperands){
+    aCode.push_back(static_cast<uint32_t>(aOperands.size() + 1) << 16 | aOpcode);
+    aCode.insert(aCode.end(), aOperands.begin(), aOperands.end());
+}
+
+static void sEmitNamed(std::vector<uint32_t>& aCode, uint32_t aOpcode, std::initializer_list<uint32_t> aOperands, const char* aString){
+    size_t stringWords = strlen(aString) / sizeof(uint32_t) + 1;
+    std::vector<uint32_t> stringData(stringWords, 0U);
+    memcpy(stringData.data(), aString, strlen(aString));
+
+    aCode.push_back(static_cast<uint32_t>(aOperands.size() + stringWords + 1) << 16 | aOpcode);
+    aCode.insert(aCode.end(), aOperands.begin(), aOperands.end());
+    aCode.insert(aCode.end(), stringData.begin(), stringData.end());
+}
+
+/** Hand assembled equivalent of:
+ *   layout(binding = 1) uniform Block { mat4 m; float f; } uBlock;
+ *   layout(push_constant) uniform Push { vec4 tint; } uPush;
+ *   layout(set = 1, binding = 2) uniform sampler2D uTextures[4];
+ *   layout(location = 0) in vec4 inPos;
+ *   layout(location = 1) in vec2 inUV;
+*/
+static std::vector<uint32_t> sBuildModule(uint32_t aExecutionModel){
+    std::vector<uint32_t> code = {0x07230203, 0x00010000, 0, 24, 0};
+    sEmitNamed(code, 15, {aExecutionModel, 1}, "main");
+    sEmitNamed(code, 5, {7}, "uBlock");
+    sEmitNamed(code, 5, {12}, "inUV");
+    sEmit(code, 71, {5, 2});           // Block
+    sEmit(code, 72, {5, 0, 35, 0});    // Offset
+    sEmit(code, 72, {5, 1, 35, 64});
+    sEmit(code, 72, {5, 0, 7, 16});    // MatrixStride
+    sEmit(code, 71, {7, 33, 1});       // Binding
+    sEmit(code, 71, {7, 34, 0});       // DescriptorSet
+    sEmit(code, 71, {11, 30, 0});      // Location
+    sEmit(code, 71, {12, 30, 1});
+    sEmit(code, 71, {13, 2});
+    sEmit(code, 72, {13, 0, 35, 0});
+    sEmit(code, 71, {22, 34, 1});
+    sEmit(code, 71, {22, 33, 2});
+    sEmit(code, 71, {23, 11, 42});     // BuiltIn VertexIndex
+
+    sEmit(code, 22, {2, 32});          // float
+    sEmit(code, 23, {3, 2, 4});        // vec4
+    sEmit(code, 24, {4, 3, 4});        // mat4
+    sEmit(code, 30, {5, 4, 2});        // struct Block
+    sEmit(code, 32, {6, 2, 5});        // Uniform pointer
+    sEmit(code, 23, {8, 2, 2});        // vec2
+    sEmit(code, 32, {9, 1, 3});        // Input pointers
+    sEmit(code, 32, {10, 1, 8});
+    sEmit(code, 30, {13, 3});          // struct Push
+    sEmit(code, 32, {14, 9, 13});      // PushConstant pointer
+    sEmit(code, 21, {16, 32, 0});      // uint
+    sEmit(code, 43, {16, 17, 4});      // Constant 4
+    sEmit(code, 25, {18, 2, 1, 0, 0, 0, 1, 0}); // image2D
+    sEmit(code, 27, {19, 18});         // sampler2D
+    sEmit(code, 28, {20, 19, 17});     // sampler2D[4]
+    sEmit(code, 32, {21, 0, 20});      // UniformConstant pointer
+
+    sEmit(code, 59, {6, 7, 2});
+    sEmit(code, 59, {9, 11, 1});
+    sEmit(code, 59, {10, 12, 1});
+    sEmit(code, 59, {14, 15, 9});
+    sEmit(code, 59, {21, 22, 0});
+    sEmit(code, 59, {9, 23, 1});
+    return(code);
+}
+
+/** Hand assembled vertex shader with wide inputs:
+ *   layout(location = 0) in mat4 inModel;
+ *   layout(location = 4) in dvec4 inPrecise;
+ *   layout(location = 6) in int64_t inId; // Only if aWithInt64
+*/
+static std::vector<uint32_t> sBuildWideInputModule(bool aWithInt64){
+    std::vector<uint32_t> code = {0x07230203, 0x00010000, 0, 16, 0};
+    sEmitNamed(code, 15, {0, 1}, "main");
+    sEmitNamed(code, 5, {11}, "inModel");
+    sEmit(code, 71, {11, 30, 0});      // Location
+    sEmit(code, 71, {12, 30, 4});
+    sEmit(code, 71, {13, 30, 6});
+
+    sEmit(code, 22, {2, 32});          // float
+    sEmit(code, 23, {3, 2, 4});        // vec4
+    sEmit(code, 24, {4, 3, 4});        // mat4
+    sEmit(code, 32, {5, 1, 4});        // Input pointers
+    sEmit(code, 22, {6, 64});          // double
+    sEmit(code, 23, {7, 6, 4});        // dvec4
+    sEmit(code, 32, {8, 1, 7});
+    sEmit(code, 21, {9, 64, 1});       // int64
+    sEmit(code, 32, {10, 1, 9});
+
+    sEmit(code, 59, {5, 11, 1});
+    sEmit(code, 59, {8, 12, 1});
+    if(aWithInt64) sEmit(code, 59, {10, 13, 1});
+    return(code);
+}
+
+TEST_CASE("SpirvReflection Tests"){
+    const std::vector<uint32_t> vertCode = sBuildModule(0);
+    const std::vector<uint32_t> fragCode = sBuildModule(4);
+
+    SECTION("Reflecting a single stage"){
+        vkutils::ShaderReflection reflection = vkutils::reflect_spirv(vertCode.data(), vertCode.size() * sizeof(uint32_t));
+        REQUIRE(reflection.stage == VK_SHADER_STAGE_VERTEX_BIT);
+        REQUIRE(reflection.entryPoint == "main");
+
+        REQUIRE(reflection.descriptors.size() == 2);
+        const vkutils::ReflectedDescriptor* block = reflection.findDescriptor(0, 1);
+        REQUIRE(block != nullptr);
+        REQUIRE(block->type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+        REQUIRE(block->blockSize == 68);
+        REQUIRE(block->name == "uBlock");
+
+        const vkutils::ReflectedDescriptor* textures = reflection.findDescriptor(1, 2);
+        REQUIRE(textures != nullptr);
+        REQUIRE(textures->type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+        REQUIRE(textures->count == 4);
+
+        REQUIRE(reflection.pushConstants.size() == 1);
+        REQUIRE(reflection.pushConstants[0].offset == 0);
+        REQUIRE(reflection.pushConstants[0].size == 16);
+
+        // The builtin input is not a vertex attribute
+        REQUIRE(reflection.vertexInputs.size() == 2);
+        REQUIRE(reflection.vertexInputs[0].format == VK_FORMAT_R32G32B32A32_SFLOAT);
+        REQUIRE(reflection.vertexInputs[1].format == VK_FORMAT_R32G32_SFLOAT);
+        REQUIRE(reflection.vertexInputs[1].name == "inUV");
+    }
+
+    SECTION("Deriving vertex input"){
+        vkutils::ShaderReflection reflection = vkutils::reflect_spirv(vertCode.data(), vertCode.size() * sizeof(uint32_t));
+        VkVertexInputBindingDescription binding = {};
+        std::vector<VkVertexInputAttributeDescription> attributes;
+        REQUIRE(vkutils::derive_vertex_input(reflection, 0, binding, attributes));
+        REQUIRE(binding.stride == 24);
+        REQUIRE(attributes.size() == 2);
+        REQUIRE(attributes[1].location == 1);
+        REQUIRE(attributes[1].offset == 16);
+    }
+
+    SECTION("Matrix inputs take a location per column"){
+        const std::vector<uint32_t> code = sBuildWideInputModule(false);
+        vkutils::ShaderReflection reflection = vkutils::reflect_spirv(code.data(), code.size() * sizeof(uint32_t));
+        REQUIRE(reflection.vertexInputs.size() == 5);
+        for(uint32_t col = 0; col < 4; ++col){
+            REQUIRE(reflection.vertexInputs[col].location == col);
+            REQUIRE(reflection.vertexInputs[col].format == VK_FORMAT_R32G32B32A32_SFLOAT);
+            REQUIRE(reflection.vertexInputs[col].size == 16);
+        }
+        REQUIRE(reflection.vertexInputs[3].name == "inModel[3]");
+        REQUIRE(reflection.vertexInputs[4].location == 4);
+        REQUIRE(reflection.vertexInputs[4].format == VK_FORMAT_R64G64B64A64_SFLOAT);
+
+        VkVertexInputBindingDescription binding = {};
+        std::vector<VkVertexInputAttributeDescription> attributes;
+        REQUIRE(vkutils::derive_vertex_input(reflection, 0, binding, attributes));
+        REQUIRE(attributes.size() == 5);
+        REQUIRE(attributes[2].location == 2);
+        REQUIRE(attributes[2].offset == 32);
+        REQUIRE(attributes[4].offset == 64);
+        REQUIRE(binding.stride == 96);
+    }
+
+    SECTION("Inputs without a vertex format can't be derived"){
+        const std::vector<uint32_t> code = sBuildWideInputModule(true);
+        vkutils::ShaderReflection reflection = vkutils::reflect_spirv(code.data(), code.size() * sizeof(uint32_t));
+        REQUIRE(reflection.vertexInputs.back().location == 6);
+        REQUIRE(reflection.vertexInputs.back().format == VK_FORMAT_UNDEFINED);
+
+        VkVertexInputBindingDescription binding = {};
+        std::vector<VkVertexInputAttributeDescription> attributes;
+        REQUIRE_THROWS_AS(vkutils::derive_vertex_input(reflection, 0, binding, attributes), std::runtime_error);
+    }
+
+    SECTION("Merging stages"){
+        vkutils::ShaderReflection vert = vkutils::reflect_spirv(vertCode.data(), vertCode.size() * sizeof(uint32_t));
+        vkutils::ShaderReflection frag = vkutils::reflect_spirv(fragCode.data(), fragCode.size() * sizeof(uint32_t));
+        REQUIRE(frag.stage == VK_SHADER_STAGE_FRAGMENT_BIT);
+        REQUIRE(frag.vertexInputs.empty());
+
+        const std::vector<const vkutils::ShaderReflection*> stages = {&vert, &frag};
+        REQUIRE(vkutils::descriptor_stage_flags(stages, 0, 1) == (VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT));
+        REQUIRE(vkutils::descriptor_stage_flags({&frag}, 0, 1) == VK_SHADER_STAGE_FRAGMENT_BIT);
+        REQUIRE(vkutils::descriptor_stage_flags(stages, 0, 5) == 0);
+
+        std::vector<VkDescriptorSetLayoutBinding> bindings = vkutils::merge_descriptor_bindings(stages, 1);
+        REQUIRE(bindings.size() == 1);
+        REQUIRE(bindings[0].binding == 2);
+        REQUIRE(bindings[0].descriptorCount == 4);
+        REQUIRE(bindings[0].stageFlags == (VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT));
+
+        std::vector<VkPushConstantRange> ranges = vkutils::merge_push_constant_ranges(stages);
+        REQUIRE(ranges.size() == 1);
+        REQUIRE(ranges[0].stageFlags == (VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT));
+    }
+
+    SECTION("Overlapping push constant ranges of different stages"){
+        vkutils::ShaderReflection vert;
+        vert.stage = VK_SHADER_STAGE_VERTEX_BIT;
+        vert.pushConstants.push_back({VK_SHADER_STAGE_VERTEX_BIT, 0, 64});
+        vkutils::ShaderReflection frag;
+        frag.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        frag.pushConstants.push_back({VK_SHADER_STAGE_FRAGMENT_BIT, 0, 16});
+
+        // The layout keeps one range per stage
+        std::vector<VkPushConstantRange> ranges = vkutils::merge_push_constant_ranges({&vert, &frag});
+        REQUIRE(ranges.size() == 2);
+
+        std::vector<VkPushConstantRange> intervals = vkutils::split_push_constant_ranges(ranges);
+        REQUIRE(intervals.size() == 2);
+        REQUIRE(intervals[0].offset == 0);
+        REQUIRE(intervals[0].size == 16);
+        REQUIRE(intervals[0].stageFlags == (VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT));
+        REQUIRE(intervals[1].offset == 16);
+        REQUIRE(intervals[1].size == 48);
+        REQUIRE(intervals[1].stageFlags == VK_SHADER_STAGE_VERTEX_BIT);
+
+        // Gaps between ranges aren't pushed, and identical ranges stay whole
+        frag.pushConstants[0] = {VK_SHADER_STAGE_FRAGMENT_BIT, 80, 16};
+        intervals = vkutils::split_push_constant_ranges(vkutils::merge_push_constant_ranges({&vert, &frag}));
+        REQUIRE(intervals.size() == 2);
+        REQUIRE(intervals[1].offset == 80);
+        REQUIRE(intervals[1].stageFlags == VK_SHADER_STAGE_FRAGMENT_BIT);
+        frag.pushConstants[0] = {VK_SHADER_STAGE_FRAGMENT_BIT, 0, 64};
+        intervals = vkutils::split_push_constant_ranges(vkutils::merge_push_constant_ranges({&vert, &frag}));
+        REQUIRE(intervals.size() == 1);
+        REQUIRE(intervals[0].size == 64);
+    }
+
+    SECTION("Invalid code is rejected"){
+        std::vector<uint32_t> badCode = vertCode;
+        badCode[0] = 0xDEADBEEF;
+        REQUIRE_THROWS_AS(vkutils::reflect_spirv(badCode.data(), badCode.size() * sizeof(uint32_t)), std::runtime_error);
+
+        std::vector<uint32_t> truncated(vertCode.begin(), vertCode.begin() + 7);
+        REQUIRE_THROWS_AS(vkutils::reflect_spirv(truncated.data(), truncated.size() * sizeof(uint32_t)), std::runtime_error);
+    }
+}
@@ -0,0 +1,45 @@
+#include "catch.hpp"
+#include "vkutils/TimelineSemaphore.h"
+#include <vector>
+
+TEST_CASE("DeferredTimelineQueue Tests"){
+    using vkutils::DeferredTimelineQueue;
+
+    SECTION("Callbacks run once their value completes, in enqueue order"){
+        DeferredTimelineQueue queue;
+        std::vector<int> order;
+        queue.enqueue(3, [&order](){order.push_back(3);});
+        queue.enqueue(1, [&order](){order.push_back(1);});
+        queue.enqueue(2, [&order](){order.push_back(2);});
+
+        REQUIRE(queue.collect(0) == 0);
+        REQUIRE(queue.collect(2) == 2);
+        REQUIRE(order == std::vector<int>({1, 2}));
+        REQUIRE(queue.size() == 1);
+
+        REQUIRE(queue.collect(5) == 1);
+        REQUIRE(order == std::vector<int>({1, 2, 3}));
+        REQUIRE(queue.empty());
+    }
+
+    SECTION("Callbacks may enqueue more work while being collected"){
+        DeferredTimelineQueue queue;
+        int runs = 0;
+        queue.enqueue(1, [&queue, &runs](){
+            ++runs;
+            queue.enqueue(4, [&runs](){++runs;});
+        });
+        queue.collect(1);
+        REQUIRE(runs == 1);
+        REQUIRE(queue.size() == 1);
+        queue.flush();
+        REQUIRE(runs == 2);
+        REQUIRE(queue.empty());
+    }
+
+    SECTION("Empty callbacks are ignored"){
+        DeferredTimelineQueue queue;
+        queue.enqueue(1, std::function<void()>());
+        REQUIRE(queue.empty());
+    }
+}
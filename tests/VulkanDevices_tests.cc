@@ -0,0 +1,78 @@
+#include "catch.hpp"
+#include "vkutils/VulkanDevices.h"
+
+static std::vector<QueueFamily> make_families(const std::vector<std::pair<VkQueueFlags, uint32_t>>& aFlagsAndCounts){
+    std::vector<QueueFamily> families;
+    for(uint32_t i = 0; i < aFlagsAndCounts.size(); ++i){
+        VkQueueFamilyProperties props = {};
+        props.queueFlags = aFlagsAndCounts[i].first;
+        props.queueCount = aFlagsAndCounts[i].second;
+        families.emplace_back(props, i);
+    }
+    return(families);
+}
+
+TEST_CASE("Queue Assignment Tests"){
+    const VkQueueFlags kCore = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+
+    SECTION("Queue family flags are decoded individually"){
+        std::vector<QueueFamily> families = make_families({{VK_QUEUE_TRANSFER_BIT, 1}, {VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT, 1}});
+        REQUIRE(families[0].isDedicatedTransfer());
+        REQUIRE_FALSE(families[0].mGraphics);
+        REQUIRE_FALSE(families[0].mCompute);
+        REQUIRE(families[1].isDedicatedCompute());
+        REQUIRE_FALSE(families[1].isDedicatedTransfer());
+    }
+
+    SECTION("Dedicated compute and transfer families are preferred"){
+        std::vector<QueueFamily> families = make_families({{kCore, 16}, {VK_QUEUE_TRANSFER_BIT, 2}, {VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT, 8}});
+        QueueAssignment assignment = VulkanPhysicalDevice::assignQueues(families, kCore, QueueSelectionPolicy(), opt::optional<uint32_t>(0U));
+        REQUIRE(*assignment.roles[QUEUE_ROLE_GRAPHICS].family == 0);
+        REQUIRE(*assignment.roles[QUEUE_ROLE_TRANSFER].family == 1);
+        REQUIRE(*assignment.roles[QUEUE_ROLE_COMPUTE].family == 2);
+        REQUIRE(assignment.familyPriorities.size() == 3);
+        REQUIRE(assignment.familyPriorities[0].size() == 1);
+    }
+
+    SECTION("Without dedicated families every role shares the graphics family"){
+        std::vector<QueueFamily> families = make_families({{kCore, 4}});
+        QueueSelectionPolicy policy;
+        policy.queueCounts[QUEUE_ROLE_COMPUTE] = 2;
+        QueueAssignment assignment = VulkanPhysicalDevice::assignQueues(families, kCore, policy, opt::optional<uint32_t>(0U));
+        REQUIRE(*assignment.roles[QUEUE_ROLE_COMPUTE].family == 0);
+        REQUIRE(*assignment.roles[QUEUE_ROLE_TRANSFER].family == 0);
+        REQUIRE(assignment.roles[QUEUE_ROLE_GRAPHICS].firstQueue == 0);
+        REQUIRE(assignment.roles[QUEUE_ROLE_COMPUTE].firstQueue == 1);
+        REQUIRE(assignment.roles[QUEUE_ROLE_COMPUTE].queueCount == 2);
+        REQUIRE(assignment.roles[QUEUE_ROLE_TRANSFER].firstQueue == 3);
+        REQUIRE(assignment.familyPriorities[0].size() == 4);
+    }
+
+    SECTION("Roles share queues once a family runs out"){
+        std::vector<QueueFamily> families = make_families({{kCore, 1}});
+        QueueAssignment assignment = VulkanPhysicalDevice::assignQueues(families, kCore, QueueSelectionPolicy());
+        for(uint32_t role = 0; role < QUEUE_ROLE_COUNT; ++role){
+            REQUIRE(assignment.roles[role].firstQueue == 0);
+            REQUIRE(assignment.roles[role].queueCount == 1);
+        }
+        REQUIRE(assignment.familyPriorities[0].size() == 1);
+    }
+
+    SECTION("Dedicated families can be disabled by policy"){
+        std::vector<QueueFamily> families = make_families({{kCore, 16}, {VK_QUEUE_TRANSFER_BIT, 2}, {VK_QUEUE_COMPUTE_BIT, 8}});
+        QueueSelectionPolicy policy;
+        policy.preferDedicatedCompute = false;
+        policy.preferDedicatedTransfer = false;
+        QueueAssignment assignment = VulkanPhysicalDevice::assignQueues(families, kCore, policy);
+        REQUIRE(*assignment.roles[QUEUE_ROLE_COMPUTE].family == 0);
+        REQUIRE(*assignment.roles[QUEUE_ROLE_TRANSFER].family == 0);
+    }
+
+    SECTION("Graphics prefers the presenting family"){
+        std::vector<QueueFamily> families = make_families({{kCore, 1}, {kCore, 1}});
+        QueueAssignment assignment = VulkanPhysicalDevice::assignQueues(families, VK_QUEUE_GRAPHICS_BIT, QueueSelectionPolicy(), opt::optional<uint32_t>(1U));
+        REQUIRE(*assignment.roles[QUEUE_ROLE_GRAPHICS].family == 1);
+        REQUIRE_FALSE(assignment.roles[QUEUE_ROLE_COMPUTE].family);
+        REQUIRE(assignment.familyPriorities.size() == 1);
+    }
+}